@@ -149,10 +149,10 @@ class AHBMaster : public AHBDevice<BASE> {
     AbstractionLayer m_ambaLayer;
 
     /// Stores the number of Bytes read from the device
-    sr_param<uint64_t> m_reads;  // NOLINT(runtime/int)
+    sr_counter m_reads;
 
     /// Stores the number of Bytes written from the device
-    sr_param<uint64_t> m_writes;  // NOLINT(runtime/int)
+    sr_counter m_writes;
 
     // Indicates a TLM response error
     bool response_error;
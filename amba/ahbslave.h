@@ -105,10 +105,10 @@ class AHBSlave : public AHBDevice<BASE> {
 
   protected:
     /// Stores the number of Bytes read from the device
-    sr_param<uint64_t> m_reads;  // NOLINT(runtime/int)
+    sr_counter m_reads;
 
     /// Stores the number of Bytes written from the device
-    sr_param<uint64_t> m_writes;  // NOLINT(runtime/int)
+    sr_counter m_writes;
 };
 
 #include "amba/ahbslave.tpp"
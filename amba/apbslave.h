@@ -17,8 +17,19 @@
 #include "amba/apbdevicebase.h"
 #include "amba/apbdevice.h"
 
+/// Payload free register access of APB slaves.
+/// Published by the slave socket, APBCtrl dispatches to it instead of calling b_transport.
+class apb_register_if {
+  public:
+    virtual ~apb_register_if() {}
+
+    /// offset is relative to the device base address,
+    /// data holds length bytes in bus byte order (as in b_transport).
+    virtual void apb_access(bool write, uint32_t offset, uint8_t *data, uint32_t length) = 0;
+};
+
 template<unsigned int BUSWIDTH = 32, typename ADDR_TYPE = unsigned int, typename DATA_TYPE = unsigned int>
-class sr_register_amba_socket : public ::amba::amba_slave_socket<BUSWIDTH>, public ::amba_slave_base {
+class sr_register_amba_socket : public ::amba::amba_slave_socket<BUSWIDTH>, public ::amba_slave_base, public apb_register_if {
   public:
     sr_register_amba_socket(sc_core::sc_module_name mn,
       sc_register_bank<ADDR_TYPE, DATA_TYPE> *bank,
@@ -43,13 +54,19 @@ class sr_register_amba_socket : public ::amba::amba_slave_socket<BUSWIDTH>, publ
     }
 
     void b_transport(tlm::tlm_generic_payload& gp, sc_core::sc_time&) {
-      ADDR_TYPE address = gp.get_address() - get_base_addr();
+      if (gp.is_write() || gp.is_read()) {
+        apb_access(gp.is_write(), gp.get_address() - get_base_addr(), gp.get_data_ptr(), gp.get_data_length());
+      }
+      gp.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+
+    void apb_access(bool write, uint32_t offset, uint8_t *ptr, uint32_t length) {
+      ADDR_TYPE address = offset;
       ADDR_TYPE byteaddr = address & 0x3;
       address = address & ~0x3;
-      ADDR_TYPE length = gp.get_data_length();
-      DATA_TYPE *data = reinterpret_cast<DATA_TYPE *>(gp.get_data_ptr());
+      DATA_TYPE *data = reinterpret_cast<DATA_TYPE *>(ptr);
 
-      if (gp.is_write()) {
+      if (write) {
         //*data = 0;
 
         switch (length) {
@@ -71,16 +88,14 @@ class sr_register_amba_socket : public ::amba::amba_slave_socket<BUSWIDTH>, publ
             break;
         }
         m_register->bus_write(address, *data);
-      }
-      if (gp.is_read()) {
+      } else {
         m_register->bus_read(address, *data);
         #ifdef LITTLE_ENDIAN_BO
         swap_Endianess(*data);
         #endif
         *data >>= (byteaddr << 3);
       }
-      srInfo()("offset", address)("length", length)("data", data)("write", gp.is_write())("byte", byteaddr)(__PRETTY_FUNCTION__);
-      gp.set_response_status(tlm::TLM_OK_RESPONSE);
+      srInfo()("offset", address)("length", length)("data", data)("write", write)("byte", byteaddr)(__PRETTY_FUNCTION__);
     }
 
     /*gs::amba::amba_slave<BUSWIDTH>& operator()() {
@@ -0,0 +1,189 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup utils
+/// @{
+/// @file elfloader.cpp
+/// Native loader for ELF32 executables.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "core/base/elfloader.h"
+#include "core/common/sr_report.h"
+
+ElfLoader::ElfLoader() : m_data(NULL), m_size(0), m_swap(false), m_header(NULL), m_symbols_read(false) {
+}
+
+ElfLoader::~ElfLoader() {
+  close();
+}
+
+bool ElfLoader::open(const std::string &filename) {
+  close();
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    srWarn("ElfLoader")
+      ("file", filename)
+      ("Cannot open ELF file");
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Elf32_Ehdr)) {
+    ::close(fd);
+    srWarn("ElfLoader")
+      ("file", filename)
+      ("ELF file is too small");
+    return false;
+  }
+  void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    srWarn("ElfLoader")
+      ("file", filename)
+      ("Cannot map ELF file");
+    return false;
+  }
+  m_filename = filename;
+  m_data = static_cast<const uint8_t *>(data);
+  m_size = info.st_size;
+  m_header = reinterpret_cast<const Elf32_Ehdr *>(m_data);
+
+  const unsigned char *ident = m_header->e_ident;
+  if (memcmp(ident, ELFMAG, SELFMAG) != 0 || ident[EI_CLASS] != ELFCLASS32) {
+    srWarn("ElfLoader")
+      ("file", filename)
+      ("File is no 32 bit ELF file");
+    close();
+    return false;
+  }
+  const uint16_t probe = 1;
+  bool little = *reinterpret_cast<const uint8_t *>(&probe) == 1;
+  m_swap = (ident[EI_DATA] == ELFDATA2LSB) != little;
+  return true;
+}
+
+void ElfLoader::close() {
+  if (m_data) {
+    munmap(const_cast<uint8_t *>(m_data), m_size);
+  }
+  m_data = NULL;
+  m_size = 0;
+  m_header = NULL;
+  m_symbols.clear();
+  m_symbols_read = false;
+}
+
+uint32_t ElfLoader::get_entry() const {
+  return (m_header)? get(m_header->e_entry) : 0;
+}
+
+uint64_t ElfLoader::load(ElfLoaderTarget &mem, const uint32_t &base) const {
+  if (!m_header) {
+    return 0;
+  }
+  uint64_t size = mem.elf_target_size();
+  uint64_t bytes = 0;
+  uint32_t phoff = get(m_header->e_phoff);
+  uint16_t phentsize = get(m_header->e_phentsize);
+  uint16_t phnum = get(m_header->e_phnum);
+  for (uint16_t i = 0; i < phnum; ++i) {
+    const Elf32_Phdr *phdr = reinterpret_cast<const Elf32_Phdr *>(at(phoff + i * phentsize, sizeof(Elf32_Phdr)));
+    if (!phdr) {
+      srWarn("ElfLoader")
+        ("file", m_filename)
+        ("Program header table exceeds the file");
+      break;
+    }
+    if (get(phdr->p_type) != PT_LOAD || !get(phdr->p_memsz)) {
+      continue;
+    }
+    uint32_t paddr = get(phdr->p_paddr);
+    uint32_t filesz = get(phdr->p_filesz);
+    uint32_t memsz = std::max(get(phdr->p_memsz), filesz);
+
+    // Clip the segment to the memory window [base, base + size)
+    uint64_t start = std::max<uint64_t>(paddr, base);
+    uint64_t end = std::min<uint64_t>(static_cast<uint64_t>(paddr) + memsz, static_cast<uint64_t>(base) + size);
+    if (start >= end) {
+      continue;
+    }
+    uint64_t file_end = std::min<uint64_t>(static_cast<uint64_t>(paddr) + filesz, end);
+    if (start < file_end) {
+      const uint8_t *data = at(get(phdr->p_offset) + (start - paddr), file_end - start);
+      if (!data) {
+        srWarn("ElfLoader")
+          ("file", m_filename)
+          ("segment", i)
+          ("Segment exceeds the file");
+        continue;
+      }
+      mem.elf_target_write(start - base, data, file_end - start);
+      bytes += file_end - start;
+    }
+    uint64_t zero_start = std::max(start, file_end);
+    if (zero_start < end) {
+      mem.elf_target_erase(zero_start - base, end - base);
+      bytes += end - zero_start;
+    }
+  }
+  return bytes;
+}
+
+const ElfLoader::symbol_map_t &ElfLoader::get_symbols() {
+  if (m_symbols_read || !m_header) {
+    return m_symbols;
+  }
+  m_symbols_read = true;
+  uint32_t shoff = get(m_header->e_shoff);
+  uint16_t shentsize = get(m_header->e_shentsize);
+  uint16_t shnum = get(m_header->e_shnum);
+  for (uint16_t i = 0; i < shnum; ++i) {
+    const Elf32_Shdr *symtab = reinterpret_cast<const Elf32_Shdr *>(at(shoff + i * shentsize, sizeof(Elf32_Shdr)));
+    if (!symtab || get(symtab->sh_type) != SHT_SYMTAB) {
+      continue;
+    }
+    uint32_t link = get(symtab->sh_link);
+    const Elf32_Shdr *strtab = reinterpret_cast<const Elf32_Shdr *>(at(shoff + link * shentsize, sizeof(Elf32_Shdr)));
+    if (!strtab) {
+      continue;
+    }
+    const char *strings = reinterpret_cast<const char *>(at(get(strtab->sh_offset), get(strtab->sh_size)));
+    const Elf32_Sym *symbols = reinterpret_cast<const Elf32_Sym *>(at(get(symtab->sh_offset), get(symtab->sh_size)));
+    if (!strings || !symbols) {
+      continue;
+    }
+    uint32_t strsize = get(strtab->sh_size);
+    uint32_t count = get(symtab->sh_size) / sizeof(Elf32_Sym);
+    for (uint32_t j = 0; j < count; ++j) {
+      uint32_t name = get(symbols[j].st_name);
+      if (!name || name >= strsize || get(symbols[j].st_shndx) == SHN_UNDEF) {
+        continue;
+      }
+      unsigned char type = ELF32_ST_TYPE(symbols[j].st_info);
+      if (type == STT_SECTION || type == STT_FILE) {
+        continue;
+      }
+      const char *str = strings + name;
+      // Global definitions win over local ones of the same name
+      std::pair<symbol_map_t::iterator, bool> item = m_symbols.insert(std::make_pair(
+        std::string(str, strnlen(str, strsize - name)), get(symbols[j].st_value)));
+      if (!item.second && ELF32_ST_BIND(symbols[j].st_info) == STB_GLOBAL) {
+        item.first->second = get(symbols[j].st_value);
+      }
+    }
+  }
+  return m_symbols;
+}
+
+/// @}
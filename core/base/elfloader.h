@@ -0,0 +1,107 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup utils
+/// @{
+/// @file elfloader.h
+/// Native loader for ELF32 executables. The file is memory mapped and each
+/// PT_LOAD segment is copied into the target memory with a single block
+/// write, the part of a segment not backed by the file (.bss) is erased.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#ifndef MODELS_UTILS_ELFLOADER_H_
+#define MODELS_UTILS_ELFLOADER_H_
+
+#include <stdint.h>
+#include <elf.h>
+#include <map>
+#include <string>
+
+/// Implemented by memories which can be filled by the ElfLoader.
+/// Offsets are relative to the first byte of the memory.
+class ElfLoaderTarget {
+  public:
+    virtual ~ElfLoaderTarget() {}
+
+    /// Size of the memory in bytes
+    virtual uint64_t elf_target_size() const = 0;
+
+    virtual void elf_target_write(const uint32_t &offset, const uint8_t *data, const uint32_t &len) = 0;
+
+    /// Clears the bytes from start up to (excluding) end
+    virtual void elf_target_erase(const uint32_t &start, const uint32_t &end) = 0;
+};
+
+class ElfLoader {
+  public:
+    typedef std::map<std::string, uint32_t> symbol_map_t;
+
+    ElfLoader();
+
+    ~ElfLoader();
+
+    /// Maps the file and checks the ELF header. Returns false if the file
+    /// cannot be opened or is no 32 bit executable.
+    bool open(const std::string &filename);
+
+    void close();
+
+    bool is_open() const {
+      return m_data != NULL;
+    }
+
+    /// Entry point of the executable
+    uint32_t get_entry() const;
+
+    /// Copies all PT_LOAD segments into mem. base is the bus address of the
+    /// first byte of mem, segments are placed by their physical address.
+    /// Parts outside of the memory are skipped.
+    /// Returns the number of bytes written or erased.
+    uint64_t load(ElfLoaderTarget &mem, const uint32_t &base) const;
+
+    /// All defined symbols of the symbol tables by name
+    const symbol_map_t &get_symbols();
+
+  private:
+    /// Converts a value of the file into host byte order
+    template<typename T>
+    T get(const T &value) const {
+      if (!m_swap) {
+        return value;
+      }
+      T result = 0;
+      for (size_t i = 0; i < sizeof(T); ++i) {
+        result = (result << 8) | ((value >> (i * 8)) & 0xFF);
+      }
+      return result;
+    }
+
+    /// Returns a pointer to len bytes at offset of the file or NULL if they exceed it
+    const uint8_t *at(const uint32_t &offset, const uint32_t &len) const {
+      if (offset > m_size || len > m_size - offset) {
+        return NULL;
+      }
+      return m_data + offset;
+    }
+
+    std::string m_filename;
+
+    const uint8_t *m_data;
+    size_t m_size;
+
+    /// The file byte order differs from the host byte order
+    bool m_swap;
+
+    const Elf32_Ehdr *m_header;
+
+    symbol_map_t m_symbols;
+    bool m_symbols_read;
+};
+
+#endif  // MODELS_UTILS_ELFLOADER_H_
+/// @}
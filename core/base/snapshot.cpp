@@ -0,0 +1,347 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup utils
+/// @{
+/// @file snapshot.cpp
+/// Checkpoint and restore of a whole platform.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "core/base/snapshot.h"
+#include "core/common/sr_report.h"
+
+namespace {
+
+const uint32_t ORDER_MARK = 0x01020304;
+
+/// Size of the fixed part of the page image header
+const uint32_t PAGES_HEADER = 40;
+
+template<typename T>
+inline bool write_value(FILE *file, const T &value) {
+  return fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template<typename T>
+inline bool read_value(FILE *file, T &value) {
+  return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+/// Time resolution in ps, snapshots are only valid for the same resolution
+inline double resolution() {
+  return sc_core::sc_get_time_resolution().to_seconds() * 1e12;
+}
+
+}  // namespace
+
+SnapshotPages::SnapshotPages(uint8_t *base, size_t length) :
+  m_base(base), m_length(length), m_page_size(0), m_count(0), m_size(0), m_index(NULL) {
+}
+
+SnapshotPages::~SnapshotPages() {
+  munmap(m_base, m_length);
+}
+
+Snapshot::Snapshot(const std::string &path) :
+  m_path(path), m_time(sc_core::sc_time_stamp()), m_devices(0), m_pages(NULL), m_page_size(0), m_pages_size(0) {
+}
+
+Snapshot::~Snapshot() {
+  if (m_pages) {
+    fclose(m_pages);
+  }
+}
+
+bool Snapshot::save(const std::string &path) {
+  if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+    srError("Snapshot")
+      ("path", path)
+      ("Cannot create snapshot directory");
+    return false;
+  }
+  Snapshot snapshot(path);
+  snapshot.save_objects(sc_core::sc_get_top_level_objects());
+  if (!snapshot.write_state()) {
+    srError("Snapshot")
+      ("path", path)
+      ("Cannot write snapshot");
+    return false;
+  }
+  srInfo("Snapshot")
+    ("path", path)
+    ("time", snapshot.m_time)
+    ("devices", snapshot.m_devices)
+    ("Snapshot saved");
+  return true;
+}
+
+bool Snapshot::restore(const std::string &path) {
+  if (!sc_core::sc_is_running()) {
+    // Spawned methods run in the initialization phase, when all models are
+    // elaborated and reset.
+    sc_core::sc_spawn_options options;
+    options.spawn_method();
+    sc_core::sc_spawn(sc_bind(&Snapshot::restore_process, path), sc_core::sc_gen_unique_name("snapshot_restore"), &options);
+    return true;
+  }
+  Snapshot snapshot(path);
+  return snapshot.apply();
+}
+
+void Snapshot::save_at(const std::string &path, const sc_core::sc_time &time) {
+  sc_core::sc_spawn(sc_bind(&Snapshot::save_process, path, time), sc_core::sc_gen_unique_name("snapshot_save"));
+}
+
+void Snapshot::restore_process(std::string path) {
+  Snapshot snapshot(path);
+  snapshot.apply();
+}
+
+void Snapshot::save_process(std::string path, sc_core::sc_time time) {
+  if (time > sc_core::sc_time_stamp()) {
+    sc_core::wait(time - sc_core::sc_time_stamp());
+  }
+  save(path);
+}
+
+bool Snapshot::apply() {
+  if (!read_state()) {
+    srError("Snapshot")
+      ("path", m_path)
+      ("Cannot read snapshot");
+    return false;
+  }
+  restore_objects(sc_core::sc_get_top_level_objects());
+  srInfo("Snapshot")
+    ("path", m_path)
+    ("time", m_time)
+    ("devices", m_devices)
+    ("Snapshot restored");
+  return true;
+}
+
+void Snapshot::save_objects(const std::vector<sc_core::sc_object *> &objects) {
+  for (std::vector<sc_core::sc_object *>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter) {
+    SnapshotDevice *device = dynamic_cast<SnapshotDevice *>(*iter);
+    if (device) {
+      m_prefix = std::string((*iter)->name()) + ".";
+      device->snapshot_save(*this);
+      m_devices++;
+    }
+    save_objects((*iter)->get_child_objects());
+  }
+}
+
+void Snapshot::restore_objects(const std::vector<sc_core::sc_object *> &objects) {
+  for (std::vector<sc_core::sc_object *>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter) {
+    restore_objects((*iter)->get_child_objects());
+    SnapshotDevice *device = dynamic_cast<SnapshotDevice *>(*iter);
+    if (device) {
+      m_prefix = std::string((*iter)->name()) + ".";
+      device->snapshot_restore(*this);
+      m_devices++;
+    }
+  }
+}
+
+void Snapshot::put(const std::string &key, const void *data, const size_t &len) {
+  std::vector<uint8_t> &value = m_values[m_prefix + key];
+  const uint8_t *ptr = static_cast<const uint8_t *>(data);
+  value.assign(ptr, ptr + len);
+}
+
+const std::vector<uint8_t> *Snapshot::find(const std::string &key) const {
+  value_map_t::const_iterator item = m_values.find(m_prefix + key);
+  return (item != m_values.end())? &item->second : NULL;
+}
+
+bool Snapshot::get(const std::string &key, void *data, const size_t &len) const {
+  const std::vector<uint8_t> *value = find(key);
+  if (!value || value->size() != len) {
+    return false;
+  }
+  if (len) {
+    memcpy(data, &(*value)[0], len);
+  }
+  return true;
+}
+
+bool Snapshot::write_state() const {
+  std::string filename = m_path + "/state";
+  FILE *file = fopen(filename.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  bool ok = fwrite("SRSNAPSH", 1, 8, file) == 8;
+  ok = ok && write_value(file, VERSION) && write_value(file, ORDER_MARK);
+  ok = ok && write_value(file, static_cast<uint64_t>(m_time.value())) && write_value(file, resolution());
+  ok = ok && write_value(file, static_cast<uint32_t>(m_values.size()));
+  for (value_map_t::const_iterator iter = m_values.begin(); ok && iter != m_values.end(); ++iter) {
+    ok = write_value(file, static_cast<uint16_t>(iter->first.size()));
+    ok = ok && fwrite(iter->first.data(), 1, iter->first.size(), file) == iter->first.size();
+    ok = ok && write_value(file, static_cast<uint64_t>(iter->second.size()));
+    if (ok && !iter->second.empty()) {
+      ok = fwrite(&iter->second[0], 1, iter->second.size(), file) == iter->second.size();
+    }
+  }
+  return (fclose(file) == 0) && ok;
+}
+
+bool Snapshot::read_state() {
+  std::string filename = m_path + "/state";
+  FILE *file = fopen(filename.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+  char magic[8];
+  uint32_t version = 0, mark = 0, count = 0;
+  uint64_t ticks = 0;
+  double res = 0.0;
+  bool ok = fread(magic, 1, 8, file) == 8 && memcmp(magic, "SRSNAPSH", 8) == 0;
+  ok = ok && read_value(file, version) && version == VERSION;
+  ok = ok && read_value(file, mark) && mark == ORDER_MARK;
+  ok = ok && read_value(file, ticks) && read_value(file, res);
+  if (ok && res != resolution()) {
+    srError("Snapshot")
+      ("path", m_path)
+      ("resolution", res)
+      ("The snapshot was taken with another time resolution");
+    ok = false;
+  }
+  ok = ok && read_value(file, count);
+  for (uint32_t i = 0; ok && i < count; ++i) {
+    uint16_t keylen = 0;
+    uint64_t len = 0;
+    ok = read_value(file, keylen);
+    std::string key(keylen, '\0');
+    ok = ok && (!keylen || fread(&key[0], 1, keylen, file) == keylen);
+    ok = ok && read_value(file, len);
+    if (ok) {
+      std::vector<uint8_t> &value = m_values[key];
+      value.resize(len);
+      ok = !len || fread(&value[0], 1, len, file) == len;
+    }
+  }
+  fclose(file);
+  m_time = sc_core::sc_time::from_value(ticks);
+  return ok;
+}
+
+std::string Snapshot::pages_file(const std::string &key) const {
+  return m_path + "/" + m_prefix + key + ".pages";
+}
+
+bool Snapshot::begin_pages(const std::string &key, const uint32_t &page_size, const uint64_t &size) {
+  if (m_pages) {
+    end_pages();
+  }
+  long system = sysconf(_SC_PAGESIZE);
+  if (page_size < PAGES_HEADER || (system > 0 && page_size % system)) {
+    srError("Snapshot")
+      ("page_size", page_size)
+      ("The page size has to be a multiple of the system page size");
+    return false;
+  }
+  std::string filename = pages_file(key);
+  m_pages = fopen(filename.c_str(), "wb");
+  if (!m_pages) {
+    srError("Snapshot")
+      ("file", filename)
+      ("Cannot create page image");
+    return false;
+  }
+  m_page_size = page_size;
+  m_pages_size = size;
+  m_page_index.clear();
+  // The header is completed by end_pages
+  std::vector<uint8_t> header(page_size, 0);
+  fwrite(&header[0], 1, page_size, m_pages);
+  return true;
+}
+
+void Snapshot::put_page(const uint32_t &number, const uint8_t *data) {
+  if (m_pages) {
+    fwrite(data, 1, m_page_size, m_pages);
+    m_page_index.push_back(number);
+  }
+}
+
+bool Snapshot::end_pages() {
+  if (!m_pages) {
+    return false;
+  }
+  uint64_t index_offset = static_cast<uint64_t>(m_page_index.size() + 1) * m_page_size;
+  uint32_t count = m_page_index.size();
+  if (count) {
+    fwrite(&m_page_index[0], sizeof(uint32_t), count, m_pages);
+  }
+  bool ok = fseeko(m_pages, 0, SEEK_SET) == 0;
+  ok = ok && fwrite("SRPAGES", 1, 8, m_pages) == 8;
+  ok = ok && write_value(m_pages, VERSION) && write_value(m_pages, ORDER_MARK);
+  ok = ok && write_value(m_pages, m_page_size) && write_value(m_pages, count);
+  ok = ok && write_value(m_pages, m_pages_size) && write_value(m_pages, index_offset);
+  ok = (fclose(m_pages) == 0) && ok;
+  m_pages = NULL;
+  return ok;
+}
+
+boost::shared_ptr<SnapshotPages> Snapshot::get_pages(const std::string &key) const {
+  boost::shared_ptr<SnapshotPages> result;
+  std::string filename = pages_file(key);
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return result;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < PAGES_HEADER) {
+    ::close(fd);
+    return result;
+  }
+  // Private writable mapping: the memory modifies its pages copy on write.
+  void *data = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    srWarn("Snapshot")
+      ("file", filename)
+      ("Cannot map page image");
+    return result;
+  }
+  SnapshotPages *pages = new SnapshotPages(static_cast<uint8_t *>(data), info.st_size);
+  result.reset(pages);
+
+  const uint8_t *header = pages->m_base;
+  uint32_t version, mark;
+  uint64_t index_offset;
+  memcpy(&version, header + 8, 4);
+  memcpy(&mark, header + 12, 4);
+  memcpy(&pages->m_page_size, header + 16, 4);
+  memcpy(&pages->m_count, header + 20, 4);
+  memcpy(&pages->m_size, header + 24, 8);
+  memcpy(&index_offset, header + 32, 8);
+  if (memcmp(header, "SRPAGES", 8) != 0 || version != VERSION || mark != ORDER_MARK || !pages->m_page_size ||
+      index_offset != static_cast<uint64_t>(pages->m_count + 1) * pages->m_page_size ||
+      index_offset + static_cast<uint64_t>(pages->m_count) * sizeof(uint32_t) > pages->m_length) {
+    srWarn("Snapshot")
+      ("file", filename)
+      ("Invalid page image");
+    result.reset();
+    return result;
+  }
+  pages->m_index = reinterpret_cast<const uint32_t *>(pages->m_base + index_offset);
+  return result;
+}
+
+/// @}
@@ -0,0 +1,233 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup utils
+/// @{
+/// @file snapshot.h
+/// Checkpoint and restore of a whole platform. Every sc_object deriving from
+/// SnapshotDevice stores its state as key/value pairs under its hierarchical
+/// name. Memories store their content as sparse page images which are memory
+/// mapped on restore.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#ifndef MODELS_UTILS_SNAPSHOT_H_
+#define MODELS_UTILS_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/base/systemc.h"
+
+class Snapshot;
+
+/// Implemented by all models with state which has to survive a snapshot.
+/// Devices are found by walking the sc_object hierarchy. On restore the
+/// children are restored before their parent, so a model already finds the
+/// content of its register bank when snapshot_restore is called.
+class SnapshotDevice {
+  public:
+    virtual ~SnapshotDevice() {}
+
+    virtual void snapshot_save(Snapshot &snapshot) = 0;
+
+    virtual void snapshot_restore(Snapshot &snapshot) = 0;
+};
+
+/// A memory mapped page image of a snapshot. The mapping is private,
+/// writes to the pages do not change the file. It is unmapped with the
+/// last reference.
+class SnapshotPages {
+  public:
+    ~SnapshotPages();
+
+    uint32_t page_size() const {
+      return m_page_size;
+    }
+
+    /// Size of the saved memory in bytes
+    uint64_t size() const {
+      return m_size;
+    }
+
+    /// Number of pages in the image
+    uint32_t count() const {
+      return m_count;
+    }
+
+    /// Page number (offset / page_size) of the i-th page
+    uint32_t index(const uint32_t &i) const {
+      return m_index[i];
+    }
+
+    /// Data of the i-th page, page_size bytes
+    uint8_t *page(const uint32_t &i) const {
+      return m_base + static_cast<size_t>(i + 1) * m_page_size;
+    }
+
+    /// Returns true if ptr points into the mapping
+    bool contains(const uint8_t *ptr) const {
+      return ptr >= m_base && ptr < m_base + m_length;
+    }
+
+  private:
+    friend class Snapshot;
+
+    SnapshotPages(uint8_t *base, size_t length);
+
+    uint8_t *m_base;
+    size_t m_length;
+    uint32_t m_page_size;
+    uint32_t m_count;
+    uint64_t m_size;
+    const uint32_t *m_index;
+};
+
+/// A snapshot directory holds the file "state" with all key/value pairs and
+/// one "<device>.<key>.pages" file per page image. Values are stored in host
+/// byte order, snapshots are not portable between hosts of different byte order.
+///
+/// state: "SRSNAPSH" u32 version u32 0x01020304 u64 time (sc_time::value)
+///        double time resolution in ps, u32 count, then for each value:
+///        u16 key length, key, u64 data length, data.
+///
+/// pages: the first page holds the header "SRPAGES\0" u32 version u32 0x01020304
+///        u32 page size u32 count u64 memory size u64 index offset. Page i
+///        starts at (i + 1) * page size, the u32 page numbers of all pages
+///        follow the last page. Pages are aligned to the page size, so they
+///        can be mapped directly.
+class Snapshot {
+  public:
+    static const uint32_t VERSION = 1;
+
+    /// Saves the state of all SnapshotDevices into the directory path.
+    static bool save(const std::string &path);
+
+    /// Restores the snapshot in path into the platform. Before the simulation
+    /// runs the restore is deferred to the initialization phase, after the
+    /// start_of_simulation callbacks of all models (e.g. resets) are done.
+    static bool restore(const std::string &path);
+
+    /// Saves a snapshot into path as soon as the simulation reaches time.
+    static void save_at(const std::string &path, const sc_core::sc_time &time);
+
+    /// Stores len bytes of data under key for the current device.
+    void put(const std::string &key, const void *data, const size_t &len);
+
+    template<typename T>
+    void put(const std::string &key, const T &value) {
+      put(key, &value, sizeof(T));
+    }
+
+    template<typename T>
+    void put(const std::string &key, const std::vector<T> &values) {
+      put(key, values.empty()? NULL : &values[0], values.size() * sizeof(T));
+    }
+
+    void put(const std::string &key, const sc_core::sc_time &value) {
+      put(key, value.value());
+    }
+
+    /// Reads exactly len bytes stored under key for the current device.
+    /// Returns false if the key is missing or has another size.
+    bool get(const std::string &key, void *data, const size_t &len) const;
+
+    template<typename T>
+    bool get(const std::string &key, T &value) const {
+      return get(key, &value, sizeof(T));
+    }
+
+    /// Resizes values to the stored number of elements
+    template<typename T>
+    bool get(const std::string &key, std::vector<T> &values) const {
+      const std::vector<uint8_t> *data = find(key);
+      if (!data || data->size() % sizeof(T)) {
+        return false;
+      }
+      values.resize(data->size() / sizeof(T));
+      return get(key, values.empty()? NULL : &values[0], data->size());
+    }
+
+    bool get(const std::string &key, sc_core::sc_time &value) const {
+      sc_dt::uint64 ticks;
+      if (!get(key, ticks)) {
+        return false;
+      }
+      value = sc_core::sc_time::from_value(ticks);
+      return true;
+    }
+
+    /// Starts the page image key of the current device. size is the size
+    /// of the memory, pages are added with put_page in any order.
+    bool begin_pages(const std::string &key, const uint32_t &page_size, const uint64_t &size);
+
+    /// Adds page number (offset / page_size) with page_size bytes of data.
+    void put_page(const uint32_t &number, const uint8_t *data);
+
+    /// Completes the page image started by begin_pages.
+    bool end_pages();
+
+    /// Maps the page image key of the current device, NULL if it does not exist.
+    boost::shared_ptr<SnapshotPages> get_pages(const std::string &key) const;
+
+    /// Simulation time at which the snapshot was taken
+    const sc_core::sc_time &time() const {
+      return m_time;
+    }
+
+  private:
+    explicit Snapshot(const std::string &path);
+
+    ~Snapshot();
+
+    /// Saves all devices below objects (parents first)
+    void save_objects(const std::vector<sc_core::sc_object *> &objects);
+
+    /// Restores all devices below objects (children first)
+    void restore_objects(const std::vector<sc_core::sc_object *> &objects);
+
+    bool write_state() const;
+
+    bool read_state();
+
+    bool apply();
+
+    static void restore_process(std::string path);
+
+    static void save_process(std::string path, sc_core::sc_time time);
+
+    const std::vector<uint8_t> *find(const std::string &key) const;
+
+    std::string pages_file(const std::string &key) const;
+
+    typedef std::map<std::string, std::vector<uint8_t> > value_map_t;
+
+    std::string m_path;
+
+    /// Hierarchical name of the current device followed by a dot
+    std::string m_prefix;
+
+    value_map_t m_values;
+
+    sc_core::sc_time m_time;
+
+    /// Number of devices saved or restored
+    uint32_t m_devices;
+
+    /// Page image in progress
+    FILE *m_pages;
+    uint32_t m_page_size;
+    uint64_t m_pages_size;
+    std::vector<uint32_t> m_page_index;
+};
+
+#endif  // MODELS_UTILS_SNAPSHOT_H_
+/// @}
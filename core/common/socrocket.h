@@ -22,5 +22,14 @@ typedef struct {
   unsigned int length;
 } t_snoop;
 
+// Snoop filter of a snooping master (AHBCTRL -> MMU_CACHE)
+class snoop_filter_if {
+  public:
+    virtual ~snoop_filter_if() {}
+
+    /// Returns false if the snoop can not change any state of the master
+    virtual bool snoop_relevant(const t_snoop &snoop) = 0;
+};
+
 #endif  // COMMON_SOCROCKET_H_
 /// @}
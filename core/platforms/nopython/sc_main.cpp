@@ -28,6 +28,7 @@
 
 #include "core/base/verbose.h"
 #include "gaisler/leon3/leon3.h"
+#include "gaisler/leon3/parallel.h"
 #include "gaisler/ahbin/ahbin.h"
 #include "gaisler/memory/memory.h"
 #include "gaisler/apbctrl/apbctrl.h"
@@ -311,6 +312,7 @@ int sc_main(int argc, char** argv) {
 
     SR_INCLUDE_MODULE(ArrayStorage);
     SR_INCLUDE_MODULE(MapStorage);
+    SR_INCLUDE_MODULE(PagedStorage);
     SR_INCLUDE_MODULE(ReportIO);
     SR_INCLUDE_MODULE(TcpIO);
 
@@ -325,6 +327,8 @@ int sc_main(int argc, char** argv) {
     gs::gs_param<unsigned int> p_system_clock("clk", 10.0, p_system);
     gs::gs_param<std::string> p_system_osemu("osemu", "", p_system);
     gs::gs_param<std::string> p_system_log("log", "", p_system);
+    // Run every LEON3 core on its own host thread (see gaisler/leon3/parallel.h)
+    gs::gs_param<bool> p_system_parallel("parallel", false, p_system);
 
     gs::gs_param_array p_report("report", p_conf);
     gs::gs_param<bool> p_report_timing("timing", true, p_report);
@@ -687,6 +691,7 @@ int sc_main(int argc, char** argv) {
     gs::gs_param<unsigned int> p_mmu_cache_mmu_tlb_type("tlb_type", 1u, p_mmu_cache_mmu);
     gs::gs_param<unsigned int> p_mmu_cache_mmu_tlb_rep("tlb_rep", 1, p_mmu_cache_mmu);
     gs::gs_param<unsigned int> p_mmu_cache_mmu_mmupgsz("mmupgsz", 0u, p_mmu_cache_mmu);
+    gs::gs_param<bool> p_mmu_cache_dmi("dmi", false, p_mmu_cache);
 
     gs::gs_param<std::string> p_proc_history("history", "", p_system);
 
@@ -695,6 +700,10 @@ int sc_main(int argc, char** argv) {
     gs::gs_param<int> p_gdb_port("port", 1500, p_gdb);
     gs::gs_param<int> p_gdb_proc("proc", 0, p_gdb);
     Leon3 *first_leon = NULL;
+    Leon3Parallel *parallel = NULL;
+    if(p_system_parallel) {
+      parallel = new Leon3Parallel("parallel");
+    }
     for(uint32_t i=0; i< p_system_ncpu; i++) {
       // AHBMaster - MMU_CACHE
       // =====================
@@ -735,6 +744,9 @@ int sc_main(int argc, char** argv) {
       if(!first_leon) {
         first_leon = leon3;
       }
+      if(parallel) {
+        parallel->add(leon3);
+      }
 
       // Connecting AHB Master
       leon3->ahb(ahbctrl.ahbIN);
@@ -742,6 +754,11 @@ int sc_main(int argc, char** argv) {
       leon3->set_clk(p_system_clock, SC_NS);
       connect(leon3->snoop, ahbctrl.snoop);
 
+      // LT reads from DMI regions of the memories
+      if(p_mmu_cache_dmi) {
+        leon3->g_dmi = true;
+      }
+
       // History logging
       std::string history = p_proc_history;
       if(!history.empty()) {
@@ -324,6 +324,7 @@ int sc_main(int argc, char** argv) {
 
     SR_INCLUDE_MODULE(ArrayStorage);
     SR_INCLUDE_MODULE(MapStorage);
+    SR_INCLUDE_MODULE(PagedStorage);
     SR_INCLUDE_MODULE(ReportIO);
     SR_INCLUDE_MODULE(TcpIO);
 
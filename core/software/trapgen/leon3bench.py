@@ -0,0 +1,72 @@
+#!/usr/bin/env python
+# vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 filetype=python :
+"""Times branch-heavy kernels on the leon3mp platform of one or more builds.
+
+Usage: leon3bench.py [--runs N] BUILD_DIR [BUILD_DIR ...]
+
+Every BUILD_DIR is a waf output directory (./waf configure --out=BUILD_DIR)
+containing leon3mp.platform, sdram.prom and the trapgen sparc kernels.
+To compare two revisions build each into its own directory, e.g.:
+
+    git checkout <before> && ./waf configure --out=build-before && ./waf
+    git checkout <after>  && ./waf configure --out=build-after  && ./waf
+    core/software/trapgen/leon3bench.py build-before build-after
+
+The best wall clock time of N runs is reported for every kernel and build,
+each further build also as speedup against the first one.
+"""
+from __future__ import print_function
+import os
+import subprocess
+import sys
+import time
+
+KERNELS = ['quicksort', 'queens', 'hanoi']
+
+def command(build, kernel):
+    """Command line of the systest for kernel in build (see core/waf/systools.py)"""
+    sdram = os.path.join(build, 'core', 'software', 'trapgen', kernel + '.sparc')
+    return [
+        os.path.join(build, 'core', 'platforms', 'leon3mp', 'leon3mp.platform'),
+        '--loadelf', 'rom=%s' % os.path.join(build, 'core', 'software', 'prom', 'sdram', 'sdram.prom'),
+        '--loadelf', 'sdram=%s' % sdram,
+        '--intrinsics', 'leon3_0=%s(standard)' % sdram,
+        '--option', 'conf.system.at=false',
+    ]
+
+def measure(build, kernel, runs):
+    """Returns the best wall clock time of runs executions"""
+    best = None
+    devnull = open(os.devnull, 'w')
+    for _ in range(runs):
+        start = time.time()
+        result = subprocess.call(command(build, kernel), stdout=devnull, stderr=devnull)
+        elapsed = time.time() - start
+        if result != 0:
+            raise Exception('%s failed in %s with exit value %d' % (kernel, build, result))
+        if best is None or elapsed < best:
+            best = elapsed
+    devnull.close()
+    return best
+
+def main(argv):
+    runs = 5
+    if len(argv) > 2 and argv[1] == '--runs':
+        runs = int(argv[2])
+        argv = argv[2:]
+    builds = argv[1:]
+    if not builds:
+        print(__doc__)
+        return 1
+
+    print('%-10s' % 'kernel' + ''.join(['%24s' % os.path.basename(os.path.normpath(b)) for b in builds]))
+    for kernel in KERNELS:
+        times = [measure(build, kernel, runs) for build in builds]
+        line = '%-10s%23.3fs' % (kernel, times[0])
+        for elapsed in times[1:]:
+            line += '%15.3fs (%4.2fx)' % (elapsed, times[0] / elapsed)
+        print(line)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -5,6 +5,7 @@
 
 #include "core/base/systemc.h"
 #include "core/base/vmap.h"
+#include "core/base/snapshot.h"
 #include "core/trapgen/modules/abi_if.hpp"
 #include "core/trapgen/common/tools_if.hpp"
 #include "core/trapgen/modules/instruction.hpp"
@@ -14,7 +15,8 @@ template<class issueWidth>
 class IntrinsicManager :
     public sc_core::sc_object,
     public trap::ToolsIf<issueWidth>,
-    public IntrinsicBase {
+    public IntrinsicBase,
+    public SnapshotDevice {
   private:
     typedef typename vmap<issueWidth, PlatformIntrinsic<issueWidth> *> syscallcb_map_t;
     typename syscallcb_map_t::const_iterator syscCallbacksEnd;
@@ -60,6 +62,7 @@ class IntrinsicManager :
 
       this->syscCallbacks[addr] = &callBack;
       this->syscCallbacksEnd = this->syscCallbacks.end();
+      this->add_hook(addr);
 
       return true;
     }
@@ -85,10 +88,23 @@ class IntrinsicManager :
       }
       return false;
     }
+    ///Intrinsic addresses are registered as hooks, so the manager is only
+    ///called for instructions in pages holding one of them
+    bool needs_every_issue() const throw() {
+      return false;
+    }
+    ///The heap grows with sbrk calls of the software and is part of the platform state
+    void snapshot_save(Snapshot &snapshot) {
+      snapshot.put("heap_pointer", this->heapPointer);
+    }
+    void snapshot_restore(Snapshot &snapshot) {
+      snapshot.get("heap_pointer", this->heapPointer);
+    }
     ///Resets the whole concurrency emulator, reinitializing it and preparing it for a new simulation
     void reset() {
       this->syscCallbacks.clear();
       this->syscCallbacksEnd = this->syscCallbacks.end();
+      this->clear_hooks();
       this->env.clear();
       this->sysconfmap.clear();
       this->programArgs.clear();
@@ -194,7 +194,10 @@ class readIntrinsic : public PlatformIntrinsic<wordSize> {
         THROW_EXCEPTION("File descriptor " << fd << " not valid");
       }
       unsigned count = callArgs[2];
-      unsigned char *buf = new unsigned char[count];
+      if (this->buffer.size() < count) {
+        this->buffer.resize(count);
+      }
+      unsigned char *buf = count? &this->buffer[0] : NULL;
 #ifdef __GNUC__
       int ret = ::read(fd, buf, count);
 #else
@@ -202,12 +205,11 @@ class readIntrinsic : public PlatformIntrinsic<wordSize> {
 #endif
       // Now I have to write the read content into memory
       wordSize destAddress = callArgs[1];
-      for (int i = 0; i < ret; i++) {
-        this->m_processor->write_char_mem(destAddress + i, buf[i]);
+      if (ret > 0) {
+        this->m_processor->write_block_mem(destAddress, buf, ret);
       }
       this->m_processor->set_return_value(ret);
       this->m_processor->return_from_call();
-      delete[] buf;
       this->m_processor->post_call();
 
       if (this->latency.to_double() > 0) {
@@ -216,6 +218,10 @@ class readIntrinsic : public PlatformIntrinsic<wordSize> {
 
       return true;
     }
+
+  protected:
+    /// Bounce buffer, kept across calls
+    std::vector<unsigned char> buffer;
 };
 
 template<class wordSize>
@@ -251,10 +257,11 @@ class writeIntrinsic : public PlatformIntrinsic<wordSize> {
       }
       unsigned count = callArgs[2];
       wordSize destAddress = callArgs[1];
-      unsigned char *buf = new unsigned char[count];
-      for (unsigned int i = 0; i < count; i++) {
-        buf[i] = this->m_processor->read_char_mem(destAddress + i);
+      if (this->buffer.size() < count) {
+        this->buffer.resize(count);
       }
+      unsigned char *buf = count? &this->buffer[0] : NULL;
+      this->m_processor->read_block_mem(destAddress, buf, count);
 #ifdef __GNUC__
       int ret2 = 0, ret = ::write(fd, buf, count);
       if ((fd == STDOUT_FILENO) && (this->stdout_log_file > 0)) {
@@ -274,7 +281,6 @@ class writeIntrinsic : public PlatformIntrinsic<wordSize> {
 #endif
       this->m_processor->set_return_value(ret);
       this->m_processor->return_from_call();
-      delete[] buf;
       this->m_processor->post_call();
 
       if (this->latency.to_double() > 0) {
@@ -288,6 +294,8 @@ class writeIntrinsic : public PlatformIntrinsic<wordSize> {
 
   protected:
     int stdout_log_file;
+    /// Bounce buffer, kept across calls
+    std::vector<unsigned char> buffer;
 };
 
 #if not defined(_WIN32)
@@ -852,10 +860,8 @@ class getenvIntrinsic : public PlatformIntrinsic<wordSize> {
           // the pointer to it
           unsigned int base = this->m_manager->heapPointer;
           this->m_manager->heapPointer += curEnv->second.size() + 1;
-          for (unsigned int i = 0; i < curEnv->second.size(); i++) {
-            this->m_processor->write_char_mem(base + i, curEnv->second[i]);
-          }
-          this->m_processor->write_char_mem(base + curEnv->second.size(), 0);
+          this->m_processor->write_block_mem(base, reinterpret_cast<const unsigned char *>(curEnv->second.c_str()),
+                                             curEnv->second.size() + 1);
           this->m_processor->set_return_value(base);
           this->m_processor->return_from_call();
         }
@@ -1109,10 +1115,8 @@ class mainIntrinsic : public PlatformIntrinsic<wordSize> {
       for (argsIter = this->m_manager->programArgs.begin(), argsEnd = this->m_manager->programArgs.end(); argsIter != argsEnd; argsIter++) {
         this->m_processor->write_mem(argNumAddr, argAddr);
         argNumAddr += 4;
-        for (unsigned int i = 0; i < argsIter->size(); i++) {
-          this->m_processor->write_char_mem(argAddr + i, argsIter->c_str()[i]);
-        }
-        this->m_processor->write_char_mem(argAddr + argsIter->size(), 0);
+        this->m_processor->write_block_mem(argAddr, reinterpret_cast<const unsigned char *>(argsIter->c_str()),
+                                           argsIter->size() + 1);
         argAddr += argsIter->size() + 1;
       }
       this->m_processor->write_mem(argNumAddr, 0);
@@ -1138,6 +1142,123 @@ class notifyIntrinsic : public PlatformIntrinsic<wordSize> {
     }
 };
 
+///Base class of the string.h intrinsics: they run host-side on a
+///bounce buffer and charge latency plus byte_latency (ns) per byte touched
+template<class wordSize>
+class hostMemIntrinsic : public PlatformIntrinsic<wordSize> {
+  public:
+    hostMemIntrinsic(sc_core::sc_module_name mn) :
+      PlatformIntrinsic<wordSize>(mn),
+      g_byte_latency("byte_latency", 0.0) {}
+
+    sr_param<double> g_byte_latency;
+
+  protected:
+    void finish(wordSize ret, unsigned bytes) {
+      this->m_processor->set_return_value(ret);
+      this->m_processor->return_from_call();
+      this->m_processor->post_call();
+
+      sc_time delay = this->latency + sc_time(bytes * (double)g_byte_latency, SC_NS);
+      if (delay.to_double() > 0) {
+        wait(delay);
+      }
+    }
+
+    unsigned char *get_buffer(std::vector<unsigned char> &buffer, unsigned len) {
+      if (buffer.size() < len) {
+        buffer.resize(len);
+      }
+      return len? &buffer[0] : NULL;
+    }
+
+    std::vector<unsigned char> buffer;
+    std::vector<unsigned char> buffer2;
+};
+
+template<class wordSize>
+class memcpyIntrinsic : public hostMemIntrinsic<wordSize> {
+  public:
+    memcpyIntrinsic(sc_core::sc_module_name mn) : hostMemIntrinsic<wordSize>(mn) {}
+    bool operator()() {
+      this->m_processor->pre_call();
+      std::vector<wordSize> callArgs = this->m_processor->read_args();
+      unsigned count = callArgs[2];
+      unsigned char *buf = this->get_buffer(this->buffer, count);
+      this->m_processor->read_block_mem(callArgs[1], buf, count);
+      this->m_processor->write_block_mem(callArgs[0], buf, count);
+      this->finish(callArgs[0], count);
+      return true;
+    }
+};
+
+template<class wordSize>
+class memsetIntrinsic : public hostMemIntrinsic<wordSize> {
+  public:
+    memsetIntrinsic(sc_core::sc_module_name mn) : hostMemIntrinsic<wordSize>(mn) {}
+    bool operator()() {
+      this->m_processor->pre_call();
+      std::vector<wordSize> callArgs = this->m_processor->read_args();
+      unsigned count = callArgs[2];
+      unsigned char *buf = this->get_buffer(this->buffer, count);
+      memset(buf, (unsigned char)callArgs[1], count);
+      this->m_processor->write_block_mem(callArgs[0], buf, count);
+      this->finish(callArgs[0], count);
+      return true;
+    }
+};
+
+template<class wordSize>
+class strlenIntrinsic : public hostMemIntrinsic<wordSize> {
+  public:
+    strlenIntrinsic(sc_core::sc_module_name mn) : hostMemIntrinsic<wordSize>(mn) {}
+    bool operator()() {
+      this->m_processor->pre_call();
+      std::vector<wordSize> callArgs = this->m_processor->read_args();
+      // Read in aligned chunks which never cross a page, so no bytes beyond
+      // the page holding the terminator are touched
+      unsigned char chunk[256];
+      wordSize address = callArgs[0];
+      unsigned len = 0;
+      while (true) {
+        unsigned size = sizeof(chunk) - ((address + len) & (sizeof(chunk) - 1));
+        this->m_processor->read_block_mem(address + len, chunk, size);
+        const unsigned char *end = static_cast<const unsigned char *>(memchr(chunk, 0, size));
+        if (end) {
+          len += end - chunk;
+          break;
+        }
+        len += size;
+      }
+      this->finish(len, len + 1);
+      return true;
+    }
+};
+
+template<class wordSize>
+class memcmpIntrinsic : public hostMemIntrinsic<wordSize> {
+  public:
+    memcmpIntrinsic(sc_core::sc_module_name mn) : hostMemIntrinsic<wordSize>(mn) {}
+    bool operator()() {
+      this->m_processor->pre_call();
+      std::vector<wordSize> callArgs = this->m_processor->read_args();
+      unsigned count = callArgs[2];
+      unsigned char *buf1 = this->get_buffer(this->buffer, count);
+      unsigned char *buf2 = this->get_buffer(this->buffer2, count);
+      this->m_processor->read_block_mem(callArgs[0], buf1, count);
+      this->m_processor->read_block_mem(callArgs[1], buf2, count);
+      int ret = 0;
+      for (unsigned i = 0; i < count; i++) {
+        if (buf1[i] != buf2[i]) {
+          ret = (int)buf1[i] - (int)buf2[i];
+          break;
+        }
+      }
+      this->finish(ret, 2 * count);
+      return true;
+    }
+};
+
 /*
  *  sysconf values per IEEE Std 1003.1, 2004 Edition
  */
@@ -1386,6 +1507,14 @@ typedef mainIntrinsic<unsigned int> mainIntrinsic32;
 SR_HAS_INTRINSIC(mainIntrinsic32);
 typedef notifyIntrinsic<unsigned int> notifyIntrinsic32;
 SR_HAS_INTRINSIC(notifyIntrinsic32);
+typedef memcpyIntrinsic<unsigned int> memcpyIntrinsic32;
+SR_HAS_INTRINSIC(memcpyIntrinsic32);
+typedef memsetIntrinsic<unsigned int> memsetIntrinsic32;
+SR_HAS_INTRINSIC(memsetIntrinsic32);
+typedef strlenIntrinsic<unsigned int> strlenIntrinsic32;
+SR_HAS_INTRINSIC(strlenIntrinsic32);
+typedef memcmpIntrinsic<unsigned int> memcmpIntrinsic32;
+SR_HAS_INTRINSIC(memcmpIntrinsic32);
 
 void IntrinsicBase::correct_flags(int &val){
     int flags = 0;
@@ -0,0 +1,70 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup sr_iss
+/// @{
+/// @file snapshottrigger.h
+/// ISS tool taking a platform snapshot when the processor reaches an address.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#ifndef CORE_SR_ISS_SNAPSHOTTRIGGER_H_
+#define CORE_SR_ISS_SNAPSHOTTRIGGER_H_
+
+#include <map>
+#include <string>
+
+#include "core/base/systemc.h"
+#include "core/base/snapshot.h"
+#include "core/trapgen/common/tools_if.hpp"
+#include "core/trapgen/modules/instruction.hpp"
+
+template<class issueWidth>
+class SnapshotTrigger :
+    public sc_core::sc_object,
+    public trap::ToolsIf<issueWidth> {
+  private:
+    typedef std::multimap<issueWidth, std::string> trigger_map_t;
+    trigger_map_t m_triggers;
+
+  public:
+    SnapshotTrigger(sc_core::sc_module_name mn) : sc_core::sc_object(mn) {}
+
+    ///Saves a snapshot into path before the instruction at pc is executed the
+    ///next time. Every trigger fires once.
+    void save_at(issueWidth pc, const std::string &path) {
+      m_triggers.insert(std::make_pair(pc, path));
+      this->add_hook(pc);
+    }
+
+    ///Takes the snapshot, the instruction itself is executed afterwards
+    bool issue(const issueWidth &curPC, const trap::InstructionBase *curInstr) throw() {
+      typename trigger_map_t::iterator trigger = m_triggers.find(curPC);
+      if (trigger != m_triggers.end()) {
+        std::string path = trigger->second;
+        m_triggers.erase(trigger);
+        if (m_triggers.find(curPC) == m_triggers.end()) {
+          this->remove_hook(curPC);
+        }
+        Snapshot::save(path);
+      }
+      return false;
+    }
+
+    ///The pipeline has to be empty, so the saved state is consistent
+    bool is_pipeline_empty(const issueWidth &curPC) const throw() {
+      return m_triggers.find(curPC) != m_triggers.end();
+    }
+
+    ///Trigger addresses are registered as hooks
+    bool needs_every_issue() const throw() {
+      return false;
+    }
+};
+
+#endif  // CORE_SR_ISS_SNAPSHOTTRIGGER_H_
+/// @}
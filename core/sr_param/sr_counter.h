@@ -0,0 +1,165 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup sr_param
+/// @{
+/// @file sr_counter.h
+/// Performance counters for hot paths. The counter is a plain integer, the
+/// value is copied into a sr_param only when the parameter is read (Python,
+/// CCI tools, power monitors) instead of on every increment.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+#ifndef SR_COUNTER_H_
+#define SR_COUNTER_H_
+
+#include <stdint.h>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// Counter with the same name and place in the parameter tree as a
+/// sr_param<uint64_t>. Increments never execute parameter callbacks.
+/// Writes to the parameter (e.g. a power monitor resetting its counters)
+/// are taken over into the counter.
+class sr_counter {
+  public:
+    typedef uint64_t val_type;
+
+    sr_counter(const std::string &name, gs_param_array &parent) :
+        m_value(0), m_syncing(false), m_param(name, 0ull, parent) {
+      init();
+    }
+
+    sr_counter(const std::string &name, const val_type &value, gs_param_array &parent) :
+        m_value(value), m_syncing(false), m_param(name, value, parent) {
+      init();
+    }
+
+    sr_counter(const std::string &name, const val_type &value) :
+        m_value(value), m_syncing(false), m_param(name, value) {
+      init();
+    }
+
+    sr_counter &operator=(const val_type &value) {
+      m_value = value;
+      return *this;
+    }
+
+    sr_counter &operator+=(const val_type &value) {
+      m_value += value;
+      return *this;
+    }
+
+    sr_counter &operator++() {
+      ++m_value;
+      return *this;
+    }
+
+    val_type operator++(int) {
+      return m_value++;
+    }
+
+    operator val_type() const {
+      return m_value;
+    }
+
+    val_type getValue() const {
+      return m_value;
+    }
+
+    /// Copies the current value into the parameter, post_write observers
+    /// of the parameter are executed.
+    void publish() {
+      sync(gs::cnf::pre_read);
+    }
+
+    sr_param<uint64_t> &param() {
+      return m_param;
+    }
+
+  private:
+    sr_counter(const sr_counter &);
+    sr_counter &operator=(const sr_counter &);
+
+    void init() {
+      m_param.setProperty("mirrors", "counter");
+      m_param.registerParamCallback(new ::gs::cnf::ParamTypedCallbAdapt<sr_counter>(this, &sr_counter::sync_callback, this, &m_param), gs::cnf::pre_read);
+      m_param.registerParamCallback(new ::gs::cnf::ParamTypedCallbAdapt<sr_counter>(this, &sr_counter::sync_callback, this, &m_param), gs::cnf::post_write);
+    }
+
+    void sync(gs::cnf::callback_type reason) {
+      // The parameter accesses below execute the callbacks again
+      if (m_syncing) {
+        return;
+      }
+      m_syncing = true;
+      if (reason == gs::cnf::pre_read) {
+        m_param.setValue(m_value);
+      } else if (reason == gs::cnf::post_write) {
+        m_value = m_param.getValue();
+      }
+      m_syncing = false;
+    }
+
+    gs::cnf::callback_return_type sync_callback(
+        gs::gs_param_base& changed_param,  // NOLINT(runtime/references)
+        gs::cnf::callback_type reason) {
+      sync(reason);
+      return GC_RETURN_OK;
+    }
+
+    /// Hot path value, kept in front of the parameter
+    val_type m_value;
+    bool m_syncing;
+    sr_param<uint64_t> m_param;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const sr_counter &counter) {
+  return os << counter.getValue();
+}
+
+/// A fixed number of counters named 0..size-1 below one parameter array,
+/// e.g. the hits of every cache way.
+class sr_counter_array {
+  public:
+    sr_counter_array(const std::string &name, const size_t &size, gs_param_array &parent) :
+        m_array(name, parent) {
+      for (size_t i = 0; i < size; ++i) {
+        std::ostringstream ss;
+        ss << i;
+        m_counters.push_back(new sr_counter(ss.str(), m_array));
+      }
+    }
+
+    ~sr_counter_array() {
+      for (size_t i = 0; i < m_counters.size(); ++i) {
+        delete m_counters[i];
+      }
+    }
+
+    sr_counter &operator[](const size_t &i) {
+      return *m_counters[i];
+    }
+
+    const sr_counter &operator[](const size_t &i) const {
+      return *m_counters[i];
+    }
+
+    size_t size() const {
+      return m_counters.size();
+    }
+
+  private:
+    sr_counter_array(const sr_counter_array &);
+    sr_counter_array &operator=(const sr_counter_array &);
+
+    gs_param_array m_array;
+    std::vector<sr_counter *> m_counters;
+};
+
+#endif  // SR_COUNTER_H_
+/// @}
@@ -22,6 +22,7 @@ using gs::gs_param;
 
 #include "sr_param_base.h"
 #include "sr_param_class.h"
+#include "sr_counter.h"
 
 #endif  // SR_PARAM_H_
 /// @}
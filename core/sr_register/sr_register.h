@@ -26,8 +26,10 @@
 #define CORE_COMMON_SR_REGISTER_SR_REGISTER_H_
 
 #include <stdexcept>
+#include <cstring>
 #include "systemc.h"
 #include "sc_register.h"
+#include "core/base/snapshot.h"
 #include <sstream>
 
 /// lsb0 mode is used in field position specification.
@@ -83,7 +85,8 @@ enum sr_register_callback_type {
   SR_PRE_READ,
   SR_POST_READ,
   SR_PRE_WRITE,
-  SR_POST_WRITE
+  SR_POST_WRITE,
+  SR_CALLBACK_TYPES
 };
 
 class sr_register_callback_base {
@@ -123,8 +126,7 @@ template<typename DATA_TYPE>
 class sr_register : public sc_register_b<DATA_TYPE> {
   public:
     typedef typename std::vector<sr_register_callback_base *> callback_vector_t;
-    typedef typename std::map<sr_register_callback_type, callback_vector_t > callback_map_t;
-    typedef typename std::map<const char *, sr_register_field<DATA_TYPE> *> field_map_t;
+    typedef typename std::vector<sr_register_field<DATA_TYPE> *> field_vector_t;
 
     sr_register(const char *name, DATA_TYPE init_val, DATA_TYPE write_mask)
       : sc_register_b<DATA_TYPE>(name, init_val), m_write_mask(write_mask), m_access_mode(SC_REG_RW_ACCESS) {
@@ -134,40 +136,38 @@ class sr_register : public sc_register_b<DATA_TYPE> {
     }
 
     ~sr_register() {
-      for(callback_map_t::iterator iter = m_callbacks.begin(); iter != m_callbacks.end(); ++iter) {
-        for(callback_vector_t::iterator item = iter->second.begin(); item != iter->second.end(); ++item) {
+      for(int type = 0; type < SR_CALLBACK_TYPES; ++type) {
+        for(callback_vector_t::iterator item = m_callbacks[type].begin(); item != m_callbacks[type].end(); ++item) {
           delete *item;
         }
-        iter->second.clear();
+        m_callbacks[type].clear();
       }
-      m_callbacks.clear();
 
-      for(typename field_map_t::iterator iter = m_fields.begin(); iter != m_fields.end(); ++iter) {
-        delete iter->second;
+      for(typename field_vector_t::iterator iter = m_fields.begin(); iter != m_fields.end(); ++iter) {
+        delete *iter;
       }
     }
 
     template<typename OWNER>
     sr_register &callback(sr_register_callback_type type, OWNER *owner, typename sr_register_callback<OWNER>::callback_t callback) {
-      callback_map_t::iterator iter = m_callbacks.find(type);
-      if(iter != m_callbacks.end()) {
-        iter->second.push_back(new sr_register_callback<OWNER>(owner, callback));
-      } else {
-        std::pair<sr_register_callback_type, callback_vector_t> pair;
-        pair.first = type;
-        pair.second.push_back(new sr_register_callback<OWNER>(owner, callback));
-        m_callbacks.insert(pair);
-      }
+      m_callbacks[type].push_back(new sr_register_callback<OWNER>(owner, callback));
       return *this;
     }
 
     sr_register &create_field(const char *name, size_t start, size_t end) {
-      m_fields.insert(std::make_pair(name, new sr_register_field<DATA_TYPE>(name, this, start, end)));
+      m_fields.push_back(new sr_register_field<DATA_TYPE>(name, this, start, end));
       return *this;
     }
 
     sr_register_field<DATA_TYPE> &field(const char *name) {
-      return m_fields[name];
+      for(typename field_vector_t::iterator iter = m_fields.begin(); iter != m_fields.end(); ++iter) {
+        if(strcmp((*iter)->name(), name) == 0) {
+          return **iter;
+        }
+      }
+      std::stringstream ss;
+      ss << "Field " << name << " not found";
+      throw std::out_of_range(ss.str());
     }
 
     const DATA_TYPE &get_write_mask() {
@@ -175,11 +175,9 @@ class sr_register : public sc_register_b<DATA_TYPE> {
     }
 
     void raise_callback(const sr_register_callback_type &type) const {
-      callback_map_t::const_iterator map_iter = m_callbacks.find(type);
-      if (map_iter != m_callbacks.end()) {
-        for (callback_vector_t::const_iterator iter = map_iter->second.begin(); iter != map_iter->second.end(); ++iter) {
-          (*iter)->call();
-        }
+      const callback_vector_t &slot = m_callbacks[type];
+      for (callback_vector_t::const_iterator iter = slot.begin(); iter != slot.end(); ++iter) {
+        (*iter)->call();
       }
     }
 
@@ -219,25 +217,9 @@ class sr_register : public sc_register_b<DATA_TYPE> {
     /// Add/Delete Callback objects associated with this region
     virtual scireg_ns::scireg_response scireg_add_callback(scireg_ns::scireg_callback& cb) {
       if(cb.type == scireg_ns::SCIREG_READ_ACCESS || cb.type == scireg_ns::SCIREG_STATE_CHANGE) {
-        callback_map_t::iterator iter = m_callbacks.find(SR_PRE_READ);
-        if(iter != m_callbacks.end()) {
-          iter->second.push_back(new sr_register_scireg_callback(cb, *this));
-        } else {
-          std::pair<sr_register_callback_type, callback_vector_t> pair;
-          pair.first = SR_PRE_READ;
-          pair.second.push_back(new sr_register_scireg_callback(cb, *this));
-          m_callbacks.insert(pair);
-        }
+        m_callbacks[SR_PRE_READ].push_back(new sr_register_scireg_callback(cb, *this));
       } else if(cb.type == scireg_ns::SCIREG_WRITE_ACCESS || cb.type == scireg_ns::SCIREG_STATE_CHANGE) {
-        callback_map_t::iterator iter = m_callbacks.find(SR_POST_WRITE);
-        if(iter != m_callbacks.end()) {
-          iter->second.push_back(new sr_register_scireg_callback(cb, *this));
-        } else {
-          std::pair<sr_register_callback_type, callback_vector_t> pair;
-          pair.first = SR_POST_WRITE;
-          pair.second.push_back(new sr_register_scireg_callback(cb, *this));
-          m_callbacks.insert(pair);
-        }
+        m_callbacks[SR_POST_WRITE].push_back(new sr_register_scireg_callback(cb, *this));
       }
       return scireg_ns::SCIREG_SUCCESS;
     }
@@ -256,19 +238,22 @@ class sr_register : public sc_register_b<DATA_TYPE> {
       this->check_and_init();
     }
 
-    callback_map_t m_callbacks;
-    field_map_t m_fields;
+    /// One callback slot per sr_register_callback_type, indexed by the type
+    callback_vector_t m_callbacks[SR_CALLBACK_TYPES];
+    field_vector_t m_fields;
     DATA_TYPE m_write_mask;
     sc_register_access_mode m_access_mode;
 };
 
 template<typename ADDR_TYPE, typename DATA_TYPE>
-class sr_register_bank : public sc_register_bank<ADDR_TYPE, DATA_TYPE> {
+class sr_register_bank : public sc_register_bank<ADDR_TYPE, DATA_TYPE>, public SnapshotDevice {
   public:
     typedef typename std::map<ADDR_TYPE, sr_register<DATA_TYPE> *> register_map_t;
 
+    typedef typename std::vector<sr_register<DATA_TYPE> *> register_vector_t;
+
     sr_register_bank(const char* name) :
-      sc_register_bank<ADDR_TYPE, DATA_TYPE>(name, 0) {
+      sc_register_bank<ADDR_TYPE, DATA_TYPE>(name, 0), m_sparse(false) {
     }
 
     ~sr_register_bank() {
@@ -277,6 +262,7 @@ class sr_register_bank : public sc_register_bank<ADDR_TYPE, DATA_TYPE> {
         delete iter->second;
       }
       m_register.clear();
+      m_dense.clear();
     }
 
     sr_register<DATA_TYPE> &create_register(const char *name, ADDR_TYPE addr, DATA_TYPE init_val, DATA_TYPE write_mask) {
@@ -284,6 +270,7 @@ class sr_register_bank : public sc_register_bank<ADDR_TYPE, DATA_TYPE> {
       sr_register<DATA_TYPE> *reg = new sr_register<DATA_TYPE>(name, init_val, write_mask);
       sr_hierarchy_pop();
       m_register[addr] = reg;
+      add_dense(addr, reg);
       m_registers.push_back(reg);
       this->m_size = m_registers.size();
       return *reg;
@@ -293,7 +280,9 @@ class sr_register_bank : public sc_register_bank<ADDR_TYPE, DATA_TYPE> {
       sr_hierarchy_push(this);
       sr_register<DATA_TYPE> *reg = new sr_register<DATA_TYPE>(name, descr, init_val, write_mask);
       sr_hierarchy_pop();
-      m_register.insert(std::make_pair(addr, reg));
+      if (m_register.insert(std::make_pair(addr, reg)).second) {
+        add_dense(addr, reg);
+      }
       m_registers.push_back(reg);
       this->m_size = m_registers.size();
       return *reg;
@@ -346,17 +335,18 @@ class sr_register_bank : public sc_register_bank<ADDR_TYPE, DATA_TYPE> {
     const sc_register_vec& get_registers() const { return m_registers; }
 
     const sr_register<DATA_TYPE> *get_sr_register(const ADDR_TYPE &offset) const {
-      typename register_map_t::const_iterator item = m_register.find(offset);
-      if (item != m_register.end()) {
-          return item->second;
-      }
-      return NULL;
+      return const_cast<sr_register_bank *>(this)->get_sr_register(offset);
     }
 
     sr_register<DATA_TYPE> *get_sr_register(const ADDR_TYPE &offset) {
-      typename register_map_t::iterator item = m_register.find(offset);
-      if (item != m_register.end()) {
-          return item->second;
+      if (offset % sizeof(DATA_TYPE) == 0 && offset / sizeof(DATA_TYPE) < m_dense.size()) {
+        return m_dense[offset / sizeof(DATA_TYPE)];
+      }
+      if (m_sparse) {
+        typename register_map_t::iterator item = m_register.find(offset);
+        if (item != m_register.end()) {
+            return item->second;
+        }
       }
       return NULL;
     }
@@ -439,10 +429,59 @@ class sr_register_bank : public sc_register_bank<ADDR_TYPE, DATA_TYPE> {
       }
     }
 
+    /// Saves the raw values of all registers, no callbacks are triggered.
+    void snapshot_save(Snapshot &snapshot) {
+      std::vector<DATA_TYPE> values(m_registers.size(), 0);
+      scireg_ns::vector_byte value;
+      for (size_t i = 0; i < m_registers.size(); ++i) {
+        if (m_registers[i]->scireg_read(value, sizeof(DATA_TYPE), 0) == scireg_ns::SCIREG_SUCCESS) {
+          memcpy(&values[i], &value[0], sizeof(DATA_TYPE));
+        }
+      }
+      snapshot.put("registers", values);
+    }
+
+    /// Writes the raw values of all registers, no callbacks are triggered.
+    /// The owning model restores its derived state afterwards.
+    void snapshot_restore(Snapshot &snapshot) {
+      std::vector<DATA_TYPE> values;
+      if (!snapshot.get("registers", values) || values.size() != m_registers.size()) {
+        SC_REPORT_WARNING(this->name(), "The register bank differs from the snapshot, the registers are kept");
+        return;
+      }
+      scireg_ns::vector_byte value(sizeof(DATA_TYPE));
+      for (size_t i = 0; i < m_registers.size(); ++i) {
+        memcpy(&value[0], &values[i], sizeof(DATA_TYPE));
+        m_registers[i]->scireg_write(value, sizeof(DATA_TYPE), 0);
+      }
+    }
 
   protected:
+    /// Largest number of word slots held in the dense table (a 4 KB window).
+    static const uint32_t DENSE_LIMIT = 4096 / sizeof(DATA_TYPE);
+
+    /// Registers at word aligned offsets inside the window go into the dense table,
+    /// all others are only reachable through the map.
+    void add_dense(const ADDR_TYPE &addr, sr_register<DATA_TYPE> *reg) {
+      if (addr % sizeof(DATA_TYPE) != 0 || addr / sizeof(DATA_TYPE) >= DENSE_LIMIT) {
+        m_sparse = true;
+        return;
+      }
+      size_t index = addr / sizeof(DATA_TYPE);
+      if (index >= m_dense.size()) {
+        m_dense.resize(index + 1, NULL);
+      }
+      m_dense[index] = reg;
+    }
+
     sc_register_vec m_registers;
     register_map_t m_register;
+
+    /// Offset indexed view of m_register, one slot per DATA_TYPE word
+    register_vector_t m_dense;
+
+    /// True if some register lives outside of m_dense
+    bool m_sparse;
 };
 
 #endif  // CORE_COMMON_SR_REGISTER_H_
@@ -39,6 +39,17 @@ namespace v {
 #endif
 #endif
 
+/// Key of a report pair or the message of a report.
+/// Only keeps the pointer, so a string literal key costs nothing as long as
+/// the report is disabled. std::string keys stay valid for the full
+/// expression they appear in, which is all a report needs.
+class key {
+  public:
+    key(const char *str) : str(str) {}  // NOLINT(runtime/explicit)
+    key(const std::string &str) : str(str.c_str()) {}  // NOLINT(runtime/explicit)
+    const char *str;
+};
+
 class pair {
   public:
     pair(const std::string name, int8_t value) : name(name), type(INT32), data(value) {
@@ -158,123 +169,123 @@ class sr_report : public sc_core::sc_report {
       this->msg = result;
     }
 
-    inline sr_report &operator()(const std::string &name, int8_t value) {
+    inline sr_report &operator()(v::key name, int8_t value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, int16_t value) {
+    inline sr_report &operator()(v::key name, int16_t value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, int32_t value) {
+    inline sr_report &operator()(v::key name, int32_t value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, uint8_t value) {
+    inline sr_report &operator()(v::key name, uint8_t value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, uint16_t value) {
+    inline sr_report &operator()(v::key name, uint16_t value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, uint32_t value) {
+    inline sr_report &operator()(v::key name, uint32_t value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, int64_t value) {
+    inline sr_report &operator()(v::key name, int64_t value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
 #if not defined(NC_SYSTEMC) and not defined(_WIN32)
-    inline sr_report &operator()(const std::string &name, sc_dt::int64 value) {
+    inline sr_report &operator()(v::key name, sc_dt::int64 value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, (int64_t)value));
+        pairs.push_back(v::pair(name.str, (int64_t)value));
       }
       return *this;
     }
 #endif
 
-    inline sr_report &operator()(const std::string &name, uint64_t value) {
+    inline sr_report &operator()(v::key name, uint64_t value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
 #if not defined(NC_SYSTEMC) and not defined(_WIN32)
-    inline sr_report &operator()(const std::string &name, sc_dt::uint64 value) {
+    inline sr_report &operator()(v::key name, sc_dt::uint64 value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, (uint64_t)value));
+        pairs.push_back(v::pair(name.str, (uint64_t)value));
       }
       return *this;
     }
 #endif
 
-    inline sr_report &operator()(const std::string &name, std::string value) {
+    inline sr_report &operator()(v::key name, std::string value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, const char value[]) {
+    inline sr_report &operator()(v::key name, const char value[]) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, std::string(value)));
+        pairs.push_back(v::pair(name.str, std::string(value)));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, char value[]) {
+    inline sr_report &operator()(v::key name, char value[]) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, std::string(value)));
+        pairs.push_back(v::pair(name.str, std::string(value)));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, bool value) {
+    inline sr_report &operator()(v::key name, bool value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, double value) {
+    inline sr_report &operator()(v::key name, double value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline sr_report &operator()(const std::string &name, sc_core::sc_time value) {
+    inline sr_report &operator()(v::key name, sc_core::sc_time value) {
       if( __builtin_expect( enabled, 0 ) ) {
-        pairs.push_back(v::pair(name, value));
+        pairs.push_back(v::pair(name.str, value));
       }
       return *this;
     }
 
-    inline void operator()(const std::string &name = "");
+    inline void operator()(v::key name = "");
 
     bool enabled;
     sc_core::sc_actions actions;
@@ -334,6 +345,13 @@ class sr_report_handler : public sc_core::sc_report_handler {
       return rep;
     }
 
+    /// True if an SC_INFO report with the given verbosity passes the global
+    /// verbosity level. Used by the report macros to skip building a
+    /// disabled report and evaluating its key/value arguments.
+    static inline bool is_verbose(int verbosity_) {
+      return __builtin_expect(verbosity_ <= sr_report_handler::get_verbosity_level(), 0);
+    }
+
     static void set_filter_to_whitelist(bool value) {
       sr_report_handler::blacklist = !value;
     }
@@ -354,7 +372,7 @@ class sr_report_handler : public sc_core::sc_report_handler {
 
     static void default_handler(const sc_core::sc_report &rep, const sc_core::sc_actions &actions);
 
-  friend void sr_report::operator()(const std::string &name);
+  friend void sr_report::operator()(v::key name);
   private:
     static sr_report rep;
     static sr_report null;
@@ -364,10 +382,10 @@ class sr_report_handler : public sc_core::sc_report_handler {
     static std::map< const sc_core::sc_object *, std::pair<sc_core::sc_severity, int> > filter;
 };
 
-void sr_report::operator()(const std::string &name) {
+void sr_report::operator()(v::key name) {
   if ( __builtin_expect( this != &sr_report_handler::null && enabled, 0 )  ) {
-    if(name != "") {
-      set_msg(name.c_str());
+    if(*name.str) {
+      set_msg(name.str);
     }
     sr_report_handler::handler(*this, actions);
   }
@@ -376,8 +394,11 @@ void sr_report::operator()(const std::string &name) {
 #define _GET_MACRO_(dummy,_1,NAME,...) NAME
 #define _GET_MACRO_2_(dummy,_1,_2,NAME,...) NAME
 
+// Levels at or above VERBOSITY (waf configure --verbosity) are compiled out.
+// Otherwise a report below the runtime verbosity level costs one branch:
+// neither the report nor its key/value arguments get evaluated.
 #define srDebug(...) \
-  if(5 >= VERBOSITY) {} else \
+  if((5 >= VERBOSITY) || !sr_report_handler::is_verbose(sc_core::SC_DEBUG)) {} else \
     _GET_MACRO_(dummy,##__VA_ARGS__,srDebug_1(__VA_ARGS__),srDebug_0())
 
 #define srDebug_0() \
@@ -419,7 +440,7 @@ void sr_report::operator()(const std::string &name) {
 
 // for data to be analysed by ipython
 #define srAnalyse(...) \
-  if(4 >= VERBOSITY) {} else \
+  if((4 >= VERBOSITY) || !sr_report_handler::is_verbose(sc_core::SC_FULL)) {} else \
     _GET_MACRO_(dummy,##__VA_ARGS__,srAnalyse_1(__VA_ARGS__),srAnalyse_0())
 
 #define srAnalyse_0() \
@@ -433,7 +454,7 @@ void sr_report::operator()(const std::string &name) {
       sc_core::SC_FULL, __FILE__ , __LINE__)
 
 #define srInfo(...) \
-  if(3 >= VERBOSITY) {} else \
+  if((3 >= VERBOSITY) || !sr_report_handler::is_verbose(sc_core::SC_LOW)) {} else \
     _GET_MACRO_(dummy,##__VA_ARGS__,srInfo_1(__VA_ARGS__),srInfo_0())
 
 #define srInfo_0() \
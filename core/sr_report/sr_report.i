@@ -38,10 +38,13 @@ enum sc_severity {
 void set_filter_to_whitelist(bool value);
 void add_sc_object_to_filter(sc_core::sc_object *obj, sc_core::sc_severity severity, int verbosity);
 void remove_sc_object_from_filter(sc_core::sc_object *obj);
+bool open_sink(const char *filename);
+void close_sink();
 
 
 %{
 #include "sr_report.h"
+#include "sr_report_sink.h"
 
 void set_filter_to_whitelist(bool value) {
   sr_report_handler::set_filter_to_whitelist(value);
@@ -59,6 +62,14 @@ void remove_sc_object_from_filter(sc_core::sc_object *obj) {
   }
 }
 
+bool open_sink(const char *filename) {
+  return sr_report_sink::open(filename);
+}
+
+void close_sink() {
+  sr_report_sink::close();
+}
+
 /*
 std::vector<sc_core::sc_object *> show_sc_object_in_filter() {
   sr_report_handler::show_sc_object_in_filter();
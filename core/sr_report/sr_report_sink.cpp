@@ -0,0 +1,281 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup sr_report
+/// @{
+/// @file sr_report_sink.cpp
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+/// File layout (host byte order, the order mark tells the reader which one):
+///
+///   header: "SRREPORT" u32 version u32 0x01020304
+///   block:  u32 "SBLK" u32 rows u32 columns, then for each column:
+///           u16 name length, name, u8 type (v::pair::type),
+///           presence bitmap of (rows + 7) / 8 bytes (bit i set: row i has a value),
+///           u32 data length, the values of all present rows.
+///
+/// Numbers are stored with their natural width, bools as one byte, time as
+/// double in default time units and strings as u16 length followed by the bytes.
+#include <string.h>
+#include <algorithm>
+
+#include "sr_report_sink.h"
+
+sr_report_sink *sr_report_sink::instance = NULL;
+sc_core::sc_report_handler_proc sr_report_sink::previous = NULL;
+
+namespace {
+
+const uint32_t BLOCK_MAGIC = 0x4b4c4253;  // "SBLK"
+
+template<typename T>
+inline void put(std::vector<uint8_t> &buf, const T &value) {
+  const uint8_t *ptr = reinterpret_cast<const uint8_t *>(&value);
+  buf.insert(buf.end(), ptr, ptr + sizeof(T));
+}
+
+inline void put_str(std::vector<uint8_t> &buf, const char *str) {
+  size_t len = (str)? strlen(str) : 0;
+  uint16_t size = static_cast<uint16_t>(std::min(len, static_cast<size_t>(0xFFFF)));
+  put(buf, size);
+  buf.insert(buf.end(), str, str + size);
+}
+
+template<typename T>
+inline T get(const uint8_t *&ptr) {
+  T value;
+  memcpy(&value, ptr, sizeof(T));
+  ptr += sizeof(T);
+  return value;
+}
+
+/// Size of an encoded value of the given type starting at ptr
+inline size_t value_size(uint8_t type, const uint8_t *ptr) {
+  switch (type) {
+    case v::pair::INT32:
+    case v::pair::UINT32: return 4;
+    case v::pair::INT64:
+    case v::pair::UINT64:
+    case v::pair::DOUBLE:
+    case v::pair::TIME:   return 8;
+    case v::pair::BOOL:   return 1;
+    case v::pair::STRING: {
+      uint16_t len;
+      memcpy(&len, ptr, sizeof(len));
+      return sizeof(len) + len;
+    }
+    default:              return 0;
+  }
+}
+
+/// Joins the writer thread if nobody closed the sink before exit.
+struct sink_guard {
+  ~sink_guard() {
+    sr_report_sink::close();
+  }
+} guard;
+
+}  // namespace
+
+sr_report_sink::sr_report_sink(FILE *file) :
+  m_file(file), m_ring(RING_SIZE), m_running(true), m_rows(0) {
+  fwrite("SRREPORT", 1, 8, m_file);
+  uint32_t header[2] = { VERSION, 0x01020304 };
+  fwrite(header, sizeof(uint32_t), 2, m_file);
+  m_thread = boost::thread(&sr_report_sink::run, this);
+}
+
+sr_report_sink::~sr_report_sink() {
+  m_running = false;
+  m_thread.join();
+  fclose(m_file);
+}
+
+bool sr_report_sink::open(const char *filename) {
+  close();
+  FILE *file = fopen(filename, "wb");
+  if (!file) {
+    return false;
+  }
+  instance = new sr_report_sink(file);
+  previous = sr_report_handler::handler;
+  sr_report_handler::handler = &sr_report_sink::handler;
+  return true;
+}
+
+void sr_report_sink::close() {
+  if (instance) {
+    sr_report_handler::handler = previous;
+    delete instance;
+    instance = NULL;
+    previous = NULL;
+  }
+}
+
+void sr_report_sink::handler(const sc_core::sc_report &rep, const sc_core::sc_actions &actions) {
+  if (rep.get_severity() == sc_core::SC_MAX_SEVERITY) {
+    // Commands are no reports, they have to reach the Python side.
+    previous(rep, actions);
+    return;
+  }
+  instance->push(rep, actions);
+  if (rep.get_severity() != sc_core::SC_INFO) {
+    previous(rep, actions);
+  }
+}
+
+void sr_report_sink::push(const sc_core::sc_report &rep, const sc_core::sc_actions &actions) {
+  std::vector<uint8_t> &buf = m_record;
+  buf.clear();
+  put(buf, uint32_t(0));  // record size, patched below
+  put(buf, static_cast<int32_t>(rep.get_severity()));
+  put(buf, static_cast<int32_t>(rep.get_line_number()));
+  put(buf, static_cast<int32_t>(rep.get_verbosity()));
+  put(buf, static_cast<uint32_t>(actions));
+  put(buf, static_cast<uint64_t>(sc_core::sc_delta_count()));
+  put(buf, rep.get_time().to_default_time_units());
+  put_str(buf, rep.get_msg_type());
+  put_str(buf, rep.get_msg());
+  put_str(buf, rep.get_file_name());
+  put_str(buf, rep.get_process_name());
+
+  const sr_report *srr = dynamic_cast<const sr_report *>(&rep);
+  uint16_t count = (srr)? static_cast<uint16_t>(srr->pairs.size()) : 0;
+  put(buf, count);
+  for (uint16_t i = 0; i < count; ++i) {
+    const v::pair &pair = srr->pairs[i];
+    put_str(buf, pair.name.c_str());
+    put(buf, static_cast<uint8_t>(pair.type));
+    switch (pair.type) {
+      case v::pair::INT32:  put(buf, boost::any_cast<int32_t>(pair.data)); break;
+      case v::pair::UINT32: put(buf, boost::any_cast<uint32_t>(pair.data)); break;
+      case v::pair::INT64:  put(buf, boost::any_cast<int64_t>(pair.data)); break;
+      case v::pair::UINT64: put(buf, boost::any_cast<uint64_t>(pair.data)); break;
+      case v::pair::STRING: put_str(buf, boost::any_cast<std::string>(pair.data).c_str()); break;
+      case v::pair::BOOL:   put(buf, static_cast<uint8_t>(boost::any_cast<bool>(pair.data))); break;
+      case v::pair::DOUBLE: put(buf, boost::any_cast<double>(pair.data)); break;
+      case v::pair::TIME:   put(buf, boost::any_cast<sc_core::sc_time>(pair.data).to_default_time_units()); break;
+    }
+  }
+  uint32_t size = buf.size();
+  memcpy(&buf[0], &size, sizeof(size));
+
+  // The ring only blocks the simulation if the writer falls behind.
+  const uint8_t *ptr = &buf[0];
+  while (size) {
+    size_t pushed = m_ring.push(ptr, size);
+    ptr += pushed;
+    size -= pushed;
+    if (size) {
+      boost::this_thread::yield();
+    }
+  }
+}
+
+void sr_report_sink::run() {
+  uint8_t chunk[65536];
+  while (true) {
+    // Read the flag first, everything pushed before close() is popped afterwards.
+    bool running = m_running;
+    size_t popped = m_ring.pop(chunk, sizeof(chunk));
+    if (popped) {
+      m_staging.insert(m_staging.end(), chunk, chunk + popped);
+      decode();
+    } else if (running) {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    } else {
+      break;
+    }
+  }
+  if (m_rows) {
+    write_block();
+  }
+  fflush(m_file);
+}
+
+void sr_report_sink::decode() {
+  size_t pos = 0;
+  while (m_staging.size() - pos >= sizeof(uint32_t)) {
+    const uint8_t *ptr = &m_staging[pos];
+    uint32_t size;
+    memcpy(&size, ptr, sizeof(size));
+    if (m_staging.size() - pos < size) {
+      break;
+    }
+    ptr += sizeof(size);
+    append("severity", v::pair::INT32, ptr, 4); ptr += 4;
+    append("line_number", v::pair::INT32, ptr, 4); ptr += 4;
+    append("verbosity", v::pair::INT32, ptr, 4); ptr += 4;
+    append("actions", v::pair::UINT32, ptr, 4); ptr += 4;
+    append("delta_count", v::pair::UINT64, ptr, 8); ptr += 8;
+    append("time", v::pair::DOUBLE, ptr, 8); ptr += 8;
+    static const char *strings[] = { "message_type", "message_text", "file_name", "process_name" };
+    for (int i = 0; i < 4; ++i) {
+      size_t len = value_size(v::pair::STRING, ptr);
+      append(strings[i], v::pair::STRING, ptr, len);
+      ptr += len;
+    }
+    uint16_t count = get<uint16_t>(ptr);
+    for (uint16_t i = 0; i < count; ++i) {
+      uint16_t len = get<uint16_t>(ptr);
+      std::string name(reinterpret_cast<const char *>(ptr), len);
+      ptr += len;
+      uint8_t type = get<uint8_t>(ptr);
+      size_t bytes = value_size(type, ptr);
+      append(name, type, ptr, bytes);
+      ptr += bytes;
+    }
+    pos += size;
+    if (++m_rows == BLOCK_ROWS) {
+      write_block();
+    }
+  }
+  m_staging.erase(m_staging.begin(), m_staging.begin() + pos);
+}
+
+void sr_report_sink::append(const std::string &name, uint8_t type, const uint8_t *data, size_t len) {
+  std::pair<std::map<std::pair<std::string, uint8_t>, size_t>::iterator, bool> item =
+    m_column_index.insert(std::make_pair(std::make_pair(name, type), m_columns.size()));
+  if (item.second) {
+    m_columns.push_back(column());
+    m_columns.back().name = name;
+    m_columns.back().type = type;
+  }
+  column &col = m_columns[item.first->second];
+  // A key reported twice in one report keeps the first value.
+  size_t bytes = (m_rows >> 3) + 1;
+  if (col.present.size() < bytes) {
+    col.present.resize(bytes, 0);
+  } else if (col.present[m_rows >> 3] & (1 << (m_rows & 7))) {
+    return;
+  }
+  col.present[m_rows >> 3] |= 1 << (m_rows & 7);
+  col.data.insert(col.data.end(), data, data + len);
+}
+
+void sr_report_sink::write_block() {
+  uint32_t header[3] = { BLOCK_MAGIC, m_rows, static_cast<uint32_t>(m_columns.size()) };
+  fwrite(header, sizeof(uint32_t), 3, m_file);
+  size_t bytes = (m_rows + 7) >> 3;
+  for (std::vector<column>::iterator col = m_columns.begin(); col != m_columns.end(); ++col) {
+    uint16_t len = static_cast<uint16_t>(col->name.size());
+    fwrite(&len, sizeof(len), 1, m_file);
+    fwrite(col->name.data(), 1, len, m_file);
+    fwrite(&col->type, 1, 1, m_file);
+    col->present.resize(bytes, 0);
+    fwrite(&col->present[0], 1, bytes, m_file);
+    uint32_t size = col->data.size();
+    fwrite(&size, sizeof(size), 1, m_file);
+    if (size) {
+      fwrite(&col->data[0], 1, size, m_file);
+    }
+  }
+  m_columns.clear();
+  m_column_index.clear();
+  m_rows = 0;
+}
+
+/// @}
@@ -0,0 +1,102 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup sr_report
+/// @{
+/// @file sr_report_sink.h
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+/// Native backend handler which stores reports in a columnar binary file.
+/// The simulation thread only serializes each report into a lock-free ring
+/// buffer. A background thread collects the reports into column blocks and
+/// writes them to disk. The files are read offline by usi.log.sink_reader.
+#ifndef SR_REPORT_SINK_H_
+#define SR_REPORT_SINK_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "sr_report.h"
+
+class sr_report_sink {
+  public:
+    /// File layout version, increase on every incompatible change
+    static const uint32_t VERSION = 1;
+
+    /// Reports per column block
+    static const uint32_t BLOCK_ROWS = 65536;
+
+    /// Size of the ring buffer between simulation and writer thread in bytes
+    static const uint32_t RING_SIZE = 4 << 20;
+
+    /// Installs the sink as sr_report_handler::handler and starts the writer.
+    /// Reports which are not plain infos (warnings, errors, commands) are still
+    /// passed on to the previously installed handler.
+    static bool open(const char *filename);
+
+    /// Drains the ring buffer, writes the last block and restores the previous handler.
+    static void close();
+
+    static bool is_open() {
+      return instance != NULL;
+    }
+
+    static void handler(const sc_core::sc_report &rep, const sc_core::sc_actions &actions);
+
+  private:
+    /// One column of the current block. A column is identified by name and type.
+    struct column {
+      std::string name;
+      uint8_t type;
+      std::vector<uint8_t> present;
+      std::vector<uint8_t> data;
+    };
+
+    explicit sr_report_sink(FILE *file);
+    ~sr_report_sink();
+
+    /// Serializes a report into m_record and pushes it into the ring.
+    void push(const sc_core::sc_report &rep, const sc_core::sc_actions &actions);
+
+    /// Writer thread main loop
+    void run();
+
+    /// Splits the records in m_staging into the block columns.
+    void decode();
+
+    void append(const std::string &name, uint8_t type, const uint8_t *data, size_t len);
+
+    /// Writes the current block and starts a new one.
+    void write_block();
+
+    static sr_report_sink *instance;
+    static sc_core::sc_report_handler_proc previous;
+
+    FILE *m_file;
+
+    boost::lockfree::spsc_queue<uint8_t> m_ring;
+    boost::atomic<bool> m_running;
+    boost::thread m_thread;
+
+    /// Producer side scratch buffer for a single record
+    std::vector<uint8_t> m_record;
+
+    /// Consumer side bytes popped from the ring but not decoded yet
+    std::vector<uint8_t> m_staging;
+
+    std::vector<column> m_columns;
+    std::map<std::pair<std::string, uint8_t>, size_t> m_column_index;
+    uint32_t m_rows;
+};
+
+#endif  // SR_REPORT_SINK_H_
+/// @}
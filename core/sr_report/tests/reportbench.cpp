@@ -0,0 +1,71 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup common
+/// @{
+/// @file reportbench.cpp
+/// Measures the cost of a single report call with the report enabled and
+/// disabled by the runtime verbosity level.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+// Keep every report level in the binary, only the runtime level decides
+#define VERBOSITY 6
+
+#include <stdint.h>
+#include <ctime>
+#include <iostream>
+#include "core/base/systemc.h"
+#include "core/sr_report/sr_report.h"
+
+namespace {
+
+uint64_t delivered = 0;
+
+/// Counts the reports instead of printing them, so no I/O is measured
+void count_handler(const sc_core::sc_report &rep, const sc_core::sc_actions &actions) {
+  delivered++;
+}
+
+/// Issues calls reports with each macro, returns the time per report in ns
+double measure(uint64_t calls) {
+  std::clock_t begin = std::clock();
+  for (uint64_t i = 0; i < calls; i++) {
+    srDebug("reportbench")("index", i)("address", static_cast<uint32_t>(i << 2))("Debug report");
+    srAnalyse("reportbench")("index", i)("length", 4)("Analyse report");
+    srInfo("reportbench")("index", i)("Info report");
+  }
+  double seconds = static_cast<double>(std::clock() - begin) / CLOCKS_PER_SEC;
+  return seconds * 1e9 / (calls * 3);
+}
+
+}  // namespace
+
+int sc_main(int argc, char *argv[]) {
+  sc_core::sc_report_handler::set_handler(count_handler);
+  int errors = 0;
+
+  const uint64_t disabled_calls = 10000000;
+  sc_core::sc_report_handler::set_verbosity_level(sc_core::SC_NONE);
+  double disabled = measure(disabled_calls);
+  std::cout << "disabled: " << disabled << " ns per report" << std::endl;
+  if (delivered != 0) {
+    std::cout << "Disabled reports reached the handler" << std::endl;
+    errors++;
+  }
+
+  const uint64_t enabled_calls = 1000000;
+  sc_core::sc_report_handler::set_verbosity_level(sc_core::SC_DEBUG);
+  double enabled = measure(enabled_calls);
+  std::cout << "enabled:  " << enabled << " ns per report" << std::endl;
+  if (delivered != enabled_calls * 3) {
+    std::cout << "Only " << delivered << " of " << enabled_calls * 3 << " enabled reports reached the handler" << std::endl;
+    errors++;
+  }
+  return errors ? 1 : 0;
+}
+/// @}
@@ -70,6 +70,35 @@ class signal_out : public signal_base<TYPE, MODULE> ,
             }
         }
 
+        /// Number of connected receivers
+        size_t receivers() const {
+            return m_receiver.size();
+        }
+
+        /// Receiver with the given index, in binding order
+        signal_in_if<TYPE> *receiver(size_t index) const {
+            return m_receiver[index];
+        }
+
+        /// Write the value of a signal to a subset of the receivers.
+        /// Stores the value and triggers an update in every receiver accepted
+        /// by the filter.
+        ///
+        /// @param value The new value of the signal.
+        /// @param filter Called as filter(index, value) with the index of a
+        ///               receiver, returns false if it does not need the value.
+        /// @param time The delay from sc_timestamp() at propagation.
+        template<class FILTER>
+        void write_filtered(const TYPE &value, FILTER &filter,
+                const sc_core::sc_time &time = sc_core::SC_ZERO_TIME) {
+            this->m_value = value;
+            for (size_t i = 0; i < m_receiver.size(); i++) {
+                if (filter(i, value)) {
+                    m_receiver[i]->update((signal_out_if<TYPE> *)this, time);
+                }
+            }
+        }
+
         /// Connecting the Signal with an input signal.
         /// Calls caller and receiver bind methods.
         ///
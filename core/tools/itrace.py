@@ -0,0 +1,225 @@
+#!/usr/bin/env python
+# vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 filetype=python :
+"""
+Decoder for the binary LEON3 instruction traces (cpu.traceFile parameter).
+
+Renders one line per executed instruction:
+
+  <time> <cycles> <pc> <opcode> <mnemonic> [ea]
+
+time is the simulated time in ns at the end of the instruction, cycles the
+number of clock cycles the instruction took. ea is printed for loads and
+stores only. Compressed traces (cpu.traceCompress) are read transparently.
+
+Usage: itrace.py [-n COUNT] [--raw] trace.itrace
+"""
+from __future__ import print_function
+import argparse
+import gzip
+import struct
+import sys
+
+REGS = ['%g0', '%g1', '%g2', '%g3', '%g4', '%g5', '%g6', '%g7',
+        '%o0', '%o1', '%o2', '%o3', '%o4', '%o5', '%sp', '%o7',
+        '%l0', '%l1', '%l2', '%l3', '%l4', '%l5', '%l6', '%l7',
+        '%i0', '%i1', '%i2', '%i3', '%i4', '%i5', '%fp', '%i7']
+
+ICC = ['n', 'e', 'le', 'l', 'leu', 'cs', 'neg', 'vs',
+       'a', 'ne', 'g', 'ge', 'gu', 'cc', 'pos', 'vc']
+
+FCC = ['n', 'ne', 'lg', 'ul', 'l', 'ug', 'g', 'u',
+       'a', 'e', 'ue', 'ge', 'uge', 'le', 'ule', 'o']
+
+ALU = {
+    0x00: 'add', 0x01: 'and', 0x02: 'or', 0x03: 'xor',
+    0x04: 'sub', 0x05: 'andn', 0x06: 'orn', 0x07: 'xnor',
+    0x08: 'addx', 0x0a: 'umul', 0x0b: 'smul', 0x0c: 'subx',
+    0x0e: 'udiv', 0x0f: 'sdiv',
+    0x20: 'taddcc', 0x21: 'tsubcc', 0x22: 'taddcctv', 0x23: 'tsubcctv',
+    0x24: 'mulscc', 0x25: 'sll', 0x26: 'srl', 0x27: 'sra',
+    0x3c: 'save', 0x3d: 'restore',
+}
+
+MEM = {
+    0x00: 'ld', 0x01: 'ldub', 0x02: 'lduh', 0x03: 'ldd',
+    0x04: 'st', 0x05: 'stb', 0x06: 'sth', 0x07: 'std',
+    0x09: 'ldsb', 0x0a: 'ldsh', 0x0d: 'ldstub', 0x0f: 'swap',
+    0x20: 'ld', 0x21: 'ld', 0x23: 'ldd', 0x24: 'st', 0x25: 'st',
+    0x26: 'std', 0x27: 'std',
+    0x30: 'ld', 0x31: 'ld', 0x33: 'ldd', 0x34: 'st', 0x35: 'st',
+    0x36: 'std', 0x37: 'std',
+}
+
+def simm(value, bits):
+    if value & (1 << (bits - 1)):
+        value -= 1 << bits
+    return value
+
+def hexs(value):
+    return ('-0x%x' % -value) if value < 0 else ('0x%x' % value)
+
+def address(rs1, i, simm13, rs2):
+    if i:
+        if simm13 == 0:
+            return REGS[rs1]
+        if rs1 == 0:
+            return hexs(simm13)
+        return '%s %s %s' % (REGS[rs1], '-' if simm13 < 0 else '+', hexs(abs(simm13)))
+    if rs2 == 0:
+        return REGS[rs1]
+    return '%s + %s' % (REGS[rs1], REGS[rs2])
+
+def disassemble(pc, op):
+    """Returns the SPARC V8 mnemonic of a single instruction word"""
+    fmt = op >> 30
+    rd = (op >> 25) & 0x1f
+    if fmt == 1:
+        return 'call 0x%08x' % ((pc + (simm(op & 0x3fffffff, 30) << 2)) & 0xffffffff)
+    if fmt == 0:
+        op2 = (op >> 22) & 0x7
+        if op2 == 4:
+            imm22 = op & 0x3fffff
+            if rd == 0 and imm22 == 0:
+                return 'nop'
+            return 'sethi %%hi(0x%08x), %s' % (imm22 << 10, REGS[rd])
+        if op2 in (2, 6, 7):
+            cond = (op >> 25) & 0xf
+            annul = ',a' if op & (1 << 29) else ''
+            target = (pc + (simm(op & 0x3fffff, 22) << 2)) & 0xffffffff
+            if op2 == 2:
+                name = 'b' + ICC[cond]
+            elif op2 == 6:
+                name = 'fb' + FCC[cond]
+            else:
+                name = 'cb%d' % cond
+            return '%s%s 0x%08x' % (name, annul, target)
+        return 'unimp 0x%x' % (op & 0x3fffff)
+
+    op3 = (op >> 19) & 0x3f
+    rs1 = (op >> 14) & 0x1f
+    i = (op >> 13) & 0x1
+    rs2 = op & 0x1f
+    simm13 = simm(op & 0x1fff, 13)
+    operand = hexs(simm13) if i else REGS[rs2]
+
+    if fmt == 3:
+        name = MEM.get(op3 & 0x2f if op3 < 0x20 else op3)
+        if name is None:
+            return 'unknown 0x%08x' % op
+        alternate = op3 < 0x20 and op3 & 0x10
+        addr = '[%s]' % address(rs1, i, simm13, rs2)
+        if alternate:
+            addr += ' %d' % ((op >> 5) & 0xff)
+            name += 'a'
+        if op3 >= 0x30:
+            reg = {0x31: '%csr', 0x35: '%csr', 0x36: '%cq'}.get(op3, '%%c%d' % rd)
+        elif op3 >= 0x20:
+            reg = {0x21: '%fsr', 0x25: '%fsr', 0x26: '%fq'}.get(op3, '%%f%d' % rd)
+        else:
+            reg = REGS[rd]
+        if (op3 & 0x0f) in (0x04, 0x05, 0x06, 0x07) and op3 != 0x0d:
+            return '%s %s, %s' % (name, reg, addr)
+        return '%s %s, %s' % (name, addr, reg)
+
+    # fmt == 2
+    base = op3 & 0x2f if op3 < 0x20 else op3
+    if op3 in ALU or (op3 < 0x20 and base in ALU):
+        name = ALU[base] + ('cc' if op3 < 0x20 and op3 & 0x10 else '')
+        if op3 in (0x25, 0x26, 0x27) and i:
+            operand = '%d' % (op & 0x1f)
+        if op3 == 0x02 and rs1 == 0:
+            return 'mov %s, %s' % (operand, REGS[rd])
+        if op3 == 0x14 and rd == 0:
+            return 'cmp %s, %s' % (REGS[rs1], operand)
+        if op3 in (0x3c, 0x3d) and rd == 0 and rs1 == 0 and not i and rs2 == 0:
+            return name
+        return '%s %s, %s, %s' % (name, REGS[rs1], operand, REGS[rd])
+    if op3 == 0x28:
+        return 'rd %s, %s' % ('%y' if rs1 == 0 else '%%asr%d' % rs1, REGS[rd])
+    if op3 in (0x29, 0x2a, 0x2b):
+        return 'rd %s, %s' % (['%psr', '%wim', '%tbr'][op3 - 0x29], REGS[rd])
+    if op3 in (0x30, 0x31, 0x32, 0x33):
+        if op3 == 0x30:
+            reg = '%y' if rd == 0 else '%%asr%d' % rd
+        else:
+            reg = ['%psr', '%wim', '%tbr'][op3 - 0x31]
+        return 'wr %s, %s, %s' % (REGS[rs1], operand, reg)
+    if op3 == 0x38:
+        addr = address(rs1, i, simm13, rs2)
+        if rd == 0 and rs1 == 31 and i and simm13 == 8:
+            return 'ret'
+        if rd == 0 and rs1 == 15 and i and simm13 == 8:
+            return 'retl'
+        return 'jmpl %s, %s' % (addr, REGS[rd])
+    if op3 == 0x39:
+        return 'rett %s' % address(rs1, i, simm13, rs2)
+    if op3 == 0x3a:
+        trap = hexs(op & 0x7f) if i else REGS[rs2]
+        if rs1 != 0:
+            trap = '%s + %s' % (REGS[rs1], trap)
+        return 't%s %s' % (ICC[rd & 0xf], trap)
+    if op3 == 0x3b:
+        return 'flush %s' % address(rs1, i, simm13, rs2)
+    if op3 in (0x34, 0x35):
+        return 'fpop%d 0x%03x' % (op3 - 0x33, (op >> 5) & 0x1ff)
+    if op3 in (0x36, 0x37):
+        return 'cpop%d 0x%03x' % (op3 - 0x35, (op >> 5) & 0x1ff)
+    return 'unknown 0x%08x' % op
+
+class Trace(object):
+    RECORD = 16
+
+    def __init__(self, filename):
+        with open(filename, 'rb') as f:
+            compressed = f.read(2) == b'\x1f\x8b'
+        self.file = gzip.open(filename, 'rb') if compressed else open(filename, 'rb')
+        header = self.file.read(32)
+        if len(header) < 32 or header[:8] != b'SRITRACE':
+            raise ValueError('%s is no instruction trace' % filename)
+        self.order = '<'
+        version, mark = struct.unpack('<II', header[8:16])
+        if mark != 0x01020304:
+            self.order = '>'
+            version, mark = struct.unpack('>II', header[8:16])
+        if version != 1:
+            raise ValueError('Unsupported instruction trace version %d' % version)
+        self.resolution, self.cycle = struct.unpack(self.order + 'dd', header[16:32])
+
+    def records(self):
+        """Yields (pc, opcode, ea, delta) tuples, delta in units of the time resolution"""
+        record = struct.Struct(self.order + 'IIII')
+        rest = b''
+        while True:
+            data = self.file.read(self.RECORD * 4096)
+            if not data:
+                break
+            data = rest + data
+            end = len(data) - len(data) % self.RECORD
+            for offset in range(0, end, self.RECORD):
+                yield record.unpack_from(data, offset)
+            rest = data[end:]
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodes a binary LEON3 instruction trace')
+    parser.add_argument('trace', help='trace file written by the cpu.traceFile parameter')
+    parser.add_argument('-n', '--count', type=int, default=0, help='stop after COUNT instructions')
+    parser.add_argument('--raw', action='store_true', help='do not disassemble the opcodes')
+    args = parser.parse_args()
+
+    trace = Trace(args.trace)
+    out = sys.stdout
+    time = 0
+    for num, (pc, op, ea, delta) in enumerate(trace.records()):
+        if args.count and num >= args.count:
+            break
+        time += delta
+        cycles = delta * trace.resolution / trace.cycle if trace.cycle else 0
+        line = '%12.1f %4d %08x %08x' % (time * trace.resolution / 1000.0, cycles, pc, op)
+        if not args.raw:
+            line += ' %-32s' % disassemble(pc, op)
+        if op >> 30 == 3:
+            line += ' [%08x]' % ea
+        out.write(line.rstrip() + '\n')
+
+if __name__ == '__main__':
+    main()
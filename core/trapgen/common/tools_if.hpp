@@ -44,6 +44,9 @@
 #include "modules/instruction.hpp"
 
 #include <cstdlib>
+#include <map>
+#include <set>
+#include <vector>
 
 namespace trap {
 
@@ -67,6 +70,59 @@ class MemoryToolsIf {
 
 /// ****************************************************************************
 
+/**
+ * @brief HookMap
+ *
+ * Page granular bitmap of the program counters at which at least one tool
+ * wants to be called. Testing an address costs one load and a bit test. Pages
+ * are reference counted so that addresses can be removed again. Addresses
+ * wider than 32 bits alias, which only results in spurious tool calls.
+ */
+template<class IssueWidth>
+class HookMap {
+  public:
+  HookMap() : bits(NUM_PAGES / 32, 0) {}
+
+  /// Marks the page holding address as interesting.
+  void add(const IssueWidth& address) {
+    unsigned page = page_of(address);
+    if (this->refs[page]++ == 0) {
+      this->bits[page >> 5] |= 1u << (page & 31);
+    }
+  }
+
+  /// Releases one reference to the page holding address.
+  void remove(const IssueWidth& address) {
+    unsigned page = page_of(address);
+    std::map<unsigned, unsigned>::iterator ref = this->refs.find(page);
+    if (ref != this->refs.end() && --ref->second == 0) {
+      this->refs.erase(ref);
+      this->bits[page >> 5] &= ~(1u << (page & 31));
+    }
+  }
+
+  /// @return True if a tool registered an address in the page of address.
+  inline bool test(const IssueWidth& address) const throw() {
+    unsigned page = page_of(address);
+    return (this->bits[page >> 5] >> (page & 31)) & 1;
+  }
+
+  private:
+  /// Matches the page size of the decoded block cache, so one test covers a
+  /// whole block.
+  static const unsigned PAGE_BITS = 12;
+  static const unsigned NUM_PAGES = 1u << (32 - PAGE_BITS);
+
+  static inline unsigned page_of(const IssueWidth& address) throw() {
+    return static_cast<unsigned>(address >> PAGE_BITS) & (NUM_PAGES - 1);
+  }
+
+  std::vector<unsigned> bits;
+  std::map<unsigned, unsigned> refs;
+}; // class HookMap
+
+/// ****************************************************************************
+
 /**
  * @brief ToolsIf
  *
@@ -75,6 +131,8 @@ class MemoryToolsIf {
 template<class IssueWidth>
 class ToolsIf {
   public:
+  ToolsIf() : hook_map(NULL) {}
+
   virtual ~ToolsIf() {}
 
   /**
@@ -94,6 +152,56 @@ class ToolsIf {
    * tool, false otherwise.
    */
   virtual bool is_pipeline_empty(const IssueWidth& cur_PC) const throw() = 0;
+
+  /**
+   * @return
+   * True if issue() has to be called for every instruction, false if it is
+   * enough to call it for the addresses registered with add_hook(). Tools
+   * overriding this to return false must register all addresses they handle.
+   */
+  virtual bool needs_every_issue() const throw() {
+    return true;
+  }
+
+  /**
+   * Called by the ToolsManager when the tool is added. Publishes the addresses
+   * registered so far into the manager's hook map.
+   */
+  void attach_hook_map(HookMap<IssueWidth>* hook_map) {
+    this->hook_map = hook_map;
+    for (typename std::set<IssueWidth>::const_iterator it = this->hooks.begin(); it != this->hooks.end(); ++it) {
+      this->hook_map->add(*it);
+    }
+  }
+
+  protected:
+  /// Requests issue() to be called when the PC reaches address.
+  void add_hook(const IssueWidth& address) {
+    if (this->hooks.insert(address).second && this->hook_map) {
+      this->hook_map->add(address);
+    }
+  }
+
+  /// Undoes add_hook().
+  void remove_hook(const IssueWidth& address) {
+    if (this->hooks.erase(address) && this->hook_map) {
+      this->hook_map->remove(address);
+    }
+  }
+
+  /// Removes all addresses registered by this tool.
+  void clear_hooks() {
+    if (this->hook_map) {
+      for (typename std::set<IssueWidth>::const_iterator it = this->hooks.begin(); it != this->hooks.end(); ++it) {
+        this->hook_map->remove(*it);
+      }
+    }
+    this->hooks.clear();
+  }
+
+  private:
+  HookMap<IssueWidth>* hook_map;
+  std::set<IssueWidth> hooks;
 }; // class ToolsIf
 
 /// ****************************************************************************
@@ -110,6 +218,8 @@ class ToolsManager {
   ToolsManager() {
     active_tools = NULL;
     num_active_tools = 0;
+    issue_tools = NULL;
+    num_issue_tools = 0;
   }
 
   /// @} Constructors and Destructors
@@ -132,6 +242,18 @@ class ToolsManager {
     }
     this->active_tools = active_tools_temp;
     this->active_tools[this->num_active_tools - 1] = &tool;
+
+    if (tool.needs_every_issue()) {
+      this->num_issue_tools++;
+      ToolsIf<IssueWidth>** issue_tools_temp = new ToolsIf<IssueWidth> *[num_issue_tools];
+      for (int i = 0; i < (this->num_issue_tools - 1); i++) {
+        issue_tools_temp[i] = this->issue_tools[i];
+      }
+      delete[] this->issue_tools;
+      this->issue_tools = issue_tools_temp;
+      this->issue_tools[this->num_issue_tools - 1] = &tool;
+    }
+    tool.attach_hook_map(&this->hook_map);
   }
 
   /**
@@ -145,8 +267,14 @@ class ToolsManager {
    */
   inline bool issue(const IssueWidth& cur_PC, const InstructionBase* cur_instr) const throw() {
     bool skip_instruction = false;
-    for (int i = 0; i < this->num_active_tools; i++) {
-      skip_instruction |= this->active_tools[i]->issue(cur_PC, cur_instr);
+    if (this->hook_map.test(cur_PC)) {
+      for (int i = 0; i < this->num_active_tools; i++) {
+        skip_instruction |= this->active_tools[i]->issue(cur_PC, cur_instr);
+      }
+    } else {
+      for (int i = 0; i < this->num_issue_tools; i++) {
+        skip_instruction |= this->issue_tools[i]->issue(cur_PC, cur_instr);
+      }
     }
     return skip_instruction;
   }
@@ -158,12 +286,27 @@ class ToolsManager {
    */
   inline bool is_pipeline_empty(const IssueWidth& cur_PC) const throw() {
     bool need_to_empty = false;
-    for (int i = 0; i < this->num_active_tools; i++) {
-      need_to_empty |= this->active_tools[i]->is_pipeline_empty(cur_PC);
+    if (this->hook_map.test(cur_PC)) {
+      for (int i = 0; i < this->num_active_tools; i++) {
+        need_to_empty |= this->active_tools[i]->is_pipeline_empty(cur_PC);
+      }
+    } else {
+      for (int i = 0; i < this->num_issue_tools; i++) {
+        need_to_empty |= this->issue_tools[i]->is_pipeline_empty(cur_PC);
+      }
     }
     return need_to_empty;
   }
 
+  /**
+   * @return
+   * True if issue() may call a tool for cur_PC. Since the hook map is page
+   * granular, false holds for the whole page of cur_PC.
+   */
+  inline bool is_hooked(const IssueWidth& cur_PC) const throw() {
+    return this->num_issue_tools != 0 || this->hook_map.test(cur_PC);
+  }
+
   /// @} Interface Methods
   /// --------------------------------------------------------------------------
   /// @name Data
@@ -174,6 +317,13 @@ class ToolsManager {
   ToolsIf<IssueWidth>** active_tools;
   int num_active_tools;
 
+  /// Subset of active_tools which has to be called at every instruction.
+  ToolsIf<IssueWidth>** issue_tools;
+  int num_issue_tools;
+
+  /// Pages holding addresses the remaining tools registered for.
+  HookMap<IssueWidth> hook_map;
+
   /// @} Data
 }; // class ToolsManager
 
@@ -206,6 +206,13 @@ class GDBStub : public ToolsIf<IssueWidth>, public MemoryToolsIf<IssueWidth>, pu
 
   /// ..........................................................................
 
+  /// Stepping and the initial connection need every instruction.
+  bool needs_every_issue() const throw() {
+    return true;
+  }
+
+  /// ..........................................................................
+
   /// Called whenever a particular address is written into memory.
 #ifndef NDEBUG
   inline void notify_address(IssueWidth address, unsigned size) throw() {
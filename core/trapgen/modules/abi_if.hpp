@@ -112,6 +112,27 @@ class ABIIf {
 
   virtual void write_char_mem(const RegWidth& address, unsigned char datum) = 0;
 
+  /**
+   * Copies len bytes of guest memory starting at address into data. The
+   * default falls back to read_char_mem(); processors should override it with
+   * a transfer that needs one memory access per page instead of per byte.
+   */
+  virtual void read_block_mem(const RegWidth& address, unsigned char* data, unsigned len) {
+    for (unsigned i = 0; i < len; i++) {
+      data[i] = this->read_char_mem(address + i);
+    }
+  }
+
+  /**
+   * Copies len bytes from data into guest memory starting at address.
+   * @see read_block_mem()
+   */
+  virtual void write_block_mem(const RegWidth& address, const unsigned char* data, unsigned len) {
+    for (unsigned i = 0; i < len; i++) {
+      this->write_char_mem(address + i, data[i]);
+    }
+  }
+
   virtual unsigned char* get_state() const throw() = 0;
 
   virtual void set_state(unsigned char* state) throw() = 0;
@@ -115,6 +115,7 @@ class OSEmulator : public ToolsIf<IssueWidth>, public OSEmulatorBase {
   void reset() {
     this->syscalls.clear();
     this->syscalls_end = this->syscalls.end();
+    this->clear_hooks();
     this->env.clear();
     this->sysconf.clear();
     this->program_args.clear();
@@ -143,6 +144,7 @@ class OSEmulator : public ToolsIf<IssueWidth>, public OSEmulatorBase {
 
       this->syscalls[address] = &callback;
       this->syscalls_end = this->syscalls.end();
+      this->add_hook(address);
 
       return true;
   } // register_syscall()
@@ -173,6 +175,7 @@ class OSEmulator : public ToolsIf<IssueWidth>, public OSEmulatorBase {
 
       this->syscalls[address] = &callback;
       this->syscalls_end = this->syscalls.end();
+      this->add_hook(address);
 
       return true;
   } // register_syscall()
@@ -596,6 +599,14 @@ class OSEmulator : public ToolsIf<IssueWidth>, public OSEmulatorBase {
     return false;
   } // is_pipeline_empty()
 
+  /// ..........................................................................
+
+  /// Every system call address is registered as a hook, so only issues in
+  /// those pages reach the map lookup.
+  bool needs_every_issue() const throw() {
+    return false;
+  } // needs_every_issue()
+
   /// @} Interface Methods
   /// --------------------------------------------------------------------------
   /// @name Internal Methods
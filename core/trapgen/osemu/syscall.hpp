@@ -56,6 +56,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 #include <systemc.h>
 #include <cstdio>
 #include <cstdlib>
@@ -408,7 +409,10 @@ class readSyscall : public Syscall<WordSize> {
       THROW_EXCEPTION("Invalid file descriptor " << fd << '.');
     }
     unsigned count = call_args[2];
-    unsigned char* buf = new unsigned char[count];
+    if (this->buffer.size() < count) {
+      this->buffer.resize(count);
+    }
+    unsigned char* buf = count? &this->buffer[0] : NULL;
   #ifdef __GNUC__
     int ret = ::read(fd, buf, count);
   #else
@@ -416,12 +420,11 @@ class readSyscall : public Syscall<WordSize> {
   #endif
     // Write the read content into memory.
     WordSize dest_addr = call_args[1];
-    for (int i = 0; i < ret; i++) {
-      this->processor->write_char_mem(dest_addr + i, buf[i]);
+    if (ret > 0) {
+      this->processor->write_block_mem(dest_addr, buf, ret);
     }
     this->processor->set_return_value(ret);
     this->processor->return_from_call();
-    delete[] buf;
     this->processor->post_call();
 
     if (this->latency.to_double() > 0) {
@@ -430,6 +433,10 @@ class readSyscall : public Syscall<WordSize> {
 
     return true;
   }
+
+  private:
+  /// Bounce buffer, kept across calls
+  std::vector<unsigned char> buffer;
 }; // class readSyscall
 
 /// ****************************************************************************
@@ -454,10 +461,11 @@ class writeSyscall : public Syscall<WordSize> {
     }
     unsigned count = call_args[2];
     WordSize dest_addr = call_args[1];
-    unsigned char* buf = new unsigned char[count];
-    for (unsigned i = 0; i < count; i++) {
-      buf[i] = this->processor->read_char_mem(dest_addr + i);
+    if (this->buffer.size() < count) {
+      this->buffer.resize(count);
     }
+    unsigned char* buf = count? &this->buffer[0] : NULL;
+    this->processor->read_block_mem(dest_addr, buf, count);
   #ifdef __GNUC__
     int ret = ::write(fd, buf, count);
   #else
@@ -465,7 +473,6 @@ class writeSyscall : public Syscall<WordSize> {
   #endif
     this->processor->set_return_value(ret);
     this->processor->return_from_call();
-    delete [] buf;
     this->processor->post_call();
 
     if (this->latency.to_double() > 0) {
@@ -474,6 +481,10 @@ class writeSyscall : public Syscall<WordSize> {
 
     return true;
   }
+
+  private:
+  /// Bounce buffer, kept across calls
+  std::vector<unsigned char> buffer;
 }; // class writeSyscall
 
 /// ****************************************************************************
@@ -176,6 +176,13 @@ class Profiler : public ToolsIf<IssueWidth> {
 
   /// ..........................................................................
 
+  /// The statistics cover every instruction.
+  bool needs_every_issue() const throw() {
+    return true;
+  } // needs_every_issue()
+
+  /// ..........................................................................
+
   void add_ignored_function(std::string& to_ignore) {
     this->ignored.insert(to_ignore);
   } // add_ignored_function()
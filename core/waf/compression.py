@@ -0,0 +1,18 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+# vim: set expandtab:ts=4:sw=4:setfiletype python
+
+def options(self):
+    """No options to define"""
+    pass
+
+def configure(self):
+    """Optional zlib, used to compress traces (defines HAVE_ZLIB)"""
+    self.check_cxx(
+        lib='z',
+        header_name='zlib.h',
+        uselib_store='ZLIB',
+        define_name='HAVE_ZLIB',
+        mandatory=False,
+        errmsg='not found, traces will not be compressed'
+    )
@@ -55,8 +55,15 @@ AHBCtrl::AHBCtrl(
   g_fpnpen("fpnpen", fpnpen, m_generics),
   g_mcheck("mcheck", mcheck, m_generics),
   g_pow_mon("pow_mon",pow_mon, m_generics),
+  g_ltdecoupled("ltdecoupled", false, m_generics),
+  g_snoopfilter("snoopfilter", false, m_generics),
+  g_idlesleep("idlesleep", true, m_generics),
   arbiter_eval_delay(1, SC_PS),
   busy(false),
+  bus_free_time(SC_ZERO_TIME),
+  m_ltdecoupled(false),
+  m_idlesleep(true),
+  m_snoopfilter(false),
   robin(0),
   address_bus_owner(-1),
   m_AcceptPEQ("AcceptPEQ"),
@@ -154,12 +161,8 @@ AHBCtrl::AHBCtrl(
     ("ambaLayer", ambaLayer)
     ("Created an AHBCtrl with this parameters");
 
-  // initialize the slave_map_cache with some bogus numbers which will trigger MISS
-  slave_info_t tmp;
-  tmp.hindex = 0;
-  tmp.hmask  = ~0;
-  tmp.binding = ~0;
-  slave_map_cache = std::pair<uint32_t, slave_info_t>(~0, tmp);
+  // No slave is mapped until start_of_simulation
+  buildDecoder();
 }
 
 AHBCtrl::AHBCtrl(
@@ -194,8 +197,15 @@ AHBCtrl::AHBCtrl(
   g_fpnpen("fpnpen", fpnpen, m_generics),
   g_mcheck("mcheck", mcheck, m_generics),
   g_pow_mon("pow_mon",pow_mon, m_generics),
+  g_ltdecoupled("ltdecoupled", false, m_generics),
+  g_snoopfilter("snoopfilter", false, m_generics),
+  g_idlesleep("idlesleep", true, m_generics),
   arbiter_eval_delay(1, SC_PS),
   busy(false),
+  bus_free_time(SC_ZERO_TIME),
+  m_ltdecoupled(false),
+  m_idlesleep(true),
+  m_snoopfilter(false),
   robin(0),
   address_bus_owner(-1),
   m_AcceptPEQ("AcceptPEQ"),
@@ -295,12 +305,8 @@ AHBCtrl::AHBCtrl(
     ("ambaLayer", ambaLayer)
     ("Created an AHBCtrl with this parameters");
 
-  // initialize the slave_map_cache with some bogus numbers which will trigger MISS
-  slave_info_t tmp;
-  tmp.hindex = 0;
-  tmp.hmask  = ~0;
-  tmp.binding = ~0;
-  slave_map_cache = std::pair<uint32_t, slave_info_t>(~0, tmp);
+  // No slave is mapped until start_of_simulation
+  buildDecoder();
 }
 
 // Reset handler
@@ -385,6 +391,22 @@ void AHBCtrl::init_generics() {
     ("name", "Power Monitoring")
     ("If true enable power monitoring");
 
+  g_ltdecoupled.add_properties()
+    ("name", "Temporal decoupled LT mode")
+    ("If true the LT bus never calls wait(). Arbitration and slave delays are annotated to the "
+     "returned delay and bus contention is modeled by reserving the bus until the end of each "
+     "transfer. Snoop broadcasts carry the annotated end time. No effect in AT mode.");
+
+  g_snoopfilter.add_properties()
+    ("name", "Snoop filtering")
+    ("If true snoops are only delivered to masters whose snoop filter can not rule out the written "
+     "address range. Masters without a snoop filter receive every snoop.");
+
+  g_idlesleep.add_properties()
+    ("name", "Idle arbiter sleep")
+    ("If true the AT arbiter stops polling while no request is pending and the bus is idle. "
+     "It resumes on the first arbitration edge after the next request. No effect in LT mode.");
+
 }
 
 // Helper function for creating slave map decoder entries
@@ -397,6 +419,27 @@ void AHBCtrl::setAddressMap(const uint32_t binding, const uint32_t hindex, const
   
   // Create slave map entry from slave ID and address range descriptor (slave_info_t)
   slave_map.insert(std::pair<uint32_t, slave_info_t>(haddr, tmp));
+
+  // Keep the flat decoder in sync with the map
+  buildDecoder();
+}
+
+// Resolve every 12 bit segment address once, so get_index is a table lookup
+void AHBCtrl::buildDecoder() {
+  for (uint32_t addr = 0; addr < 4096; addr++) {
+    slave_decoder[addr] = -1;
+
+    std::map<uint32_t, slave_info_t>::iterator it = slave_map.upper_bound(addr);
+    if (it == slave_map.begin()) {
+      continue;
+    }
+    --it;
+    if (!((addr ^ it->first) & it->second.hmask)) {
+      // There may be up to four BARs per device.
+      // Only store device ID.
+      slave_decoder[addr] = (it->second.binding) >> 2;
+    }
+  }
 }
 
 // Find slave index by address
@@ -404,31 +447,11 @@ int AHBCtrl::get_index(const uint32_t address) {
   m_total_transactions++;
 
   // Use 12 bit segment address for decoding
-  uint32_t addr = address >> 20;
-
-  // check cache, otherwise search within map
-  slave_info_t info = slave_map_cache.second;
-  if ( ! ((addr ^ slave_map_cache.first) & info.hmask) ) {
-    // There may be up to four BARs per device.
-    // Only return device ID.
-    m_right_transactions++;
-    return (info.binding) >> 2;
-  }
-
-  std::map<uint32_t, slave_info_t>::iterator it = --(slave_map.upper_bound( addr ));
-  info = it->second;
-  if ( ! ((addr ^ it->first) & info.hmask) ) {
-    // MISS in the cache: update cache
-    slave_map_cache = *it;
-  
-    // There may be up to four BARs per device.
-    // Only return device ID.
+  int index = slave_decoder[address >> 20];
+  if (index >= 0) {
     m_right_transactions++;
-    return (info.binding) >> 2;
   }
-
-  // no slave found
-  return -1;
+  return index;
 }
 
 // Returns a PNP register from the slave configuration area
@@ -517,9 +540,34 @@ void AHBCtrl::b_transport(uint32_t id,
   //}
 
   srDebug()("pointer", reinterpret_cast<size_t>(&trans))("busy", busy)("is_lock", is_lock)("id", id)("lock_master", lock_master)("delay", delay)(__PRETTY_FUNCTION__);
-  // Bus occupied or locked by other master
-  while (busy || (is_lock && (id != lock_master))) {
-    wait(clock_cycle);
+  if (m_ltdecoupled) {
+    // Bus reserved by an earlier transfer: the master waits in its local time
+    sc_time start_time = sc_time_stamp() + delay;
+    if (bus_free_time > start_time) {
+      sc_time waiting_time = bus_free_time - start_time;
+      delay += waiting_time;
+
+      // Statistic
+      if (waiting_time > m_max_wait) {
+        m_max_wait = waiting_time;
+        m_max_wait_master = id;
+      }
+      sc_time tmp = m_total_wait;
+      tmp += waiting_time;
+      m_total_wait = tmp;
+    }
+    m_arbitrated++;
+
+    // An atomic sequence (LDSTUB/SWAP) of another master has to complete first,
+    // its read may have yielded to the kernel before the write
+    while (is_lock && (id != lock_master)) {
+      wait(clock_cycle);
+    }
+  } else {
+    // Bus occupied or locked by other master
+    while (busy || (is_lock && (id != lock_master))) {
+      wait(clock_cycle);
+    }
   }
 
   busy = true;
@@ -562,8 +610,7 @@ void AHBCtrl::b_transport(uint32_t id,
       // and return
       trans.set_response_status(tlm::TLM_OK_RESPONSE);
 
-      wait(delay);
-      delay = SC_ZERO_TIME;
+      lt_end_transfer(delay);
 
       msclogger::return_backward(this, &ahbIN, &trans, tlm::TLM_COMPLETED, delay);
 
@@ -624,16 +671,15 @@ void AHBCtrl::b_transport(uint32_t id,
     // Power event end
     // PM::send(this,event_name,0,sc_time_stamp()+delay,id,g_pow_mon);
 
-    wait(delay);
-    delay = SC_ZERO_TIME;
+    lt_end_transfer(delay);
     // Broadcast master_id and address for dcache snooping
     if (trans.get_command() == tlm::TLM_WRITE_COMMAND) { // By ABBAS 
       snoopy.master_id  = id;
       snoopy.address = addr;
       snoopy.length = length;
 
-      // Send to signal socket
-      snoop.write(snoopy);
+      // Send to signal socket (delay is only non-zero in decoupled LT mode)
+      broadcast_snoop(snoopy, delay);
     }
     busy = false;
     return;
@@ -649,14 +695,24 @@ void AHBCtrl::b_transport(uint32_t id,
     // Invalid index
     trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
 
-    wait(delay);
-    delay = SC_ZERO_TIME;
+    lt_end_transfer(delay);
 
     busy = false;
     return;
   }
 }
 
+// End of an LT transfer
+void AHBCtrl::lt_end_transfer(sc_core::sc_time &delay) {  // NOLINT(runtime/references)
+  if (m_ltdecoupled) {
+    // Keep the delay annotated and block the bus for following transfers
+    bus_free_time = sc_time_stamp() + delay;
+  } else {
+    wait(delay);
+    delay = SC_ZERO_TIME;
+  }
+}
+
 // Non-blocking forward transport function for ahb_slave multi-socket
 // A master may send BEGIN_REQ or END_RESP. The model replies with
 // TLM_ACCEPTED or TLM_COMPLETED, respectively.
@@ -761,6 +817,28 @@ void AHBCtrl::print_requests() {
   v::info << name() << " ---------------------------------------------------- " << v::endl;
 }
 
+// Send a write to the snooping masters
+void AHBCtrl::broadcast_snoop(const t_snoop &snoopy, const sc_core::sc_time &delay) {
+  if (m_snoopfilter) {
+    if (m_snoop_filters.filters.size() != snoop.receivers()) {
+      // A receiver was connected after elaboration
+      resolve_snoop_filters();
+    }
+    snoop.write_filtered(snoopy, m_snoop_filters, delay);
+  } else {
+    snoop.write(snoopy, delay);
+  }
+}
+
+// Look up the module of every snoop receiver, it may implement a snoop filter
+void AHBCtrl::resolve_snoop_filters() {
+  m_snoop_filters.filters.clear();
+  for (size_t i = 0; i < snoop.receivers(); i++) {
+    sc_core::sc_object *port = dynamic_cast<sc_core::sc_object *>(snoop.receiver(i));
+    m_snoop_filters.filters.push_back(port? dynamic_cast<snoop_filter_if *>(port->get_parent_object()) : NULL);
+  }
+}
+
 // Arbitration thread (AT only)
 void AHBCtrl::arbitrate() {
   tlm::tlm_phase phase;
@@ -782,7 +860,30 @@ void AHBCtrl::arbitrate() {
   // Arbiter phase shift:
   // --------------------
   while (true) {
-    wait(clock_cycle);
+    bool pending = false;
+    for (int i = 0; i < 16; i++) {
+      if (request_map[i].state == TRANS_PENDING) {
+        pending = true;
+        break;
+      }
+    }
+
+    if (m_idlesleep && !pending && (address_bus_owner == -1) &&
+        ((data_bus_state == RESPONSE) || (data_bus_state == IDLE))) {
+      // Nothing to arbitrate and nothing to count until a master issues a
+      // request. Sleep instead of polling every cycle and continue on the
+      // first arbitration edge after the request. A request accepted in the
+      // same time step as an edge is granted on the following edge. The
+      // polling arbiter does the same, its timed wait returns before the
+      // request passes the delta notified accept PEQ.
+      sc_core::sc_time edge = sc_time_stamp();
+      wait(m_arbiter_wakeup);
+      uint64_t cycles = (sc_time_stamp() - edge).value() / clock_cycle.value();
+      edge += clock_cycle * static_cast<double>(cycles + 1);
+      wait(edge - sc_time_stamp());
+    } else {
+      wait(clock_cycle);
+    }
 
     // print_requests();
 
@@ -974,6 +1075,9 @@ void AHBCtrl::AcceptThread() {
 
         request_map[master_id->value] = connection;
         response_map[master_id->value] = connection;
+
+        // Wake the arbiter in case the bus was idle
+        m_arbiter_wakeup.notify();
       } else {
         v::error << name() << "DECODING ERROR" << v::endl;
       }
@@ -1012,7 +1116,7 @@ void AHBCtrl::RequestThread() {
         snoopy.length = trans->get_data_length();
 
         // Send to signal socket
-        snoop.write(snoopy);
+        broadcast_snoop(snoopy, SC_ZERO_TIME);
       }
 
       // We don't need the address bus anymore
@@ -1155,6 +1259,14 @@ void AHBCtrl::EndResponseThread() {
   }
 }
 
+// Caches parameters used on every transfer and the snoop filters
+void AHBCtrl::end_of_elaboration() {
+  m_ltdecoupled = g_ltdecoupled;
+  m_idlesleep = g_idlesleep;
+  m_snoopfilter = g_snoopfilter;
+  resolve_snoop_filters();
+}
+
 // Set up slave map and collect plug & play information
 void AHBCtrl::start_of_simulation() {
   // Get number of bindings at master socket (number of connected slaves)
@@ -1359,6 +1471,16 @@ void AHBCtrl::end_of_simulation() {
   v::report << name() << " * Total Transactions:      " << m_total_transactions << v::endl;
   v::report << name() << " * " << v::endl;
 
+  if (m_ambaLayer == amba::amba_LT && g_ltdecoupled && m_arbitrated) {
+    sc_time total_wait = m_total_wait;
+
+    v::report << name() << " * Maximum bus contention: " << m_max_wait << v::endl;
+    v::report << name() << " * Master with maximum contention: " << m_max_wait_master << v::endl;
+    v::report << name() << " * Average contention / transaction: " << total_wait / m_arbitrated << " (" <<
+    (total_wait / m_arbitrated) / clock_cycle << " cycles)" << v::endl;
+    v::report << name() << " * " << v::endl;
+  }
+
   if (m_ambaLayer == amba::amba_AT) {
     busy_cycles = sc_time_stamp() / clock_cycle;
     sc_time max_wait = m_max_wait;
@@ -21,6 +21,7 @@
 #include "core/common/sr_param.h"
 #include <tlm.h>
 #include <map>
+#include <vector>
 
 #include "amba/ahbdevice.h"
 #include "core/base/clkdevice.h"
@@ -91,6 +92,12 @@ class AHBCtrl : public BaseModule<DefaultBase>, public CLKDevice {
     /// Helper function - prints pending requests in arbiter
     void print_requests();
 
+    /// Sends a write to the snooping masters, filtered if snoopfilter is set
+    void broadcast_snoop(const t_snoop &snoopy, const sc_core::sc_time &delay);
+
+    /// Looks up the snoop filter of every snoop receiver
+    void resolve_snoop_filters();
+
     /// Print common transport statistics.
     void print_transport_statistics(const char *name) const;
 
@@ -190,11 +197,43 @@ class AHBCtrl : public BaseModule<DefaultBase>, public CLKDevice {
     /// Enable power monitoring (Only TLM)
     sr_param<bool> g_pow_mon;
 
+    /// Temporal decoupled LT mode: annotate bus contention instead of waiting (only LT)
+    sr_param<bool> g_ltdecoupled;
+
+    /// Deliver snoops only to masters whose snoop filter can not rule out the address
+    sr_param<bool> g_snoopfilter;
+
+    /// Let the AT arbiter sleep while no request is pending and the bus is idle
+    sr_param<bool> g_idlesleep;
+
     const sc_time arbiter_eval_delay;
 
     // Shows if bus is busy in LT mode
     bool busy;
 
+    // Time until which the bus is reserved in decoupled LT mode
+    sc_time bus_free_time;
+
+    // Copy of g_ltdecoupled, read on every LT transfer
+    bool m_ltdecoupled;
+
+    // Copy of g_idlesleep, read on every arbitration edge
+    bool m_idlesleep;
+
+    // Copy of g_snoopfilter, read on every snoop
+    bool m_snoopfilter;
+
+    /// Snoop filters of the snoop receivers, by receiver index
+    struct snoop_filters_t {
+      /// NULL for receivers without a snoop filter
+      std::vector<snoop_filter_if *> filters;
+
+      /// True if the receiver with the given index needs the snoop
+      bool operator()(size_t index, const t_snoop &snoopy) {
+        return !filters[index] || filters[index]->snoop_relevant(snoopy);
+      }
+    } m_snoop_filters;
+
     typedef tlm::tlm_generic_payload payload_t;
     typedef gs::socket::bindability_base<tlm::tlm_base_protocol_types> socket_t;
 
@@ -209,7 +248,10 @@ class AHBCtrl : public BaseModule<DefaultBase>, public CLKDevice {
 
     /// Address decoder table (slave index, (bar addr, mask))
     std::map<uint32_t, slave_info_t> slave_map;
-    std::pair<uint32_t, slave_info_t> slave_map_cache;
+
+    /// Flat decoder: slave index (or -1) for each 1 MB segment,
+    /// derived from slave_map by buildDecoder()
+    int16_t slave_decoder[4096];
 
     /// Connection state:
     //  -----------------
@@ -249,6 +291,9 @@ class AHBCtrl : public BaseModule<DefaultBase>, public CLKDevice {
     tlm_utils::peq_with_get<payload_t> m_ResponsePEQ;
     tlm_utils::peq_with_get<payload_t> m_EndResponsePEQ;
 
+    /// Wakes the arbiter when a master issues a request on the idle bus
+    sc_core::sc_event m_arbiter_wakeup;
+
     /// The number of slaves in the system
     sr_param<unsigned int> num_of_slave_bindings;
     /// The number of masters in the system
@@ -258,28 +303,28 @@ class AHBCtrl : public BaseModule<DefaultBase>, public CLKDevice {
     sr_param<sc_time> m_total_wait;
 
     /// Total number of arbitrated instructions
-    sr_param<unsigned long long> m_arbitrated;  // NOLINT(runtime/int)
+    sr_counter m_arbitrated;
 
     /// Maximum waiting time in arbiter
     sr_param<sc_time> m_max_wait;
 
     /// ID of the master with the maximum waiting time
-    sr_param<uint64_t> m_max_wait_master;  // NOLINT(runtime/int)
+    sr_counter m_max_wait_master;
 
     /// Number of idle cycles
-    sr_param<uint64_t> m_idle_count;  // NOLINT(runtime/int)
+    sr_counter m_idle_count;
 
     /// Total number of transactions handled by the instance
-    sr_param<uint64_t> m_total_transactions;  // NOLINT(runtime/int)
+    sr_counter m_total_transactions;
 
     /// Succeeded number of transaction handled by the instance
-    sr_param<uint64_t> m_right_transactions;  // NOLINT(runtime/int)
+    sr_counter m_right_transactions;
 
     /// Counts bytes written to AHBCTRL from the master side
-    sr_param<uint64_t> m_writes;  // NOLINT(runtime/int)
+    sr_counter m_writes;
 
     /// Counts bytes read from AHBCTRL from the master side
-    sr_param<uint64_t> m_reads;  // NOLINT(runtime/int)
+    sr_counter m_reads;
 
     /// ID of the master which currently 'owns' the bus
     uint32_t current_master;
@@ -330,14 +375,17 @@ class AHBCtrl : public BaseModule<DefaultBase>, public CLKDevice {
     sr_param<double> dyn_write_energy;
 
     /// Number of reads from memory (read & reset by monitor)
-    sr_param<uint64_t> dyn_reads;  // NOLINT(runtime/int)
+    sr_counter dyn_reads;
 
     /// Number of writes to memory (read & reset by monitor)
-    sr_param<uint64_t> dyn_writes;  // NOLINT(runtime/int)
+    sr_counter dyn_writes;
 
     // Private functions
     // -----------------
 
+    /// Caches parameters used on every transfer and the snoop filters
+    void end_of_elaboration();
+
     /// Set up slave map and collect plug & play information
     void start_of_simulation();
 
@@ -369,9 +417,16 @@ class AHBCtrl : public BaseModule<DefaultBase>, public CLKDevice {
     /// Get slave index for a given address
     int get_index(const uint32_t address);
 
+    /// Rebuilds the flat decoder table from slave_map
+    void buildDecoder();
+
     /// Returns a PNP register from the slave configuration area
     unsigned int getPNPReg(const uint32_t address);
 
+    /// Waits for the end of an LT transfer or, in decoupled LT mode,
+    /// reserves the bus until the annotated end of the transfer.
+    void lt_end_transfer(sc_core::sc_time &delay);  // NOLINT(runtime/references)
+
     /// Keeps track of master-payload relation
     void addPendingTransaction(
         tlm::tlm_generic_payload &trans,  // NOLINT(runtime/references)
@@ -0,0 +1,183 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup ahbctrl
+/// @{
+/// @file arbitration.cpp
+/// Runs the same AT traffic through a polling and a sleeping AHBCtrl
+/// arbiter (generic idlesleep) and requires identical traces. The traffic
+/// contains requests in the middle of a cycle, exactly on an arbitration
+/// edge, after long idle phases and from both masters at the same time.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "core/common/sr_param.h"
+#include "core/base/systemc.h"
+#include "core/sr_registry/sr_registry.h"
+#include "amba/amba.h"
+#include "amba/ahbmaster.h"
+#include "core/base/clkdevice.h"
+#include "gaisler/ahbctrl/ahbctrl.h"
+#include "gaisler/ahbmem/ahbmem.h"
+
+namespace {
+
+/// One bus access, issued at ps picoseconds simulation time or as soon as
+/// the previous access of the master is accepted
+struct Access {
+  uint64_t ps;
+  uint32_t addr;
+  bool write;
+};
+
+/// AT master working off a fixed list of accesses
+class TestMaster : public AHBMaster<>, public CLKDevice {
+  public:
+    SC_HAS_PROCESS(TestMaster);
+
+    TestMaster(ModuleName nm, unsigned int hindex, std::vector<std::string> &trace) :
+      AHBMaster<>(nm, hindex, 0x04, 0x00, 0, 0, amba::amba_AT),
+      m_trace(trace) {
+      SC_THREAD(run);
+    }
+
+    void add(uint64_t ps, uint32_t addr, bool write) {
+      Access access = { ps, addr, write };
+      m_accesses.push_back(access);
+    }
+
+    sc_core::sc_time get_clock() {
+      return clock_cycle;
+    }
+
+    void dorst() {}
+
+    void response_callback(tlm::tlm_generic_payload *trans) {
+      record("response", trans->get_address());
+    }
+
+  private:
+    void record(const char *event, uint32_t addr) {
+      std::ostringstream line;
+      line << sc_core::sc_time_stamp().value() << " " << basename() << " " << event << " 0x" << std::hex << addr;
+      m_trace.push_back(line.str());
+    }
+
+    void run() {
+      // Keeps the read buffers alive until the responses arrived
+      m_data.resize(m_accesses.size());
+      for (unsigned int i = 0; i < m_accesses.size(); i++) {
+        const Access &access = m_accesses[i];
+        sc_core::sc_time issue(static_cast<double>(access.ps), sc_core::SC_PS);
+        if (issue > sc_core::sc_time_stamp()) {
+          wait(issue - sc_core::sc_time_stamp());
+        }
+        record("request", access.addr);
+        m_data[i] = i;
+        if (access.write) {
+          ahbwrite(access.addr, reinterpret_cast<unsigned char *>(&m_data[i]), 4);
+        } else {
+          ahbread(access.addr, reinterpret_cast<unsigned char *>(&m_data[i]), 4);
+        }
+        record("accepted", access.addr);
+      }
+    }
+
+    std::vector<Access> m_accesses;
+    std::vector<uint32_t> m_data;
+    std::vector<std::string> &m_trace;
+};
+
+/// Two masters and a memory on one AT bus with a 10 ns clock
+class System : public sc_core::sc_module {
+  public:
+    System(sc_core::sc_module_name nm) :
+      sc_core::sc_module(nm),
+      ahbctrl("ahbctrl", amba::amba_AT),
+      mem("mem", amba::amba_AT, 0x000, 0xFFF, 0),
+      master0("master0", 0, trace),
+      master1("master1", 1, trace) {
+      ahbctrl.ahbOUT(mem.ahb);
+      master0.ahb(ahbctrl.ahbIN);
+      master1.ahb(ahbctrl.ahbIN);
+      ahbctrl.set_clk(10, sc_core::SC_NS);
+      mem.set_clk(10, sc_core::SC_NS);
+      master0.set_clk(10, sc_core::SC_NS);
+      master1.set_clk(10, sc_core::SC_NS);
+
+      // Arbitration edges are at 1 ps + n * 10 ns
+      master0.add(0, 0x100, true);            // First edge
+      master0.add(0, 0x104, false);           // Back to back
+      master0.add(25000, 0x200, false);       // Middle of a cycle
+      master0.add(1000001, 0x300, true);      // On an edge after 1 us idle
+      master0.add(1000001, 0x304, false);
+      master0.add(2000001, 0x400, false);     // On an edge, together with master1
+      master0.add(5003000, 0x500, true);      // Middle of a cycle after idle
+      master1.add(5000, 0x1000, false);       // While master0 owns the bus
+      master1.add(2000001, 0x2000, true);     // On an edge, together with master0
+      master1.add(3000000, 0x3000, false);    // 1 ps before an edge
+      master1.add(4000001, 0x4000, false);    // On an edge after 1 us idle
+      master1.add(4000001, 0x4004, true);
+    }
+
+    AHBCtrl ahbctrl;
+    AHBMem mem;
+    TestMaster master0;
+    TestMaster master1;
+    std::vector<std::string> trace;
+};
+
+}  // namespace
+
+int sc_main(int argc, char *argv[]) {
+  gs::ctr::GC_Core core;
+  gs::cnf::ConfigDatabase cnfdatabase("ConfigDatabase");
+  gs::cnf::ConfigPlugin configPlugin(&cnfdatabase);
+  SR_INCLUDE_MODULE(ArrayStorage);
+
+  gs::cnf::cnf_api *api = gs::cnf::GCnf_Api::getApiInstance(NULL);
+  api->setInitValue("polling.ahbctrl.generics.idlesleep", "false");
+
+  System polling("polling");
+  System sleeping("sleeping");
+  if (api->getValue("polling.ahbctrl.generics.idlesleep") != "false") {
+    std::cout << "The polling arbiter could not be configured" << std::endl;
+    return 1;
+  }
+
+  sc_core::sc_start(sc_core::sc_time(10, sc_core::SC_US));
+
+  int errors = 0;
+  unsigned int accepted = 0;
+  for (unsigned int i = 0; i < polling.trace.size(); i++) {
+    accepted += polling.trace[i].find(" accepted ") != std::string::npos;
+  }
+  if (accepted != 12) {
+    std::cout << "Only " << accepted << " of 12 accesses were accepted" << std::endl;
+    errors++;
+  }
+  // Events of both masters in the same time step have no defined order
+  std::sort(polling.trace.begin(), polling.trace.end());
+  std::sort(sleeping.trace.begin(), sleeping.trace.end());
+  for (unsigned int i = 0; i < polling.trace.size() || i < sleeping.trace.size(); i++) {
+    std::string before = (i < polling.trace.size())? polling.trace[i] : "-";
+    std::string after = (i < sleeping.trace.size())? sleeping.trace[i] : "-";
+    if (before != after) {
+      std::cout << "polling: " << before << " sleeping: " << after << std::endl;
+      errors++;
+    }
+  }
+  std::cout << "Compared " << polling.trace.size() << " trace events, " << errors << " errors" << std::endl;
+  return errors ? 1 : 0;
+}
+/// @}
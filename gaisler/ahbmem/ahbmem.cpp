@@ -193,7 +193,7 @@ void AHBMem::init_generics() {
 
   g_storage_type.add_properties()
     ("name", "Memory Storage Type")
-    ("enum", "ArrayStorage, MapStorage")
+    ("enum", "ArrayStorage, MapStorage, PagedStorage")
     ("Defines the type of memory used as a backend implementation");
 }
 
@@ -280,14 +280,20 @@ sc_core::sc_time AHBMem::get_clock() {
 }
 
 bool AHBMem::get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
-  // access to ROM adress space
+  // Storage offsets of the block, the region is reported in bus addresses
+  uint32_t start = 0;
+  uint32_t end = get_ahb_bar_size(0) - 1;
   dmi_data.allow_read_write();
-  dmi_data.set_dmi_ptr(m_storage->get_dmi_ptr());
-  dmi_data.set_start_address(0);
-  dmi_data.set_end_address(get_ahb_bar_size(0));
-  dmi_data.set_read_latency(SC_ZERO_TIME);
-  dmi_data.set_write_latency(SC_ZERO_TIME);
-  v::info << name() << "allow_dmi_rw is: " << v::uint32 << m_storage->allow_dmi_rw() << v::endl;
+  dmi_data.set_dmi_ptr(m_storage->get_dmi_block(get_ahb_bar_relative_addr(0, trans.get_address()), start, end));
+  dmi_data.set_start_address(get_ahb_bar_addr(0) + start);
+  dmi_data.set_end_address(get_ahb_bar_addr(0) + end);
+  // Latency on top of one cycle per word, the same as in exec_func
+  dmi_data.set_read_latency(clock_cycle * g_wait_states);
+  dmi_data.set_write_latency(clock_cycle * g_wait_states);
+  srDebug(name())
+    ("addr", trans.get_address())
+    ("allow_dmi_rw", m_storage->allow_dmi_rw())
+    ("DMI request");
   return m_storage->allow_dmi_rw();
 }
 
@@ -190,10 +190,10 @@ class AHBMem : public AHBSlave<>, public CLKDevice, public BaseMemory{
     sr_param<double> dyn_write_energy;
 
     /// Number of reads from memory (read & reset by monitor)
-    sr_param<uint64_t> dyn_reads;  // NOLINT(runtime/int)
+    sr_counter dyn_reads;
 
     /// Number of writes to memory (read & reset by monitor)
-    sr_param<uint64_t> dyn_writes;  // NOLINT(runtime/int)
+    sr_counter dyn_writes;
 };
 
 #endif  // MODELS_AHBMEM_AHBMEM_H_
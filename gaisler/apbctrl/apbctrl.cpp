@@ -75,12 +75,12 @@ APBCtrl::APBCtrl(
     ("ambaLayer", ambaLayer)
     ("Created an APBCtrl with this parameters");
 
-  // initialize the slave_map_cache with some bogus numbers which will trigger MISS
-  slave_info_t tmp;
-  tmp.pindex = 0;
-  tmp.pmask  = ~0;
-  tmp.binding = ~0;
-  slave_map_cache = std::pair<uint32_t, slave_info_t>(~0, tmp);
+  // No slave is mapped until start_of_simulation
+  buildDecoder();
+  for (uint32_t i = 0; i < 16; i++) {
+    mDirect[i] = NULL;
+    mDirectBase[i] = 0;
+  }
 }
 
 // Reset handler
@@ -113,33 +113,36 @@ void APBCtrl::setAddressMap(const uint32_t binding, const uint32_t pindex, const
   tmp.binding = binding;
 
   slave_map.insert(std::pair<uint32_t, slave_info_t>(paddr, tmp));
+
+  // Keep the flat decoder in sync with the map
+  buildDecoder();
 }
 
-/// Find slave index by address
-int APBCtrl::get_index(const uint32_t address) {
-  // Use 12 bit segment address for decoding
-  uint32_t addr = (address >> 8) & 0xfff;
+/// Resolve every 12 bit segment address once, so get_index is a table lookup
+void APBCtrl::buildDecoder() {
+  for (uint32_t addr = 0; addr < 4096; addr++) {
+    slave_decoder[addr] = -1;
 
-  slave_info_t info = slave_map_cache.second;
-  if ( ! ((addr ^ slave_map_cache.first) & info.pmask) ) {
-    // APB: Device == BAR)
-    m_right_transactions++;
-    return slave_map_cache.second.binding;
+    std::map<uint32_t, slave_info_t>::iterator it = slave_map.upper_bound(addr);
+    if (it == slave_map.begin()) {
+      continue;
+    }
+    --it;
+    if (!((addr ^ it->first) & it->second.pmask)) {
+      // APB: Device == BAR
+      slave_decoder[addr] = it->second.binding;
+    }
   }
+}
 
-  std::map<uint32_t, slave_info_t>::iterator it = --(slave_map.upper_bound( addr ));
-  info = it->second;
-  if ( ! ((addr ^ it->first) & info.pmask) ) {
-    // MISS in the cache: update cache
-    slave_map_cache = *it;
-    
-    // APB: Device == BAR)
+/// Find slave index by address
+int APBCtrl::get_index(const uint32_t address) {
+  // Use 12 bit segment address for decoding
+  int index = slave_decoder[(address >> 8) & 0xfff];
+  if (index >= 0) {
     m_right_transactions++;
-    return it->second.binding;
   }
-
-  // no slave found
-  return -1;
+  return index;
 }
 
 // Returns a PNP register from the APB configuration area (upper 4kb of address space)
@@ -214,8 +217,32 @@ uint32_t APBCtrl::exec_func(
     // Find slave by address / returns slave index or -1 for not mapped
     int index = get_index(addr+i);  
 
+    // Register bank slaves are accessed without a payload
+    if (index >= 0 && mDirect[index]) {
+      uint32_t apb_addr = (ahb_gp.get_address() & 0x000fffff) + i;
+      mDirect[index]->apb_access(
+          ahb_gp.is_write(),
+          apb_addr - mDirectBase[index],
+          ahb_gp.get_data_ptr() + i,
+          (length <= 4) ? length : 4);
+
+      if (!debug) {
+        // Add delay for APB setup cycle
+        delay += clock_cycle;
+
+        // Power Calculation
+        if (g_pow_mon) {
+          if (ahb_gp.get_command() == tlm::TLM_READ_COMMAND) {
+            dyn_reads += (ahb_gp.get_data_length() >> 2) + 1;
+          } else {
+            dyn_writes += (ahb_gp.get_data_length() >> 2) + 1;
+          }
+        }
+      }
+      ahb_gp.set_response_status(tlm::TLM_OK_RESPONSE);
+
     // For valid slave index
-    if(index >= 0) {
+    } else if(index >= 0) {
 
       // -- For Debug only --
       uint32_t a = 0;
@@ -349,6 +376,14 @@ void APBCtrl::start_of_simulation() {
         // insert slave region into memory map
         setAddressMap(i, sbusid, addr, mask);
       }
+
+      // Slaves built on a register bank publish a direct access interface
+      mDirect[i] = dynamic_cast<apb_register_if *>(other_socket);
+      mDirectBase[i] = slave->get_apb_base_addr();
+      srDebug()
+        ("name", obj->name())
+        ("direct", mDirect[i] != NULL)
+        ("APB slave dispatch");
     } else {
       srError()
         ("name", obj->name())
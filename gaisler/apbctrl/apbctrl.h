@@ -23,6 +23,7 @@
 #include "amba/ahbslave.h"
 #include "amba/ahbdevice.h"
 #include "amba/apbdevice.h"
+#include "amba/apbslave.h"
 #include "core/base/clkdevice.h"
 #include "core/base/vmap.h"
 
@@ -49,6 +50,9 @@ class APBCtrl : public AHBSlave<>, public CLKDevice {
     /// Get slave index for a given address
     int get_index(const uint32_t address);
 
+    /// Rebuilds the flat decoder table from slave_map
+    void buildDecoder();
+
     /// Returns a PNP register from the APB configuration area (upper 4kb of address space)
     unsigned int getPNPReg(const uint32_t address);
 
@@ -124,6 +128,12 @@ class APBCtrl : public AHBSlave<>, public CLKDevice {
     /// Array of slave device information (PNP)
     const uint32_t *mSlaves[16];
 
+    /// Direct register access of each slave binding (NULL if the slave only has b_transport)
+    apb_register_if *mDirect[16];
+
+    /// Base address of each slave binding, subtracted before direct access
+    uint32_t mDirectBase[16];
+
     typedef struct {
       uint32_t pindex;
       uint32_t pmask;
@@ -132,7 +142,10 @@ class APBCtrl : public AHBSlave<>, public CLKDevice {
 
     /// Address decoder table (slave index, (bar addr, mask))
     std::map<uint32_t, slave_info_t> slave_map;
-    std::pair<uint32_t, slave_info_t> slave_map_cache;
+
+    /// Flat decoder: slave index (or -1) for each 256 byte segment of the
+    /// APB area, derived from slave_map by buildDecoder()
+    int16_t slave_decoder[4096];
 
     // Event queue for AT mode
     tlm_utils::peq_with_get<tlm::tlm_generic_payload> m_AcceptPEQ;
@@ -166,10 +179,10 @@ class APBCtrl : public AHBSlave<>, public CLKDevice {
     // Performance Counters
 
     /// Total number of transactions
-    sr_param<uint64_t> m_total_transactions;  // NOLINT(runtime/int)
+    sr_counter m_total_transactions;
 
     /// Successful number of transactions
-    sr_param<uint64_t> m_right_transactions;  // NOLINT(runtime/int)
+    sr_counter m_right_transactions;
 
     // *****************************************************
     // Power Modeling Parameters
@@ -205,10 +218,10 @@ class APBCtrl : public AHBSlave<>, public CLKDevice {
     sr_param<double> dyn_write_energy;
 
     /// Number of reads from memory (read & reset by monitor)
-    sr_param<uint64_t> dyn_reads;  // NOLINT(runtime/int)
+    sr_counter dyn_reads;
 
     /// Number of writes to memory (read & reset by monitor)
-    sr_param<uint64_t> dyn_writes;  // NOLINT(runtime/int)
+    sr_counter dyn_writes;
 };
 
 /// @}
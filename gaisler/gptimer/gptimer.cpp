@@ -275,6 +275,52 @@ void GPTimer::dorst() {
     }
 }
 
+void GPTimer::snapshot_save(Snapshot &snapshot) {
+    scaler_read();
+    std::vector<uint32_t> values;
+    std::vector<uint8_t> flags;
+    for (std::vector<GPCounter *>::iterator iter = counter.begin(); iter != counter.end(); iter++) {
+        GPCounter *c = *iter;
+        c->value_read();
+        values.push_back(c->stopped? c->lastvalue : static_cast<uint32_t>(r[VALUE(c->nr)]));
+        flags.push_back((c->stopped << 0) | (c->chain_run << 1) | (c->m_pirq << 2));
+    }
+    snapshot.put("prescaler", static_cast<uint64_t>(r[SCALER]));
+    snapshot.put("counter_values", values);
+    snapshot.put("counter_flags", flags);
+}
+
+void GPTimer::snapshot_restore(Snapshot &snapshot) {
+    uint64_t prescaler;
+    std::vector<uint32_t> values;
+    std::vector<uint8_t> flags;
+    if (!snapshot.get("prescaler", prescaler) ||
+        !snapshot.get("counter_values", values) || values.size() != counter.size() ||
+        !snapshot.get("counter_flags", flags) || flags.size() != counter.size()) {
+        srWarn()
+          ("counters", counter.size())
+          ("No matching timer state in the snapshot, the timer is kept");
+        return;
+    }
+    sc_core::sc_time now = sc_core::sc_time_stamp();
+    lastvalue = prescaler;
+    lasttime = now;
+    for (size_t i = 0; i < counter.size(); ++i) {
+        GPCounter *c = counter[i];
+        c->e_wait.cancel();
+        c->lastvalue = values[i];
+        c->lasttime = now;
+        c->stopped = flags[i] & 1;
+        c->chain_run = flags[i] & 2;
+        c->m_pirq = flags[i] & 4;
+    }
+    for (std::vector<GPCounter *>::iterator iter = counter.begin(); iter != counter.end(); iter++) {
+        if (!(*iter)->stopped) {
+            (*iter)->calculate();
+        }
+    }
+}
+
 // Prescaler value relative to the current value.
 int64_t GPTimer::valueof(sc_core::sc_time t, int64_t offset, sc_core::sc_time cycletime) const {
     return static_cast<int64_t>(lastvalue - int64_t(sc_core::sc_time(t - lasttime - (1 + offset) * cycletime) / cycletime) + 1);
@@ -25,6 +25,7 @@
 #include "gaisler/gptimer/gpcounter.h"
 #include "amba/apbslave.h"
 #include "core/base/clkdevice.h"
+#include "core/base/snapshot.h"
 #include "core/common/sr_signal.h"
 
 #include "core/base/verbose.h"
@@ -34,7 +35,7 @@
 
 /// @brief This class is a TLM 2.0 Model of the Aeroflex Gaisler GRLIB GPTimer.
 /// Further informations to the original VHDL Modle are available in the GRLIB IP Core User's Manual Section 37
-class GPTimer : public APBSlave, public CLKDevice {
+class GPTimer : public APBSlave, public CLKDevice, public SnapshotDevice {
  public:
   SC_HAS_PROCESS(GPTimer);
   SR_HAS_SIGNALS(GPTimer);
@@ -147,6 +148,13 @@ class GPTimer : public APBSlave, public CLKDevice {
   /// @param time A possible delay. Which means the reset might be performed in the future (Not used for resets!).
   virtual void dorst();
 
+  /// Stores the prescaler and counter state. The elapsed time is folded into
+  /// the values, the register bank is saved afterwards with the current values.
+  void snapshot_save(Snapshot &snapshot);
+
+  /// Restarts prescaler and counters from the saved values at the current time.
+  void snapshot_restore(Snapshot &snapshot);
+
   // Functions
   /// The time to value function of the prescaler or the counters.
   ///
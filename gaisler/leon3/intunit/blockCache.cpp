@@ -0,0 +1,160 @@
+/***************************************************************************\
+ *
+ *
+ *         _/        _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *        _/        _/        _/    _/  _/_/    _/         _/
+ *       _/        _/_/_/    _/    _/  _/  _/  _/     _/_/
+ *      _/        _/        _/    _/  _/    _/_/         _/
+ *     _/_/_/_/  _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *
+ *
+ *
+ *
+ *   This file is part of LEON3.
+ *
+ *   LEON3 is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+\***************************************************************************/
+
+
+
+#include "gaisler/leon3/intunit/blockCache.hpp"
+#include "gaisler/leon3/intunit/instructions.hpp"
+#include <algorithm>
+
+using namespace leon3_funclt_trap;
+leon3_funclt_trap::BlockEntry::BlockEntry( Instruction * instr, unsigned int bitString, \
+    const sc_time & fetchDelay, bool flushesCode ) : instr(instr), bitString(bitString), \
+    fetchDelay(fetchDelay), flushesCode(flushesCode){
+
+}
+
+leon3_funclt_trap::DecodedBlock::DecodedBlock( uint64_t key, unsigned int startPC \
+    ) : key(key), startPC(startPC), closed(false){
+
+}
+
+leon3_funclt_trap::DecodedBlock::~DecodedBlock(){
+    std::vector<BlockEntry>::iterator entry, entryEnd;
+    for(entry = this->entries.begin(), entryEnd = this->entries.end(); entry != entryEnd; \
+        entry++){
+        delete entry->instr;
+    }
+}
+
+leon3_funclt_trap::BlockCache::BlockCache() : generation(0), hits(0), misses(0), \
+    invalidations(0), context(0), codePages((1 << (32 - PAGE_BITS)) / 32, 0){
+
+}
+
+leon3_funclt_trap::BlockCache::~BlockCache(){
+    this->flush();
+    this->reclaim();
+}
+
+DecodedBlock * leon3_funclt_trap::BlockCache::create( unsigned int pc, bool supervisor \
+    ){
+    DecodedBlock * block = new DecodedBlock(this->makeKey(pc, supervisor), pc);
+    this->blocks[block->key] = block;
+    unsigned int page = pc >> PAGE_BITS;
+    this->pageBlocks[page].push_back(block);
+    this->codePages[page >> 5] |= 1u << (page & 0x1f);
+    return block;
+}
+
+BlockEntry * leon3_funclt_trap::BlockCache::append( DecodedBlock * block, const Instruction \
+    * decoded, unsigned int bitString, const sc_time & fetchDelay ){
+    // The decoder instances are shared, every entry needs its own copy bound
+    // to the operands of this particular instruction word
+    Instruction * instr = decoded->replicate();
+    instr->setParams(bitString);
+    unsigned int id = instr->get_id();
+    // FLUSH_reg and FLUSH_imm
+    bool flushesCode = (id == 142 || id == 143);
+    block->entries.push_back(BlockEntry(instr, bitString, fetchDelay, flushesCode));
+    block->entries.back().threaded = ThreadedOp::translate(id, bitString);
+    if(flushesCode || block->entries.size() >= MAX_BLOCK_SIZE){
+        block->closed = true;
+    }
+    return &block->entries.back();
+}
+
+void leon3_funclt_trap::BlockCache::retire( DecodedBlock * block ){
+    this->blocks.erase(block->key);
+    this->retired.push_back(block);
+}
+
+void leon3_funclt_trap::BlockCache::invalidate( unsigned int address, unsigned int \
+    length ){
+    if(length == 0){
+        this->flush();
+        return;
+    }
+    unsigned int firstPage = address >> PAGE_BITS;
+    unsigned int lastPage = (address + length - 1) >> PAGE_BITS;
+    for(unsigned int page = firstPage; page <= lastPage; page++){
+        if(!((this->codePages[page >> 5] >> (page & 0x1f)) & 0x1)){
+            continue;
+        }
+        vmap<unsigned int, std::vector<DecodedBlock *> >::iterator pageIter = this->pageBlocks.find(page);
+        if(pageIter != this->pageBlocks.end()){
+            std::vector<DecodedBlock *>::iterator block, blockEnd;
+            for(block = pageIter->second.begin(), blockEnd = pageIter->second.end(); block != \
+                blockEnd; block++){
+                this->retire(*block);
+            }
+            this->pageBlocks.erase(pageIter);
+        }
+        this->codePages[page >> 5] &= ~(1u << (page & 0x1f));
+        this->invalidations++;
+        this->generation++;
+    }
+}
+
+void leon3_funclt_trap::BlockCache::flush(){
+    if(this->blocks.empty()){
+        return;
+    }
+    vmap<uint64_t, DecodedBlock *>::iterator block, blockEnd;
+    for(block = this->blocks.begin(), blockEnd = this->blocks.end(); block != blockEnd; \
+        block++){
+        this->retired.push_back(block->second);
+    }
+    this->blocks.clear();
+    this->pageBlocks.clear();
+    std::fill(this->codePages.begin(), this->codePages.end(), 0);
+    this->invalidations++;
+    this->generation++;
+}
+
+void leon3_funclt_trap::BlockCache::setContext( unsigned int context ){
+    if(context != this->context){
+        this->context = context;
+        this->generation++;
+    }
+}
+
+void leon3_funclt_trap::BlockCache::reclaim(){
+    std::vector<DecodedBlock *>::iterator block, blockEnd;
+    for(block = this->retired.begin(), blockEnd = this->retired.end(); block != blockEnd; \
+        block++){
+        delete *block;
+    }
+    this->retired.clear();
+}
@@ -0,0 +1,152 @@
+/***************************************************************************\
+ *
+ *
+ *         _/        _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *        _/        _/        _/    _/  _/_/    _/         _/
+ *       _/        _/_/_/    _/    _/  _/  _/  _/     _/_/
+ *      _/        _/        _/    _/  _/    _/_/         _/
+ *     _/_/_/_/  _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *
+ *
+ *
+ *
+ *   This file is part of LEON3.
+ *
+ *   LEON3 is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+\***************************************************************************/
+
+
+#ifndef LT_BLOCKCACHE_HPP
+#define LT_BLOCKCACHE_HPP
+
+#include "gaisler/leon3/intunit/instructions.hpp"
+#include "gaisler/leon3/intunit/threadedCode.hpp"
+#include "core/base/vmap.h"
+#include "core/base/systemc.h"
+#include <stdint.h>
+#include <vector>
+
+#define FUNC_MODEL
+#define LT_IF
+namespace leon3_funclt_trap{
+
+    /// A single pre-decoded instruction inside a DecodedBlock. The
+    /// instruction object is owned by the block and already bound to the
+    /// operands of bitString.
+    class BlockEntry{
+
+        public:
+        BlockEntry( Instruction * instr, unsigned int bitString, const sc_time & fetchDelay, \
+            bool flushesCode );
+        Instruction * instr;
+        unsigned int bitString;
+        /// Time the fetch took when the entry was recorded, charged again on replay
+        sc_time fetchDelay;
+        /// The instruction is a FLUSH, executing it drops all decoded code
+        bool flushesCode;
+        /// Threaded form of the instruction, handler is NULL if there is none
+        ThreadedOp threaded;
+    };
+
+};
+
+namespace leon3_funclt_trap{
+
+    /// Straight-line run of decoded instructions starting at startPC. A block
+    /// never crosses a page and is closed as soon as control leaves it.
+    class DecodedBlock{
+
+        public:
+        DecodedBlock( uint64_t key, unsigned int startPC );
+        ~DecodedBlock();
+        uint64_t key;
+        unsigned int startPC;
+        bool closed;
+        std::vector<BlockEntry> entries;
+    };
+
+};
+
+namespace leon3_funclt_trap{
+
+    /// Cache of decoded basic blocks keyed by (PC, MMU context, supervisor bit).
+    ///
+    /// Blocks are recorded while the processor fetches through the memory
+    /// interface and replayed afterwards without fetching or decoding again.
+    /// Invalidated blocks are only retired, they get deleted by reclaim()
+    /// once the main loop does not execute from them anymore. Every
+    /// invalidation increments generation so the main loop notices it.
+    class BlockCache{
+
+        public:
+        static const unsigned int PAGE_BITS = 12;
+        static const unsigned int MAX_BLOCK_SIZE = 1 << (PAGE_BITS - 2);
+
+        BlockCache();
+        ~BlockCache();
+        inline DecodedBlock * find( unsigned int pc, bool supervisor ) throw(){
+            vmap<uint64_t, DecodedBlock *>::iterator block = this->blocks.find(this->makeKey(pc, \
+                supervisor));
+            if(block == this->blocks.end()){
+                this->misses++;
+                return NULL;
+            }
+            this->hits++;
+            return block->second;
+        }
+        inline bool isCodePage( unsigned int address ) const throw(){
+            unsigned int page = address >> PAGE_BITS;
+            return (this->codePages[page >> 5] >> (page & 0x1f)) & 0x1;
+        }
+        inline bool empty() const throw(){
+            return this->blocks.empty();
+        }
+        inline bool samePage( unsigned int a, unsigned int b ) const throw(){
+            return (a >> PAGE_BITS) == (b >> PAGE_BITS);
+        }
+        DecodedBlock * create( unsigned int pc, bool supervisor );
+        BlockEntry * append( DecodedBlock * block, const Instruction * decoded, unsigned int \
+            bitString, const sc_time & fetchDelay );
+        void invalidate( unsigned int address, unsigned int length );
+        void flush();
+        void setContext( unsigned int context );
+        void reclaim();
+        unsigned int generation;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t invalidations;
+
+        private:
+        inline uint64_t makeKey( unsigned int pc, bool supervisor ) const throw(){
+            return ((uint64_t)this->context << 33) | ((uint64_t)supervisor << 32) | pc;
+        }
+        void retire( DecodedBlock * block );
+        unsigned int context;
+        vmap<uint64_t, DecodedBlock *> blocks;
+        vmap<unsigned int, std::vector<DecodedBlock *> > pageBlocks;
+        std::vector<uint32_t> codePages;
+        std::vector<DecodedBlock *> retired;
+    };
+
+};
+
+
+
+#endif
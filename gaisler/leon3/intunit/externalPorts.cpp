@@ -58,14 +58,10 @@ sc_dt::uint64 leon3_funclt_trap::TLMMemory::read_dword( const unsigned int & add
 							const unsigned int lock) throw(){
 
     sc_dt::uint64 datum = 0;
-    if (this->dmi_ptr_valid){
-        if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-            SC_REPORT_ERROR("TLM-2", "Error in reading memory data through DMI: address out of \
-                bounds");
-        }
-        memcpy(&datum, this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() \
-            + address, sizeof(datum));
-        this->quantKeeper.inc(this->dmi_data.get_read_latency());
+    tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), false);
+    if(dmi != NULL){
+        memcpy(&datum, dmi->get_dmi_ptr() + (address - dmi->get_start_address()), sizeof(datum));
+        this->quantKeeper.inc(dmi->get_read_latency());
         if(this->quantKeeper.need_sync()){
             this->quantKeeper.sync();
         }
@@ -74,25 +70,8 @@ sc_dt::uint64 leon3_funclt_trap::TLMMemory::read_dword( const unsigned int & add
         sc_time delay = this->quantKeeper.get_local_time();
         unsigned int debug = 0;
  
-        dcio_payload_extension *dcioExt = new dcio_payload_extension();
-        tlm::tlm_generic_payload trans;
-
-        // Create & init data payload extension
-        dcioExt->asi   = asi;
-        dcioExt->flush = flush;
-        dcioExt->lock  = lock;
-        dcioExt->debug = &debug;
-
-        trans.set_address(address);
-        trans.set_read();
-        trans.set_data_ptr(reinterpret_cast<unsigned char*>(&datum));
-        trans.set_data_length(sizeof(datum));
-        trans.set_byte_enable_ptr(0);
-        trans.set_dmi_allowed(false);
-        trans.set_response_status( tlm::TLM_INCOMPLETE_RESPONSE );
-
-        // Hook extension onto payload
-        trans.set_extension(dcioExt);
+        tlm::tlm_generic_payload & trans = this->prepare_data(tlm::TLM_READ_COMMAND, address, \
+            reinterpret_cast<unsigned char *>(&datum), sizeof(datum), asi, flush, lock, &debug);
 
         this->initSocket->b_transport(trans, delay);
 
@@ -101,8 +80,7 @@ sc_dt::uint64 leon3_funclt_trap::TLMMemory::read_dword( const unsigned int & add
             SC_REPORT_ERROR("TLM-2", errorStr.c_str());
         }
         if(trans.is_dmi_allowed()){
-            this->dmi_data.init();
-            this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+            this->dmi_request(trans);
         }
 
         //Now lets keep track of time
@@ -111,8 +89,6 @@ sc_dt::uint64 leon3_funclt_trap::TLMMemory::read_dword( const unsigned int & add
           //std::cout << "Quantum (external) sync" << std::endl;
             this->quantKeeper.sync();
         }
-
-        trans.free_all_extensions();
     }
     #ifdef LITTLE_ENDIAN_BO
     unsigned int datum1 = (unsigned int)(datum);
@@ -132,14 +108,10 @@ unsigned short int leon3_funclt_trap::TLMMemory::read_half( const unsigned int &
 							    const unsigned int lock) throw(){
 
     unsigned short int datum = 0;
-    if (this->dmi_ptr_valid){
-        if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-            SC_REPORT_ERROR("TLM-2", "Error in reading memory data through DMI: address out of \
-                bounds");
-        }
-        memcpy(&datum, this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() \
-            + address, sizeof(datum));
-        this->quantKeeper.inc(this->dmi_data.get_read_latency());
+    tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), false);
+    if(dmi != NULL){
+        memcpy(&datum, dmi->get_dmi_ptr() + (address - dmi->get_start_address()), sizeof(datum));
+        this->quantKeeper.inc(dmi->get_read_latency());
         if(this->quantKeeper.need_sync()){
             this->quantKeeper.sync();
         }
@@ -148,26 +120,8 @@ unsigned short int leon3_funclt_trap::TLMMemory::read_half( const unsigned int &
         sc_time delay = this->quantKeeper.get_local_time();
         unsigned int debug = 0;
         
-        dcio_payload_extension *dcioExt = new dcio_payload_extension();
-        tlm::tlm_generic_payload trans;
-
-        // Create & init data payload extension
-        dcioExt->asi   = asi;
-        dcioExt->flush = flush;
-        dcioExt->lock  = lock;
-        dcioExt->debug = &debug;
-
-        trans.set_address(address);
-        trans.set_read();
-        trans.set_data_ptr(reinterpret_cast<unsigned char*>(&datum));
-        trans.set_data_length(sizeof(datum));
-        trans.set_streaming_width(sizeof(datum));
-        trans.set_byte_enable_ptr(0);
-        trans.set_dmi_allowed(false);
-        trans.set_response_status( tlm::TLM_INCOMPLETE_RESPONSE );
-
-        // Hook extension onto payload
-        trans.set_extension(dcioExt);
+        tlm::tlm_generic_payload & trans = this->prepare_data(tlm::TLM_READ_COMMAND, address, \
+            reinterpret_cast<unsigned char *>(&datum), sizeof(datum), asi, flush, lock, &debug);
 
         this->initSocket->b_transport(trans, delay);
 
@@ -176,8 +130,7 @@ unsigned short int leon3_funclt_trap::TLMMemory::read_half( const unsigned int &
             SC_REPORT_ERROR("TLM-2", errorStr.c_str());
         }
         if(trans.is_dmi_allowed()){
-            this->dmi_data.init();
-            this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+            this->dmi_request(trans);
         }
 
         //Now lets keep track of time
@@ -187,8 +140,6 @@ unsigned short int leon3_funclt_trap::TLMMemory::read_half( const unsigned int &
             this->quantKeeper.sync();
         }
 
-        trans.free_all_extensions();
-
     }
     //Now the code for endianess conversion: the processor is always modeled
     //with the host endianess; in case they are different, the endianess
@@ -207,14 +158,10 @@ unsigned char leon3_funclt_trap::TLMMemory::read_byte( const unsigned int & addr
 						       const unsigned int lock) throw(){
 
     unsigned char datum = 0;
-    if (this->dmi_ptr_valid){
-        if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-            SC_REPORT_ERROR("TLM-2", "Error in reading memory data through DMI: address out of \
-                bounds");
-        }
-        memcpy(&datum, this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() \
-            + address, sizeof(datum));
-        this->quantKeeper.inc(this->dmi_data.get_read_latency());
+    tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), false);
+    if(dmi != NULL){
+        memcpy(&datum, dmi->get_dmi_ptr() + (address - dmi->get_start_address()), sizeof(datum));
+        this->quantKeeper.inc(dmi->get_read_latency());
         if(this->quantKeeper.need_sync()){
             this->quantKeeper.sync();
         }
@@ -223,26 +170,8 @@ unsigned char leon3_funclt_trap::TLMMemory::read_byte( const unsigned int & addr
         sc_time delay = this->quantKeeper.get_local_time();
         unsigned int debug = 0;
 
-        dcio_payload_extension *dcioExt = new dcio_payload_extension();
-        tlm::tlm_generic_payload trans;
-
-        // Create & init data payload extension
-        dcioExt->asi    = asi;
-        dcioExt->flush  = flush;
-        dcioExt->lock   = lock;
-        dcioExt->debug  = &debug;
-
-        trans.set_address(address);
-        trans.set_read();
-        trans.set_data_ptr(reinterpret_cast<unsigned char*>(&datum));
-        trans.set_data_length(sizeof(datum));
-        trans.set_streaming_width(sizeof(datum));
-        trans.set_byte_enable_ptr(0);
-        trans.set_dmi_allowed(false);
-        trans.set_response_status( tlm::TLM_INCOMPLETE_RESPONSE );
-        
-        // Hook extension onto payload
-        trans.set_extension(dcioExt);
+        tlm::tlm_generic_payload & trans = this->prepare_data(tlm::TLM_READ_COMMAND, address, \
+            reinterpret_cast<unsigned char *>(&datum), sizeof(datum), asi, flush, lock, &debug);
 
         this->initSocket->b_transport(trans, delay);
 
@@ -251,8 +180,7 @@ unsigned char leon3_funclt_trap::TLMMemory::read_byte( const unsigned int & addr
             SC_REPORT_ERROR("TLM-2", errorStr.c_str());
         }
         if(trans.is_dmi_allowed()){
-            this->dmi_data.init();
-            this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+            this->dmi_request(trans);
         }
 
         // Now lets keep track of time
@@ -261,8 +189,6 @@ unsigned char leon3_funclt_trap::TLMMemory::read_byte( const unsigned int & addr
 	  //std::cout << "Quantum (external) sync" << std::endl;
             this->quantKeeper.sync();
         }
-
-        trans.free_all_extensions();
     }
 
     return datum;
@@ -285,14 +211,10 @@ void leon3_funclt_trap::TLMMemory::write_dword( const unsigned int & address,
     if(this->debugger != NULL){
         this->debugger->notifyAddress(address, sizeof(datum));
     }
-    if(this->dmi_ptr_valid){
-        if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-            SC_REPORT_ERROR("TLM-2", "Error in writing memory data through DMI: address out of \
-                bounds");
-        }
-        memcpy(this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() + address, \
-            &datum, sizeof(datum));
-        this->quantKeeper.inc(this->dmi_data.get_write_latency());
+    tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), true);
+    if(dmi != NULL){
+        memcpy(dmi->get_dmi_ptr() + (address - dmi->get_start_address()), &datum, sizeof(datum));
+        this->quantKeeper.inc(dmi->get_write_latency());
         if(this->quantKeeper.need_sync()){
             this->quantKeeper.sync();
         }
@@ -300,26 +222,8 @@ void leon3_funclt_trap::TLMMemory::write_dword( const unsigned int & address,
         sc_time delay = this->quantKeeper.get_local_time();
         unsigned int debug = 0;
         
-        dcio_payload_extension *dcioExt = new dcio_payload_extension();
-        tlm::tlm_generic_payload trans;
-
-        // Create & init data payload extension
-        dcioExt->asi    = asi;
-        dcioExt->flush  = flush;
-        dcioExt->lock   = lock;
-        dcioExt->debug  = &debug;
-
-        trans.set_address(address);
-        trans.set_write();
-        trans.set_data_ptr((unsigned char*)&datum);
-        trans.set_data_length(sizeof(datum));
-        trans.set_streaming_width(sizeof(datum));
-        trans.set_byte_enable_ptr(0);
-        trans.set_dmi_allowed(false);
-        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
-        
-        // Hook extension onto payload
-        trans.set_extension(dcioExt);	
+        tlm::tlm_generic_payload & trans = this->prepare_data(tlm::TLM_WRITE_COMMAND, address, \
+            reinterpret_cast<unsigned char *>(&datum), sizeof(datum), asi, flush, lock, &debug);
 
         this->initSocket->b_transport(trans, delay);
 
@@ -328,8 +232,7 @@ void leon3_funclt_trap::TLMMemory::write_dword( const unsigned int & address,
             SC_REPORT_ERROR("TLM-2", errorStr.c_str());
         }
         if(trans.is_dmi_allowed()){
-            this->dmi_data.init();
-            this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+            this->dmi_request(trans);
         }
 
         //Now lets keep track of time
@@ -338,8 +241,6 @@ void leon3_funclt_trap::TLMMemory::write_dword( const unsigned int & address,
 	  //std::cout << "Quantum (external) sync" << std::endl;
             this->quantKeeper.sync();
         }
-
-        trans.free_all_extensions();
     }
 }
 
@@ -362,14 +263,10 @@ void leon3_funclt_trap::TLMMemory::write_half( const unsigned int & address,
     if(this->debugger != NULL){
         this->debugger->notifyAddress(address, sizeof(datum));
     }
-    if(this->dmi_ptr_valid){
-        if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-            SC_REPORT_ERROR("TLM-2", "Error in writing memory data through DMI: address out of \
-                bounds");
-        }
-        memcpy(this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() + address, \
-            &datum, sizeof(datum));
-        this->quantKeeper.inc(this->dmi_data.get_write_latency());
+    tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), true);
+    if(dmi != NULL){
+        memcpy(dmi->get_dmi_ptr() + (address - dmi->get_start_address()), &datum, sizeof(datum));
+        this->quantKeeper.inc(dmi->get_write_latency());
         if(this->quantKeeper.need_sync()){
             this->quantKeeper.sync();
         }
@@ -377,26 +274,8 @@ void leon3_funclt_trap::TLMMemory::write_half( const unsigned int & address,
         sc_time delay = this->quantKeeper.get_local_time();
         unsigned int debug = 0;
         
-        dcio_payload_extension *dcioExt = new dcio_payload_extension();
-        tlm::tlm_generic_payload trans;
-		
-        // Create & init data payload extension
-        dcioExt->asi    = asi;
-        dcioExt->flush  = flush;
-        dcioExt->lock   = lock;
-        dcioExt->debug = &debug;
-
-        trans.set_address(address);
-        trans.set_write();
-        trans.set_data_ptr((unsigned char*)&datum);
-        trans.set_data_length(sizeof(datum));
-        trans.set_streaming_width(sizeof(datum));
-        trans.set_byte_enable_ptr(0);
-        trans.set_dmi_allowed(false);
-        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
-
-        // Hook extension onto payload
-        trans.set_extension(dcioExt);
+        tlm::tlm_generic_payload & trans = this->prepare_data(tlm::TLM_WRITE_COMMAND, address, \
+            reinterpret_cast<unsigned char *>(&datum), sizeof(datum), asi, flush, lock, &debug);
 
         this->initSocket->b_transport(trans, delay);
 
@@ -405,8 +284,7 @@ void leon3_funclt_trap::TLMMemory::write_half( const unsigned int & address,
             SC_REPORT_ERROR("TLM-2", errorStr.c_str());
         }
         if(trans.is_dmi_allowed()){
-            this->dmi_data.init();
-            this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+            this->dmi_request(trans);
         }
 
         // Now lets keep track of time
@@ -416,8 +294,6 @@ void leon3_funclt_trap::TLMMemory::write_half( const unsigned int & address,
             this->quantKeeper.sync();
         }
 
-        trans.free_all_extensions();
-
     }
 }
 
@@ -434,14 +310,10 @@ void leon3_funclt_trap::TLMMemory::write_byte( const unsigned int & address,
     if(this->debugger != NULL){
         this->debugger->notifyAddress(address, sizeof(datum));
     }
-    if(this->dmi_ptr_valid){
-        if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-            SC_REPORT_ERROR("TLM-2", "Error in writing memory data through DMI: address out of \
-                bounds");
-        }
-        memcpy(this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() + address, \
-            &datum, sizeof(datum));
-        this->quantKeeper.inc(this->dmi_data.get_write_latency());
+    tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), true);
+    if(dmi != NULL){
+        memcpy(dmi->get_dmi_ptr() + (address - dmi->get_start_address()), &datum, sizeof(datum));
+        this->quantKeeper.inc(dmi->get_write_latency());
         if(this->quantKeeper.need_sync()){
             this->quantKeeper.sync();
         }
@@ -449,26 +321,8 @@ void leon3_funclt_trap::TLMMemory::write_byte( const unsigned int & address,
         sc_time delay = this->quantKeeper.get_local_time();
         unsigned int debug = 0;
 
-        dcio_payload_extension *dcioExt = new dcio_payload_extension();
-        tlm::tlm_generic_payload trans;
-
-        // Create & init data payload extension
-        dcioExt->asi    = asi;
-        dcioExt->flush  = flush;
-        dcioExt->lock   = lock;
-        dcioExt->debug  = &debug;	
-
-        trans.set_address(address);
-        trans.set_write();
-        trans.set_data_ptr((unsigned char*)&datum);
-        trans.set_data_length(sizeof(datum));
-        trans.set_streaming_width(sizeof(datum));
-        trans.set_byte_enable_ptr(0);
-        trans.set_dmi_allowed(false);
-        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
- 
-        // Hook extension onto payload
-        trans.set_extension(dcioExt);	
+        tlm::tlm_generic_payload & trans = this->prepare_data(tlm::TLM_WRITE_COMMAND, address, \
+            reinterpret_cast<unsigned char *>(&datum), sizeof(datum), asi, flush, lock, &debug);
 
         this->initSocket->b_transport(trans, delay);
 
@@ -477,8 +331,7 @@ void leon3_funclt_trap::TLMMemory::write_byte( const unsigned int & address,
             SC_REPORT_ERROR("TLM-2", errorStr.c_str());
         }
         if(trans.is_dmi_allowed()){
-            this->dmi_data.init();
-            this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+            this->dmi_request(trans);
         }
 
         wait(delay);
@@ -489,8 +342,6 @@ void leon3_funclt_trap::TLMMemory::write_byte( const unsigned int & address,
 	  //std::cout << "Quantum (external) sync" << std::endl;
             this->quantKeeper.sync();
         }
-
-        trans.free_all_extensions();
     }
 }
 
@@ -498,24 +349,9 @@ sc_dt::uint64 leon3_funclt_trap::TLMMemory::read_dword_dbg( const unsigned int &
     address ) throw(){
 
     unsigned int debug = 0;
-    dcio_payload_extension *dcioExt = new dcio_payload_extension();
-    tlm::tlm_generic_payload trans;
-    
-    trans.set_address(address);
-    trans.set_read();
-    trans.set_data_length(8);
-    trans.set_streaming_width(8);
     sc_dt::uint64 datum = 0;
-    trans.set_data_ptr(reinterpret_cast<unsigned char *>(&datum));
-    
-    // Create & init data payload extension
-    dcioExt->asi   = 8;
-    dcioExt->flush = 0;
-    dcioExt->lock  = 0;
-    dcioExt->debug = &debug;
-
-    // Hook extension onto payload
-    trans.set_extension(dcioExt);
+    tlm::tlm_generic_payload & trans = this->prepare_dbg(tlm::TLM_READ_COMMAND, address, \
+        reinterpret_cast<unsigned char *>(&datum), sizeof(datum), &debug);
 
     this->initSocket->transport_dbg(trans);
     #ifdef LITTLE_ENDIAN_BO
@@ -526,8 +362,6 @@ sc_dt::uint64 leon3_funclt_trap::TLMMemory::read_dword_dbg( const unsigned int &
     datum = datum1 | (((sc_dt::uint64)datum2) << 32);
     #endif
     
-    trans.free_all_extensions();
-
     return datum;
 }
 
@@ -535,23 +369,8 @@ unsigned int leon3_funclt_trap::TLMMemory::read_word_dbg( const unsigned int & a
     ) throw(){
     unsigned int debug = 0;
     unsigned int datum = 0;
-    dcio_payload_extension *dcioExt = new dcio_payload_extension();
-    tlm::tlm_generic_payload trans;
-
-    trans.set_address(address);
-    trans.set_read();
-    trans.set_data_length(4);
-    trans.set_streaming_width(4);
-    trans.set_data_ptr(reinterpret_cast<unsigned char *>(&datum));
-
-    // Create & init data payload extension
-    dcioExt->asi   = 8;
-    dcioExt->flush = 0;
-    dcioExt->lock  = 0;
-    dcioExt->debug = &debug;
-
-    // Hook extension onto payload
-    trans.set_extension(dcioExt);
+    tlm::tlm_generic_payload & trans = this->prepare_dbg(tlm::TLM_READ_COMMAND, address, \
+        reinterpret_cast<unsigned char *>(&datum), sizeof(datum), &debug);
 
     this->initSocket->transport_dbg(trans);
     //Now the code for endianess conversion: the processor is always modeled
@@ -561,8 +380,6 @@ unsigned int leon3_funclt_trap::TLMMemory::read_word_dbg( const unsigned int & a
     this->swapEndianess(datum);
     #endif
 
-    trans.free_all_extensions();
-
     return datum;
 }
 
@@ -570,23 +387,8 @@ unsigned short int leon3_funclt_trap::TLMMemory::read_half_dbg( const unsigned i
     & address ) throw(){
     unsigned int debug = 0;
     unsigned short int datum = 0;
-    dcio_payload_extension *dcioExt = new dcio_payload_extension();
-    tlm::tlm_generic_payload trans;
-
-    trans.set_address(address);
-    trans.set_read();
-    trans.set_data_length(2);
-    trans.set_streaming_width(2);
-    trans.set_data_ptr(reinterpret_cast<unsigned char *>(&datum));
-
-    // Create & init data payload extension
-    dcioExt->asi   = 8;
-    dcioExt->flush = 0;
-    dcioExt->lock  = 0;
-    dcioExt->debug = &debug;
-
-    // Hook extension onto payload
-    trans.set_extension(dcioExt);
+    tlm::tlm_generic_payload & trans = this->prepare_dbg(tlm::TLM_READ_COMMAND, address, \
+        reinterpret_cast<unsigned char *>(&datum), sizeof(datum), &debug);
 
     this->initSocket->transport_dbg(trans);
     //Now the code for endianess conversion: the processor is always modeled
@@ -602,28 +404,11 @@ unsigned char leon3_funclt_trap::TLMMemory::read_byte_dbg( const unsigned int &
     ) throw(){
     unsigned int debug = 0;
     unsigned char datum = 0;
-    dcio_payload_extension *dcioExt = new dcio_payload_extension();
-    tlm::tlm_generic_payload trans;
-
-    trans.set_address(address);
-    trans.set_read();
-    trans.set_data_length(1);
-    trans.set_streaming_width(1);
-    trans.set_data_ptr(reinterpret_cast<unsigned char *>(&datum));
-
-    // Create & init data payload extension
-    dcioExt->asi   = 8;
-    dcioExt->flush = 0;
-    dcioExt->lock  = 0;
-    dcioExt->debug = &debug;
-
-    // Hook extension onto payload
-    trans.set_extension(dcioExt);
+    tlm::tlm_generic_payload & trans = this->prepare_dbg(tlm::TLM_READ_COMMAND, address, \
+        reinterpret_cast<unsigned char *>(&datum), sizeof(datum), &debug);
 
     this->initSocket->transport_dbg(trans);
 
-    trans.free_all_extensions();
-
     return datum;
 }
 
@@ -638,26 +423,11 @@ void leon3_funclt_trap::TLMMemory::write_dword_dbg( const unsigned int & address
     #endif
 
     unsigned int debug = 0;
-    dcio_payload_extension *dcioExt = new dcio_payload_extension();
-    tlm::tlm_generic_payload trans;
-    trans.set_address(address);
-    trans.set_write();
-    trans.set_data_length(8);
-    trans.set_streaming_width(8);
-    trans.set_data_ptr((unsigned char *)&datum);
-
-    // Create & init data payload extension
-    dcioExt->asi   = 8;
-    dcioExt->flush = 0;
-    dcioExt->lock  = 0;
-    dcioExt->debug = &debug;
-
-    // Hook extension onto payload
-    trans.set_extension(dcioExt);
+    tlm::tlm_generic_payload & trans = this->prepare_dbg(tlm::TLM_WRITE_COMMAND, address, \
+        reinterpret_cast<unsigned char *>(&datum), sizeof(datum), &debug);
 
     this->initSocket->transport_dbg(trans);
 
-    trans.free_all_extensions();
 }
 
 void leon3_funclt_trap::TLMMemory::write_word_dbg( const unsigned int & address, \
@@ -669,27 +439,11 @@ void leon3_funclt_trap::TLMMemory::write_word_dbg( const unsigned int & address,
     this->swapEndianess(datum);
     #endif
     unsigned int debug = 0;
-    dcio_payload_extension *dcioExt = new dcio_payload_extension();
-    tlm::tlm_generic_payload trans;
-
-    trans.set_address(address);
-    trans.set_write();
-    trans.set_data_length(4);
-    trans.set_streaming_width(4);
-    trans.set_data_ptr((unsigned char *)&datum);
-
-    // Create & init data payload extension
-    dcioExt->asi   = 8;
-    dcioExt->flush = 0;
-    dcioExt->lock  = 0;
-    dcioExt->debug = &debug;
-
-    // Hook extension onto payload
-    trans.set_extension(dcioExt);
+    tlm::tlm_generic_payload & trans = this->prepare_dbg(tlm::TLM_WRITE_COMMAND, address, \
+        reinterpret_cast<unsigned char *>(&datum), sizeof(datum), &debug);
 
     this->initSocket->transport_dbg(trans);
 
-    trans.free_all_extensions();
 }
 
 void leon3_funclt_trap::TLMMemory::write_half_dbg( const unsigned int & address, \
@@ -704,26 +458,11 @@ void leon3_funclt_trap::TLMMemory::write_half_dbg( const unsigned int & address,
     #else
     #endif
     unsigned int debug = 0;
-    dcio_payload_extension *dcioExt = new dcio_payload_extension();
-    tlm::tlm_generic_payload trans;
-    trans.set_address(address);
-    trans.set_write();
-    trans.set_data_length(2);
-    trans.set_streaming_width(2);
-    trans.set_data_ptr((unsigned char *)&datum);
-
-    // Create & init data payload extension
-    dcioExt->asi   = 8;
-    dcioExt->flush = 0;
-    dcioExt->lock  = 0;
-    dcioExt->debug = &debug;
-
-    // Hook extension onto payload
-    trans.set_extension(dcioExt);
+    tlm::tlm_generic_payload & trans = this->prepare_dbg(tlm::TLM_WRITE_COMMAND, address, \
+        reinterpret_cast<unsigned char *>(&datum), sizeof(datum), &debug);
 
     this->initSocket->transport_dbg(trans);
 
-    trans.free_all_extensions();
 }
 
 void leon3_funclt_trap::TLMMemory::write_byte_dbg( const unsigned int & address, \
@@ -732,27 +471,55 @@ void leon3_funclt_trap::TLMMemory::write_byte_dbg( const unsigned int & address,
     #else
     #endif
     unsigned int debug = 0;
-    dcio_payload_extension *dcioExt = new dcio_payload_extension();
-    tlm::tlm_generic_payload trans;
-
-    trans.set_address(address);
-    trans.set_write();
-    trans.set_data_length(1);
-    trans.set_streaming_width(1);
-    trans.set_data_ptr((unsigned char *)&datum);
+    tlm::tlm_generic_payload & trans = this->prepare_dbg(tlm::TLM_WRITE_COMMAND, address, \
+        reinterpret_cast<unsigned char *>(&datum), sizeof(datum), &debug);
 
-    // Create & init data payload extension
-    dcioExt->asi   = 8;
-    dcioExt->flush = 0;
-    dcioExt->lock  = 0;
-    dcioExt->debug = &debug;
+    this->initSocket->transport_dbg(trans);
 
-    // Hook extension onto payload
-    trans.set_extension(dcioExt);
+}
 
-    this->initSocket->transport_dbg(trans);
+void leon3_funclt_trap::TLMMemory::dmi_request( tlm::tlm_generic_payload & trans ){
+    // Only a region which already grants the needed access makes the
+    // request redundant, a read-only region must not block write grants
+    bool write = trans.is_write();
+    std::vector<tlm::tlm_dmi>::iterator region;
+    for(region = this->dmi_regions.begin(); region != this->dmi_regions.end(); region++){
+        if(trans.get_address() >= region->get_start_address() && trans.get_address() <= \
+            region->get_end_address()){
+            if(write? region->is_write_allowed() : region->is_read_allowed()){
+                return;
+            }
+            break;
+        }
+    }
+    tlm::tlm_dmi dmi;
+    if(!this->initSocket->get_direct_mem_ptr(trans, dmi)){
+        return;
+    }
+    // The new grant supersedes every region it overlaps
+    this->invalidate_direct_mem_ptr(dmi.get_start_address(), dmi.get_end_address());
+    for(region = this->dmi_regions.begin(); region != this->dmi_regions.end(); region++){
+        if(region->get_start_address() > dmi.get_start_address()){
+            break;
+        }
+    }
+    this->dmi_last = region - this->dmi_regions.begin();
+    this->dmi_regions.insert(region, dmi);
+    v::debug << name() << "DMI region 0x" << hex << dmi.get_start_address() << " - 0x" \
+             << dmi.get_end_address() << " granted" << endl;
+}
 
-    trans.free_all_extensions();
+void leon3_funclt_trap::TLMMemory::invalidate_direct_mem_ptr( sc_dt::uint64 start_range, \
+    sc_dt::uint64 end_range ){
+    std::vector<tlm::tlm_dmi>::iterator region = this->dmi_regions.begin();
+    while(region != this->dmi_regions.end()){
+        if(region->get_start_address() <= end_range && region->get_end_address() >= start_range){
+            region = this->dmi_regions.erase(region);
+        } else {
+            region++;
+        }
+    }
+    this->dmi_last = 0;
 }
 
 void leon3_funclt_trap::TLMMemory::lock(){
@@ -766,7 +533,15 @@ void leon3_funclt_trap::TLMMemory::unlock(){
 leon3_funclt_trap::TLMMemory::TLMMemory( sc_module_name portName, tlm_utils::tlm_quantumkeeper \
     & quantKeeper ) : sc_module(portName), quantKeeper(quantKeeper){
     this->debugger = NULL;
-    this->dmi_ptr_valid = false;
+    this->dmi_last = 0;
+    // The payloads delete their extensions when they get destroyed
+    this->icio_ext = new icio_payload_extension();
+    this->instr_trans.set_extension(this->icio_ext);
+    this->dcio_ext = new dcio_payload_extension();
+    this->data_trans.set_extension(this->dcio_ext);
+    this->dbg_ext = new dcio_payload_extension();
+    this->dbg_trans.set_extension(this->dbg_ext);
+    this->initSocket.register_invalidate_direct_mem_ptr(this, &TLMMemory::invalidate_direct_mem_ptr);
     end_module();
 }
 
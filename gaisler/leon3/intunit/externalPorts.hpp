@@ -47,17 +47,118 @@
 #include "gaisler/leon3/mmucache/icio_payload_extension.h"
 #include "gaisler/leon3/mmucache/dcio_payload_extension.h"
 #include "core/base/verbose.h"
+#include <vector>
 
 #define FUNC_MODEL
 #define LT_IF
 namespace leon3_funclt_trap{
 
+    /// TLM memory interface of the generated standalone processor. This is
+    /// dead code: intunit/wscript does not build externalPorts.cpp, the
+    /// platforms connect the processor through Leon3 and mmu_cache instead.
     class TLMMemory : public MemoryInterface, public sc_module{
         private:
         MemoryToolsIf< unsigned int > * debugger;
         tlm_utils::tlm_quantumkeeper & quantKeeper;
-        bool dmi_ptr_valid;
-        tlm::tlm_dmi dmi_data;
+        /// DMI regions granted so far, sorted by start address and never
+        /// overlapping each other
+        std::vector<tlm::tlm_dmi> dmi_regions;
+        /// Index of the region which served the last DMI access
+        unsigned int dmi_last;
+        /// Payloads recycled by every access going through b_transport or
+        /// transport_dbg, each one owns its extension for its whole lifetime
+        tlm::tlm_generic_payload instr_trans;
+        icio_payload_extension * icio_ext;
+        tlm::tlm_generic_payload data_trans;
+        dcio_payload_extension * dcio_ext;
+        tlm::tlm_generic_payload dbg_trans;
+        dcio_payload_extension * dbg_ext;
+
+        /// Resets the recycled instruction payload in place for a new fetch
+        inline tlm::tlm_generic_payload & prepare_instr( const unsigned int & address, unsigned \
+            char * data, unsigned int flush, unsigned int * debug ) throw(){
+            this->icio_ext->flush = flush;
+            this->icio_ext->flushl = 0;
+            this->icio_ext->fline = 0;
+            this->icio_ext->debug = debug;
+            this->icio_ext->fail = false;
+            this->prepare_payload(this->instr_trans, tlm::TLM_READ_COMMAND, address, data, 4);
+            return this->instr_trans;
+        }
+
+        /// Resets the recycled data payload in place for a new access
+        inline tlm::tlm_generic_payload & prepare_data( tlm::tlm_command command, const unsigned \
+            int & address, unsigned char * data, unsigned int length, unsigned int asi, unsigned \
+            int flush, unsigned int lock, unsigned int * debug ) throw(){
+            this->dcio_ext->asi = asi;
+            this->dcio_ext->flush = flush;
+            this->dcio_ext->flushl = 0;
+            this->dcio_ext->lock = lock;
+            this->dcio_ext->debug = debug;
+            this->dcio_ext->fail = false;
+            this->prepare_payload(this->data_trans, command, address, data, length);
+            return this->data_trans;
+        }
+
+        /// Resets the recycled debug payload in place for a new debug access
+        inline tlm::tlm_generic_payload & prepare_dbg( tlm::tlm_command command, const unsigned \
+            int & address, unsigned char * data, unsigned int length, unsigned int * debug ) throw(){
+            this->dbg_ext->asi = 8;
+            this->dbg_ext->flush = 0;
+            this->dbg_ext->flushl = 0;
+            this->dbg_ext->lock = 0;
+            this->dbg_ext->debug = debug;
+            this->dbg_ext->fail = false;
+            this->prepare_payload(this->dbg_trans, command, address, data, length);
+            return this->dbg_trans;
+        }
+
+        inline void prepare_payload( tlm::tlm_generic_payload & trans, tlm::tlm_command command, \
+            const unsigned int & address, unsigned char * data, unsigned int length ) throw(){
+            trans.set_command(command);
+            trans.set_address(address);
+            trans.set_data_ptr(data);
+            trans.set_data_length(length);
+            trans.set_streaming_width(length);
+            trans.set_byte_enable_ptr(0);
+            trans.set_dmi_allowed(false);
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        }
+
+        void dmi_request( tlm::tlm_generic_payload & trans );
+        void invalidate_direct_mem_ptr( sc_dt::uint64 start_range, sc_dt::uint64 end_range );
+
+        /// Returns the granted region containing the whole access or NULL
+        /// if the access has to go through b_transport
+        inline tlm::tlm_dmi * dmi_find( const unsigned int & address, unsigned int length, \
+            bool write ) throw(){
+            if(this->dmi_regions.empty()){
+                return NULL;
+            }
+            sc_dt::uint64 last = (sc_dt::uint64)address + length - 1;
+            tlm::tlm_dmi * dmi = &this->dmi_regions[this->dmi_last];
+            if(address < dmi->get_start_address() || last > dmi->get_end_address()){
+                unsigned int low = 0;
+                unsigned int high = this->dmi_regions.size();
+                while(high - low > 1){
+                    unsigned int mid = (low + high) / 2;
+                    if(this->dmi_regions[mid].get_start_address() <= address){
+                        low = mid;
+                    } else {
+                        high = mid;
+                    }
+                }
+                dmi = &this->dmi_regions[low];
+                if(address < dmi->get_start_address() || last > dmi->get_end_address()){
+                    return NULL;
+                }
+                this->dmi_last = low;
+            }
+            if(write? !dmi->is_write_allowed() : !dmi->is_read_allowed()){
+                return NULL;
+            }
+            return dmi;
+        }
 
         public:
         TLMMemory( sc_module_name portName, tlm_utils::tlm_quantumkeeper & quantKeeper );
@@ -69,7 +170,6 @@ namespace leon3_funclt_trap{
 				  const unsigned int flush,
 				  const unsigned int lock) throw();
 
-
         // Read data word 
         inline unsigned int read_word( const unsigned int & address,
 				       const unsigned int asi,
@@ -77,15 +177,11 @@ namespace leon3_funclt_trap{
 				       const unsigned int lock) throw(){
 
             unsigned int datum = 0;
-            if(this->dmi_ptr_valid) {
+            tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), false);
+            if(dmi != NULL){
                 v::debug << name() << "DMI Access" << endl;
-                if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-                    SC_REPORT_ERROR("TLM-2", "Error in reading memory data through DMI: address out of \
-                        bounds");
-                }
-                memcpy(&datum, this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() \
-                    + address, sizeof(datum));
-                this->quantKeeper.inc(this->dmi_data.get_read_latency());
+                memcpy(&datum, dmi->get_dmi_ptr() + (address - dmi->get_start_address()), sizeof(datum));
+                this->quantKeeper.inc(dmi->get_read_latency());
                 if(this->quantKeeper.need_sync()){
                     this->quantKeeper.sync();
                 }
@@ -93,25 +189,8 @@ namespace leon3_funclt_trap{
             } else {
                 sc_time delay = this->quantKeeper.get_local_time();
                 unsigned int debug = 0;
-                dcio_payload_extension *dcioExt = new dcio_payload_extension();
-                tlm::tlm_generic_payload trans;
-		
-                // Create & init data payload extension
-                dcioExt->asi    = asi;
-                dcioExt->flush  = flush;
-                dcioExt->lock   = lock;
-                dcioExt->debug  = &debug;
-
-                trans.set_address(address);
-                trans.set_read();
-                trans.set_data_ptr(reinterpret_cast<unsigned char*>(&datum));
-                trans.set_data_length(sizeof(datum));
-                trans.set_byte_enable_ptr(0);
-                trans.set_dmi_allowed(false);
-                trans.set_response_status( tlm::TLM_INCOMPLETE_RESPONSE );
-
-                // Hook extension onto payload
-                trans.set_extension(dcioExt);
+                tlm::tlm_generic_payload & trans = this->prepare_data(tlm::TLM_READ_COMMAND, address, \
+                    reinterpret_cast<unsigned char *>(&datum), sizeof(datum), asi, flush, lock, &debug);
 
                 this->initSocket->b_transport(trans, delay);
 
@@ -120,13 +199,9 @@ namespace leon3_funclt_trap{
                     SC_REPORT_ERROR("TLM-2", errorStr.c_str());
                 }
                 if(trans.is_dmi_allowed()){
-                    this->dmi_data.init();
-                    this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+                    this->dmi_request(trans);
                 }
 
-                // Release extension
-                trans.free_all_extensions();
-                
                 //Now lets keep track of time
                 this->quantKeeper.set(delay);
                 if(this->quantKeeper.need_sync()){
@@ -164,15 +239,11 @@ namespace leon3_funclt_trap{
 				        const unsigned int flush) throw() {
 
             unsigned int datum = 0;
-            if (this->dmi_ptr_valid){
+            tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), false);
+            if(dmi != NULL){
                 v::debug << name() << "DMI Access" << endl;
-                if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-                    SC_REPORT_ERROR("TLM-2", "Error in reading memory data through DMI: address out of \
-                        bounds");
-                }
-                memcpy(&datum, this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() \
-                    + address, sizeof(datum));
-                this->quantKeeper.inc(this->dmi_data.get_read_latency());
+                memcpy(&datum, dmi->get_dmi_ptr() + (address - dmi->get_start_address()), sizeof(datum));
+                this->quantKeeper.inc(dmi->get_read_latency());
                 if(this->quantKeeper.need_sync()){
                     this->quantKeeper.sync();
                 }
@@ -180,23 +251,8 @@ namespace leon3_funclt_trap{
             } else {
                 sc_time delay = this->quantKeeper.get_local_time();
                 unsigned int debug = 0;
-                icio_payload_extension *icioExt = new icio_payload_extension();
-                tlm::tlm_generic_payload trans;
-		
-                // Create & init instruction payload extension
-                icioExt->flush  = flush;
-                icioExt->debug = &debug;
-
-                trans.set_address(address);
-                trans.set_read();
-                trans.set_data_ptr(reinterpret_cast<unsigned char*>(&datum));
-                trans.set_data_length(sizeof(datum));
-                trans.set_byte_enable_ptr(0);
-                trans.set_dmi_allowed(false);
-                trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
-
-                // Hook extension onto payload
-                trans.set_extension(icioExt);
+                tlm::tlm_generic_payload & trans = this->prepare_instr(address, \
+                    reinterpret_cast<unsigned char *>(&datum), flush, &debug);
 
                 this->initSocket->b_transport(trans, delay);
 
@@ -205,13 +261,9 @@ namespace leon3_funclt_trap{
                     SC_REPORT_ERROR("TLM-2", errorStr.c_str());
                 }
                 if(trans.is_dmi_allowed()){
-                    this->dmi_data.init();
-                    this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+                    this->dmi_request(trans);
                 }
 
-                // Remove payload extension
-                trans.free_all_extensions();
-
                 //Now lets keep track of time
                 this->quantKeeper.set(delay);
                 if(this->quantKeeper.need_sync()){
@@ -257,38 +309,19 @@ namespace leon3_funclt_trap{
                 v::debug << name() << "Debugger" << endl;
                 this->debugger->notifyAddress(address, sizeof(datum));
             }
-            if(this->dmi_ptr_valid){
+            tlm::tlm_dmi * dmi = this->dmi_find(address, sizeof(datum), true);
+            if(dmi != NULL){
                 v::debug << name() << "DMI Access" << endl;
-                if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-                    SC_REPORT_ERROR("TLM-2", "Error in writing memory data through DMI: address out of \
-                        bounds");
-                }
-                memcpy(this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() + address, \
-                    &datum, sizeof(datum));
-                this->quantKeeper.inc(this->dmi_data.get_write_latency());
+                memcpy(dmi->get_dmi_ptr() + (address - dmi->get_start_address()), &datum, sizeof(datum));
+                this->quantKeeper.inc(dmi->get_write_latency());
                 if(this->quantKeeper.need_sync()){
                     this->quantKeeper.sync();
                 }
             } else {
                 sc_time delay = this->quantKeeper.get_local_time();
                 unsigned int debug = 0;
-                dcio_payload_extension *dcioExt = new dcio_payload_extension();
-                tlm::tlm_generic_payload trans;
-
-                // Create & init data payload extension
-                dcioExt->asi = asi;
-                dcioExt->flush = flush;
-                dcioExt->lock = lock;
-                dcioExt->debug = &debug;
-
-                trans.set_address(address);
-                trans.set_write();
-                trans.set_data_ptr((unsigned char*)&datum);
-                trans.set_data_length(sizeof(datum));
-                trans.set_byte_enable_ptr(0);
-                trans.set_dmi_allowed(false);
-                trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
-                trans.set_extension(dcioExt);
+                tlm::tlm_generic_payload & trans = this->prepare_data(tlm::TLM_WRITE_COMMAND, address, \
+                    reinterpret_cast<unsigned char *>(&datum), sizeof(datum), asi, flush, lock, &debug);
 
                 this->initSocket->b_transport(trans, delay);
                 v::debug << name() << "Wrote word:0x" << hex << v::setw(8) << v::setfill('0')
@@ -300,8 +333,7 @@ namespace leon3_funclt_trap{
                     SC_REPORT_ERROR("TLM-2", errorStr.c_str());
                 }
                 if(trans.is_dmi_allowed()){
-                    this->dmi_data.init();
-                    this->dmi_ptr_valid = this->initSocket->get_direct_mem_ptr(trans, this->dmi_data);
+                    this->dmi_request(trans);
                 }
 
                 //Now lets keep track of time
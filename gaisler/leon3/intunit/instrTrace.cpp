@@ -0,0 +1,152 @@
+/***************************************************************************\
+ *
+ *
+ *         _/        _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *        _/        _/        _/    _/  _/_/    _/         _/
+ *       _/        _/_/_/    _/    _/  _/  _/  _/     _/_/
+ *      _/        _/        _/    _/  _/    _/_/         _/
+ *     _/_/_/_/  _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *
+ *
+ *
+ *
+ *   This file is part of LEON3.
+ *
+ *   LEON3 is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+\***************************************************************************/
+
+
+
+
+
+#include "gaisler/leon3/intunit/instrTrace.hpp"
+#include <string.h>
+
+using namespace leon3_funclt_trap;
+leon3_funclt_trap::InstrTrace::InstrTrace() : records(0), chunk(NULL), chunks(NULL), \
+    fullChunks(CHUNKS), freeChunks(CHUNKS), running(false), file(NULL), ea(0), last(0){
+    #ifdef HAVE_ZLIB
+    this->gzfile = NULL;
+    #endif
+}
+
+leon3_funclt_trap::InstrTrace::~InstrTrace(){
+    this->close();
+}
+
+bool leon3_funclt_trap::InstrTrace::open( const std::string & filename, bool compress, \
+    const sc_time & latency ){
+    this->close();
+    #ifdef HAVE_ZLIB
+    if(compress){
+        this->gzfile = gzopen(filename.c_str(), "wb1");
+        if(this->gzfile == NULL){
+            return false;
+        }
+    } else
+    #endif
+    {
+        this->file = fopen(filename.c_str(), "wb");
+        if(this->file == NULL){
+            return false;
+        }
+    }
+    uint32_t header[2] = {VERSION, 0x01020304};
+    double times[2] = {sc_get_time_resolution().to_seconds() * 1e12, latency.to_seconds() * 1e12};
+    this->write("SRITRACE", 8);
+    this->write(header, sizeof(header));
+    this->write(times, sizeof(times));
+
+    this->chunks = new Chunk[CHUNKS];
+    for(unsigned int i = 1; i < CHUNKS; i++){
+        this->freeChunks.push(&this->chunks[i]);
+    }
+    this->chunk = &this->chunks[0];
+    this->chunk->count = 0;
+    this->records = 0;
+    this->last = sc_time_stamp().value();
+    this->running = true;
+    this->writer = boost::thread(&InstrTrace::run, this);
+    return true;
+}
+
+void leon3_funclt_trap::InstrTrace::close(){
+    if(this->chunk == NULL){
+        return;
+    }
+    if(this->chunk->count){
+        this->submit();
+    }
+    this->running = false;
+    this->writer.join();
+    Chunk * unused;
+    while(this->freeChunks.pop(unused));
+    delete [] this->chunks;
+    this->chunks = NULL;
+    this->chunk = NULL;
+    #ifdef HAVE_ZLIB
+    if(this->gzfile != NULL){
+        gzclose(this->gzfile);
+        this->gzfile = NULL;
+    }
+    #endif
+    if(this->file != NULL){
+        fclose(this->file);
+        this->file = NULL;
+    }
+}
+
+void leon3_funclt_trap::InstrTrace::submit(){
+    this->records += this->chunk->count;
+    while(!this->fullChunks.push(this->chunk)){
+        boost::this_thread::yield();
+    }
+    // Wait for the writer if it fell behind by all chunks
+    while(!this->freeChunks.pop(this->chunk)){
+        boost::this_thread::yield();
+    }
+    this->chunk->count = 0;
+}
+
+void leon3_funclt_trap::InstrTrace::run(){
+    while(true){
+        // Read the flag first, a chunk submitted before close() is popped afterwards
+        bool running = this->running;
+        Chunk * done;
+        if(this->fullChunks.pop(done)){
+            this->write(done->records, done->count * sizeof(TraceRecord));
+            this->freeChunks.push(done);
+        } else if(running){
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        } else {
+            break;
+        }
+    }
+}
+
+void leon3_funclt_trap::InstrTrace::write( const void * data, size_t len ){
+    #ifdef HAVE_ZLIB
+    if(this->gzfile != NULL){
+        gzwrite(this->gzfile, data, len);
+        return;
+    }
+    #endif
+    fwrite(data, 1, len, this->file);
+}
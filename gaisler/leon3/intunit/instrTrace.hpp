@@ -0,0 +1,134 @@
+/***************************************************************************\
+ *
+ *
+ *         _/        _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *        _/        _/        _/    _/  _/_/    _/         _/
+ *       _/        _/_/_/    _/    _/  _/  _/  _/     _/_/
+ *      _/        _/        _/    _/  _/    _/_/         _/
+ *     _/_/_/_/  _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *
+ *
+ *
+ *
+ *   This file is part of LEON3.
+ *
+ *   LEON3 is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+\***************************************************************************/
+
+
+
+
+#ifndef LT_INSTRTRACE_HPP
+#define LT_INSTRTRACE_HPP
+
+#include "core/base/systemc.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/thread/thread.hpp>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define FUNC_MODEL
+#define LT_IF
+namespace leon3_funclt_trap{
+
+    /// One executed instruction. ea is the address of the last data access
+    /// of the instruction, it is only meaningful for memory instructions
+    /// (op == 3). delta is the simulated time the instruction took in units
+    /// of the time resolution, saturated to 32 bit.
+    struct TraceRecord{
+        uint32_t pc;
+        uint32_t opcode;
+        uint32_t ea;
+        uint32_t delta;
+    };
+
+    /// Fixed record binary instruction trace of one core.
+    ///
+    /// The main loop fills chunks of records, full chunks are handed to a
+    /// background thread through a lock-free queue and written (optionally
+    /// gzip compressed) to disk. The main loop only stalls if all chunks are
+    /// waiting for the writer. The file is decoded offline by
+    /// core/tools/itrace.py.
+    ///
+    /// File layout (host byte order): "SRITRACE", u32 version, u32 0x01020304,
+    /// f64 time resolution in ps, f64 clock cycle in ps, then the records.
+    class InstrTrace{
+
+        public:
+        static const unsigned int VERSION = 1;
+        static const unsigned int CHUNK_RECORDS = 1 << 16;
+        static const unsigned int CHUNKS = 8;
+
+        InstrTrace();
+        ~InstrTrace();
+        bool open( const std::string & filename, bool compress, const sc_time & latency );
+        void close();
+        inline bool isOpen() const throw(){
+            return this->chunk != NULL;
+        }
+        /// Called by the memory interface for every data access
+        inline void dataAccess( unsigned int address ) throw(){
+            this->ea = address;
+        }
+        inline void record( unsigned int pc, unsigned int opcode, const sc_time & now ){
+            uint64_t time = now.value();
+            uint64_t delta = time - this->last;
+            TraceRecord & rec = this->chunk->records[this->chunk->count];
+            rec.pc = pc;
+            rec.opcode = opcode;
+            rec.ea = this->ea;
+            rec.delta = delta > 0xFFFFFFFFull? 0xFFFFFFFF : (uint32_t)delta;
+            this->last = time;
+            if(++this->chunk->count == CHUNK_RECORDS){
+                this->submit();
+            }
+        }
+        uint64_t records;
+
+        private:
+        struct Chunk{
+            unsigned int count;
+            TraceRecord records[CHUNK_RECORDS];
+        };
+        void submit();
+        void run();
+        void write( const void * data, size_t len );
+        Chunk * chunk;
+        Chunk * chunks;
+        boost::lockfree::spsc_queue<Chunk *> fullChunks;
+        boost::lockfree::spsc_queue<Chunk *> freeChunks;
+        boost::atomic<bool> running;
+        boost::thread writer;
+        FILE * file;
+        #ifdef HAVE_ZLIB
+        gzFile gzfile;
+        #endif
+        unsigned int ea;
+        uint64_t last;
+    };
+
+};
+
+#endif
@@ -296,7 +296,6 @@ void leon3_funclt_trap::Instruction::RaiseException( unsigned int pcounter, unsi
             irqAck.send_pin_req(IMPL_DEP_EXC - exceptionId);
         }
         flush();
-        annull();
     }
 }
 
@@ -801,9 +800,11 @@ unsigned int leon3_funclt_trap::WRITEpsr_imm::behavior(){
 
     if(supervisorException){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(illegalCWP){
         RaiseException(pcounter, npcounter, ILLEGAL_INSTR);
+        return 0;
     }
     return this->totalInstrCycles;
 }
@@ -974,6 +975,7 @@ unsigned int leon3_funclt_trap::READpsr::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     rd = psr_temp;
@@ -1225,6 +1227,7 @@ unsigned int leon3_funclt_trap::LDSBA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     rd = readValue;
@@ -1298,6 +1301,7 @@ unsigned int leon3_funclt_trap::LDUH_imm::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -1374,9 +1378,11 @@ unsigned int leon3_funclt_trap::STA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -1515,9 +1521,11 @@ unsigned int leon3_funclt_trap::LDSHA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -1598,6 +1606,7 @@ unsigned int leon3_funclt_trap::STBA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -1675,6 +1684,7 @@ unsigned int leon3_funclt_trap::ST_imm::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -1734,6 +1744,7 @@ unsigned int leon3_funclt_trap::READtbr::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     rd = tbr_temp;
@@ -1809,6 +1820,7 @@ unsigned int leon3_funclt_trap::UDIVcc_imm::behavior(){
 
     if(exception){
         RaiseException(pcounter, npcounter, DIV_ZERO);
+        return 0;
     }
     this->WB_plain(this->rd, this->rd_bit, this->result);
     return this->totalInstrCycles;
@@ -1887,9 +1899,11 @@ unsigned int leon3_funclt_trap::SWAPA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -2153,6 +2167,7 @@ unsigned int leon3_funclt_trap::STH_reg::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -2386,7 +2401,7 @@ unsigned int leon3_funclt_trap::LDSTUB_reg::behavior(){
 
     address = rs1 + rs2;
 
-    readValue = dataMem.read_byte(address, 0xA | (PSR[key_S]? 1 : 0), 0, 0);
+    readValue = dataMem.read_byte(address, 0xA | (PSR[key_S]? 1 : 0), 0, 1);
     dataMem.write_byte(address, 0xff, 0xA | (PSR[key_S]? 1 : 0), 0, 0);
     stall(2);
 
@@ -2636,6 +2651,7 @@ unsigned int leon3_funclt_trap::LD_reg::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -2713,6 +2729,7 @@ unsigned int leon3_funclt_trap::ST_reg::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -2856,6 +2873,7 @@ unsigned int leon3_funclt_trap::LDD_reg::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     if(rd_bit % 2 == 0){
@@ -2995,6 +3013,7 @@ unsigned int leon3_funclt_trap::LDUH_reg::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -3143,6 +3162,7 @@ unsigned int leon3_funclt_trap::SAVE_imm::behavior(){
 
     if(!okNewWin){
         RaiseException(pcounter, npcounter, WINDOW_OVERFLOW);
+        return 0;
     }
 
     if(okNewWin){
@@ -3362,6 +3382,7 @@ unsigned int leon3_funclt_trap::STD_imm::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -3563,6 +3584,7 @@ unsigned int leon3_funclt_trap::SWAP_imm::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -3918,6 +3940,7 @@ unsigned int leon3_funclt_trap::STH_imm::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -3977,6 +4000,7 @@ unsigned int leon3_funclt_trap::WRITEwim_imm::behavior(){
 
     if(raiseException){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     if(!raiseException){
@@ -4061,6 +4085,7 @@ unsigned int leon3_funclt_trap::LDD_imm::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     if(rd_bit % 2 == 0){
@@ -4205,9 +4230,11 @@ unsigned int leon3_funclt_trap::LDUHA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -4428,6 +4455,7 @@ unsigned int leon3_funclt_trap::SDIV_imm::behavior(){
 
     if(exception){
         RaiseException(pcounter, npcounter, DIV_ZERO);
+        return 0;
     }
     this->WB_plain(this->rd, this->rd_bit, this->result);
     return this->totalInstrCycles;
@@ -4497,6 +4525,7 @@ unsigned int leon3_funclt_trap::TSUBccTV_imm::behavior(){
 
     if(temp_V){
         RaiseException(pcounter, npcounter, TAG_OVERFLOW);
+        return 0;
     }
     this->WB_tv(this->rd, this->rd_bit, this->result, this->temp_V);
     return this->totalInstrCycles;
@@ -4705,9 +4734,11 @@ unsigned int leon3_funclt_trap::RETT_imm::behavior(){
     if(exceptionEnabled){
         if(supervisor){
             RaiseException(pcounter, npcounter, ILLEGAL_INSTR);
+            return 0;
         }
         else{
             RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+            return 0;
         }
     }
     else if(!supervisor || invalidWin || notAligned){
@@ -4822,6 +4853,7 @@ unsigned int leon3_funclt_trap::SDIVcc_reg::behavior(){
 
     if(exception){
         RaiseException(pcounter, npcounter, DIV_ZERO);
+        return 0;
     }
     this->WB_plain(this->rd, this->rd_bit, this->result);
     return this->totalInstrCycles;
@@ -4981,6 +5013,7 @@ unsigned int leon3_funclt_trap::TRAP_imm::behavior(){
         stall(4);
         RaiseException(pcounter, npcounter, TRAP_INSTRUCTION, (rs1 + SignExtend(imm7, 7)) \
             & 0x0000007F);
+        return 0;
     }
     #ifndef ACC_MODEL // review!
     else{
@@ -5094,6 +5127,7 @@ unsigned int leon3_funclt_trap::WRITEtbr_imm::behavior(){
 
     if(raiseException){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     if(!raiseException){
@@ -5240,6 +5274,7 @@ unsigned int leon3_funclt_trap::RESTORE_reg::behavior(){
 
     if(!okNewWin){
         RaiseException(pcounter, npcounter, WINDOW_UNDERFLOW);
+        return 0;
     }
 
     if(okNewWin){
@@ -5669,6 +5704,7 @@ unsigned int leon3_funclt_trap::READwim::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     rd = wim_temp;
@@ -5718,7 +5754,7 @@ unsigned int leon3_funclt_trap::LDSTUB_imm::behavior(){
 
     address = rs1 + SignExtend(simm13, 13);
 
-    readValue = dataMem.read_byte(address, 0xA | (PSR[key_S]? 1 : 0), 0, 0);
+    readValue = dataMem.read_byte(address, 0xA | (PSR[key_S]? 1 : 0), 0, 1);
     dataMem.write_byte(address, 0xff, 0xA | (PSR[key_S]? 1 : 0), 0, 0);
     stall(2);
 
@@ -5968,6 +6004,7 @@ unsigned int leon3_funclt_trap::TSUBccTV_reg::behavior(){
 
     if(temp_V){
         RaiseException(pcounter, npcounter, TAG_OVERFLOW);
+        return 0;
     }
     this->WB_tv(this->rd, this->rd_bit, this->result, this->temp_V);
     return this->totalInstrCycles;
@@ -6152,6 +6189,7 @@ unsigned int leon3_funclt_trap::LDSH_reg::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -6235,6 +6273,7 @@ unsigned int leon3_funclt_trap::UDIVcc_reg::behavior(){
 
     if(exception){
         RaiseException(pcounter, npcounter, DIV_ZERO);
+        return 0;
     }
     this->WB_plain(this->rd, this->rd_bit, this->result);
     return this->totalInstrCycles;
@@ -6373,6 +6412,7 @@ unsigned int leon3_funclt_trap::STD_reg::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -6500,6 +6540,7 @@ unsigned int leon3_funclt_trap::TADDccTV_imm::behavior(){
 
     if(temp_V){
         RaiseException(pcounter, npcounter, TAG_OVERFLOW);
+        return 0;
     }
     this->WB_tv(this->rd, this->rd_bit, this->result, this->temp_V);
     return this->totalInstrCycles;
@@ -6563,6 +6604,7 @@ unsigned int leon3_funclt_trap::WRITEtbr_reg::behavior(){
 
     if(raiseException){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     if(!raiseException){
@@ -6763,6 +6805,7 @@ unsigned int leon3_funclt_trap::UDIV_imm::behavior(){
 
     if(exception){
         RaiseException(pcounter, npcounter, DIV_ZERO);
+        return 0;
     }
     this->WB_plain(this->rd, this->rd_bit, this->result);
     return this->totalInstrCycles;
@@ -6839,6 +6882,7 @@ unsigned int leon3_funclt_trap::LDSH_imm::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -6951,7 +6995,7 @@ unsigned int leon3_funclt_trap::LDSTUBA_reg::behavior(){
     #endif
 
     if(supervisor){
-        readValue = dataMem.read_byte(address, this->asi, 0, 0);
+        readValue = dataMem.read_byte(address, this->asi, 0, 1);
         dataMem.write_byte(address, 0xff, this->asi, 0, 0);
     }
     else{
@@ -6961,6 +7005,7 @@ unsigned int leon3_funclt_trap::LDSTUBA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     rd = readValue;
@@ -7347,6 +7392,7 @@ unsigned int leon3_funclt_trap::WRITEwim_reg::behavior(){
 
     if(raiseException){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     if(!raiseException){
@@ -8041,6 +8087,7 @@ unsigned int leon3_funclt_trap::TADDccTV_reg::behavior(){
 
     if(temp_V){
         RaiseException(pcounter, npcounter, TAG_OVERFLOW);
+        return 0;
     }
     this->WB_tv(this->rd, this->rd_bit, this->result, this->temp_V);
     return this->totalInstrCycles;
@@ -8130,6 +8177,7 @@ unsigned int leon3_funclt_trap::SDIV_reg::behavior(){
 
     if(exception){
         RaiseException(pcounter, npcounter, DIV_ZERO);
+        return 0;
     }
     this->WB_plain(this->rd, this->rd_bit, this->result);
     return this->totalInstrCycles;
@@ -8271,6 +8319,7 @@ unsigned int leon3_funclt_trap::SWAP_reg::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -8415,9 +8464,11 @@ unsigned int leon3_funclt_trap::STDA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -8559,6 +8610,7 @@ unsigned int leon3_funclt_trap::JUMP_imm::behavior(){
 
     if(trapNotAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     if(!trapNotAligned){
@@ -8817,6 +8869,7 @@ unsigned int leon3_funclt_trap::LDUBA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
 
     rd = readValue;
@@ -8896,6 +8949,7 @@ unsigned int leon3_funclt_trap::JUMP_reg::behavior(){
 
     if(trapNotAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     if(!trapNotAligned){
@@ -9043,6 +9097,7 @@ unsigned int leon3_funclt_trap::UDIV_reg::behavior(){
 
     if(exception){
         RaiseException(pcounter, npcounter, DIV_ZERO);
+        return 0;
     }
     this->WB_plain(this->rd, this->rd_bit, this->result);
     return this->totalInstrCycles;
@@ -9226,9 +9281,11 @@ unsigned int leon3_funclt_trap::LDA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -9309,9 +9366,11 @@ unsigned int leon3_funclt_trap::STHA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
     this->IncrementPC();
     return this->totalInstrCycles;
@@ -9396,9 +9455,11 @@ unsigned int leon3_funclt_trap::LDDA_reg::behavior(){
 
     if(!supervisor){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     if(rd_bit % 2 == 0){
@@ -9559,6 +9620,7 @@ unsigned int leon3_funclt_trap::RESTORE_imm::behavior(){
 
     if(!okNewWin){
         RaiseException(pcounter, npcounter, WINDOW_UNDERFLOW);
+        return 0;
     }
 
     if(okNewWin){
@@ -9633,6 +9695,7 @@ unsigned int leon3_funclt_trap::LD_imm::behavior(){
 
     if(notAligned){
         RaiseException(pcounter, npcounter, MEM_ADDR_NOT_ALIGNED);
+        return 0;
     }
 
     rd = readValue;
@@ -9731,6 +9794,7 @@ unsigned int leon3_funclt_trap::TRAP_reg::behavior(){
     if(raiseException){
         stall(4);
         RaiseException(pcounter, npcounter, TRAP_INSTRUCTION, (rs1 + rs2) & 0x0000007F);
+        return 0;
     }
     #ifndef ACC_MODEL // review!
     else{
@@ -9936,9 +10000,11 @@ unsigned int leon3_funclt_trap::RETT_reg::behavior(){
     if(exceptionEnabled){
         if(supervisor){
             RaiseException(pcounter, npcounter, ILLEGAL_INSTR);
+            return 0;
         }
         else{
             RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+            return 0;
         }
     }
     else if(!supervisor || invalidWin || notAligned){
@@ -10054,6 +10120,7 @@ unsigned int leon3_funclt_trap::SDIVcc_imm::behavior(){
 
     if(exception){
         RaiseException(pcounter, npcounter, DIV_ZERO);
+        return 0;
     }
     this->WB_plain(this->rd, this->rd_bit, this->result);
     return this->totalInstrCycles;
@@ -10143,6 +10210,7 @@ unsigned int leon3_funclt_trap::SAVE_reg::behavior(){
 
     if(!okNewWin){
         RaiseException(pcounter, npcounter, WINDOW_OVERFLOW);
+        return 0;
     }
 
     if(okNewWin){
@@ -10402,9 +10470,11 @@ unsigned int leon3_funclt_trap::WRITEpsr_reg::behavior(){
 
     if(supervisorException){
         RaiseException(pcounter, npcounter, PRIVILEDGE_INSTR);
+        return 0;
     }
     if(illegalCWP){
         RaiseException(pcounter, npcounter, ILLEGAL_INSTR);
+        return 0;
     }
     return this->totalInstrCycles;
 }
@@ -132,9 +132,6 @@ namespace leon3_funclt_trap{
         virtual std::string get_name() const throw() = 0;
         virtual std::string get_mnemonic() const throw() = 0;
         virtual unsigned int get_id() const throw() = 0;
-        inline void annull(){
-            throw annul_exception();
-        }
         inline void flush(){
 
         }
@@ -144,6 +141,8 @@ namespace leon3_funclt_trap{
         bool IncrementRegWindow() throw();
         bool DecrementRegWindow() throw();
         int SignExtend( unsigned int bitSeq, unsigned int bitSeq_length ) const throw();
+        // Enters the trap handler. Behaviors return right after raising a
+        // trap, only fatal errors (trap with PSR[ET] = 0) still throw.
         void RaiseException( unsigned int pcounter, unsigned int npcounter, unsigned int \
             exceptionId, unsigned int customTrapOffset = 0 );
         bool checkIncrementWin() const throw();
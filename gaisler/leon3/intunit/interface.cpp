@@ -1200,6 +1200,16 @@ void leon3_funclt_trap::LEON3_ABIIf::write_char_mem( const unsigned int & addres
     this->dataMem.write_byte_dbg(address, datum);
 }
 
+void leon3_funclt_trap::LEON3_ABIIf::read_block_mem( const unsigned int & address, \
+    unsigned char * data, unsigned int len ){
+    this->dataMem.read_block_dbg(address, data, len);
+}
+
+void leon3_funclt_trap::LEON3_ABIIf::write_block_mem( const unsigned int & address, \
+    const unsigned char * data, unsigned int len ){
+    this->dataMem.write_block_dbg(address, data, len);
+}
+
 
 leon3_funclt_trap::LEON3_ABIIf::~LEON3_ABIIf(){
 
@@ -119,6 +119,10 @@ namespace leon3_funclt_trap{
         unsigned char read_char_mem( const unsigned int & address );
         void write_mem( const unsigned int & address, unsigned int datum );
         void write_char_mem( const unsigned int & address, unsigned char datum );
+        void read_block_mem( const unsigned int & address, unsigned char * data, unsigned \
+            int len );
+        void write_block_mem( const unsigned int & address, const unsigned char * data, \
+            unsigned int len );
         MemoryInterface& get_data_memory();
         boost::circular_buffer<HistoryInstrType>& get_history();
         virtual ~LEON3_ABIIf();
@@ -61,62 +61,215 @@ using namespace trap;
 void leon3_funclt_trap::Processor_leon3_funclt::mainLoop() {
     wait(SC_ZERO_TIME); // wait for SystemC infrastructure.
                         // if you don't wait the register callbacks will crash
+    if(this->parallel) {
+        // Leon3Parallel steps the processor from its own threads
+        return;
+    }
 
-    bool startMet = false;
-    vmap< unsigned int, CacheElem >::iterator instrCacheEnd = this->instrCache.end();
-
-    unsigned int firstPC = this->PC + 0;
-    unsigned int firstbitString = this->instrMem.read_instr(firstPC, 0x8 | (PSR[key_S]? 1 : 0), 0);
-    int firstinstrId = this->decoder.decode(firstbitString);
-    Instruction *firstinstr = this->INSTRUCTIONS[firstinstrId];
-    raisedException = 0;
+    this->beginLoop();
     while(true) {
-        unsigned int numCycles = 0;
         this->instrExecuting = true;
 
         if(irqAck.stopped) {
           while(irqAck.stopped) {
             //if(sc_time_stamp()>sc_time(0, SC_NS)) {
               //wait(irqAck.start);
-              this->toolManager.issue(firstPC, firstinstr);
+              this->idle();
               wait(100, SC_NS);
             //}
           }
-          v::info << name() << "Starting ... " << v::endl;
-          resetOp();
+          this->wakeUp();
         }
 
-        // Log instruction count for power monitoring
-        if (m_pow_mon) {
-            dyn_instr++;
+        this->step(false);
+        if (this->quantKeeper.need_sync()){
+            this->quantKeeper.sync();
         }
+        this->setExecuting(false);
+    }
+}
 
-        if((IRQ != 0xFFFFFFFF) && (PSR[key_ET] && (IRQ == 15 || IRQ > PSR[key_PIL]))){
-            this->IRQ_irqInstr->setInterruptValue(IRQ);
-            try{
-                numCycles = this->IRQ_irqInstr->behavior();
-                //this->IRQ_irqInstr->behavior(); // Replacement for ^^
-            }
-            catch(annul_exception &etc){
-              numCycles = 0;
+void leon3_funclt_trap::Processor_leon3_funclt::beginLoop() {
+    this->startMet = false;
+    this->instrCacheEnd = this->instrCache.end();
+
+    this->firstPC = this->PC + 0;
+    unsigned int firstbitString = this->instrMem.read_instr(this->firstPC, 0x8 | (PSR[key_S]? 1 : 0), 0);
+    int firstinstrId = this->decoder.decode(firstbitString);
+    this->firstinstr = this->INSTRUCTIONS[firstinstrId];
+    raisedException = 0;
+
+    this->curBlock = NULL;
+    this->curBlockIdx = 0;
+    this->curBlockGeneration = 0;
+}
+
+void leon3_funclt_trap::Processor_leon3_funclt::idle() {
+    this->toolManager.issue(this->firstPC, this->firstinstr);
+}
+
+void leon3_funclt_trap::Processor_leon3_funclt::wakeUp() {
+    v::info << name() << "Starting ... " << v::endl;
+    if(!this->snapshotRestored){
+        resetOp();
+    }
+    this->curBlock = NULL;
+}
+
+void leon3_funclt_trap::Processor_leon3_funclt::setExecuting(bool executing) {
+    this->instrExecuting = executing;
+    if(!executing) {
+        this->instrEndEvent.notify();
+    }
+}
+
+bool leon3_funclt_trap::Processor_leon3_funclt::registersObserved() {
+    bool observed = PSR.observed() || WIM.observed() || TBR.observed() || Y.observed() || \
+        PC.observed() || NPC.observed();
+    for(int i = 0; i < 8; i++){
+        observed |= GLOBAL[i].observed();
+    }
+    for(int i = 0; i < 128; i++){
+        observed |= WINREGS[i].observed();
+    }
+    for(int i = 0; i < 32; i++){
+        observed |= ASR[i].observed();
+    }
+    return observed;
+}
+
+bool leon3_funclt_trap::Processor_leon3_funclt::step(bool worker) {
+    unsigned int numCycles = 0;
+    bool traced = false;
+    unsigned int curBitString = 0;
+    bool irq = (IRQ != 0xFFFFFFFF) && (PSR[key_ET] && (IRQ == 15 || IRQ > PSR[key_PIL]));
+
+    if(worker) {
+        // Interrupt acknowledges, the history report and the tools have to
+        // run in the SystemC context
+        if(irq || this->historyEnabled) {
+            return false;
+        }
+        #ifndef DISABLE_TOOLS
+        if(this->toolManager.is_hooked(this->PC + 0)) {
+            return false;
+        }
+        #endif
+    }
+    this->snapshotRestored = false;
+
+    // Log instruction count for power monitoring
+    if (m_pow_mon) {
+        dyn_instr++;
+    }
+
+    if(irq){
+        this->IRQ_irqInstr->setInterruptValue(IRQ);
+        curBlock = NULL;
+        numCycles = this->IRQ_irqInstr->behavior();
+
+    } else {
+        bool trapped = false;
+        curPC = this->PC + 0;
+        if(!startMet && curPC == this->profStartAddr){
+            this->profTimeStart = sc_time_stamp();
+        } else if(startMet && curPC == this->profEndAddr){
+            this->profTimeEnd = sc_time_stamp();
+        }
+
+        // Leave the current block if it got invalidated or if it
+        // cannot be extended any further
+        if(curBlock != NULL && (curBlockGeneration != this->blockCache.generation || \
+            (curBlockIdx == curBlock->entries.size() && (curBlock->closed || \
+            !this->blockCache.samePage(curBlock->startPC, curPC))))){
+            curBlock = NULL;
+        }
+        if(curBlock == NULL && (this->blockCacheEnabled || this->threadedCodeEnabled)){
+            this->blockCache.reclaim();
+            bool supervisor = PSR[key_S];
+            curBlock = this->blockCache.find(curPC, supervisor);
+            if(curBlock == NULL){
+                curBlock = this->blockCache.create(curPC, supervisor);
             }
+            curBlockIdx = 0;
+            curBlockGeneration = this->blockCache.generation;
+        }
 
-        } else {
-            try {
-                curPC = this->PC + 0;
-                if(!startMet && curPC == this->profStartAddr){
-                    this->profTimeStart = sc_time_stamp();
-                } else if(startMet && curPC == this->profEndAddr){
-                    this->profTimeEnd = sc_time_stamp();
+        BlockEntry *curEntry = NULL;
+        bool threadedRun = false;
+        if(curBlock != NULL && curBlockIdx < curBlock->entries.size()) {
+            curEntry = &curBlock->entries[curBlockIdx];
+            threadedRun = this->threadedCodeEnabled && curEntry->threaded.handler != NULL && \
+                !raisedException && !this->historyEnabled && !this->instrTrace.isOpen();
+            #ifndef DISABLE_TOOLS
+            threadedRun = threadedRun && !this->toolManager.is_hooked(curPC);
+            #endif
+            // Registers watched through scireg callbacks are only
+            // written through their normal accessors
+            threadedRun = threadedRun && this->threadedState.bind(PSR, PC, NPC, REGS);
+        }
+        if(threadedRun) {
+            // Run the consecutive entries that have a handler. All but
+            // the last instruction of the run are charged here, the
+            // last one is left to the end of the loop so that it
+            // synchronizes exactly where it would otherwise
+            curInstrPtr = curEntry->instr;
+            while(true) {
+                this->quantKeeper.inc(curEntry->fetchDelay);
+                unsigned int cycles = curEntry->threaded.handler(this->threadedState, curEntry->threaded);
+                if(cycles == ThreadedOp::DECLINED) {
+                    // The instruction traps, behavior() below raises it
+                    threadedRun = false;
+                    break;
                 }
-
-                int instrId = 0;
-                unsigned int bitString = this->instrMem.read_instr(curPC, 0x8 | (PSR[key_S]? 1 : 0),0);
-                if(raisedException) {
-                    unsigned int exception = raisedException;
-                    raisedException = 0;
-                    curInstrPtr->RaiseException(raisedExceptionPC, raisedExceptionNPC, exception);
+                this->threadedInstructions++;
+                numCycles = cycles;
+                // Stop after control transfers, memory access traps and
+                // stores that invalidated decoded code
+                if(curBlockIdx + 1 == curBlock->entries.size() || \
+                    *this->threadedState.pc != curPC + 4 || \
+                    curBlock->entries[curBlockIdx + 1].threaded.handler == NULL || \
+                    raisedException || curBlockGeneration != this->blockCache.generation) {
+                    break;
+                }
+                this->quantKeeper.inc((cycles + 1)*this->latency);
+                if(this->quantKeeper.need_sync()) {
+                    this->quantKeeper.set(this->quantKeeper.get_local_time() - (cycles + 1)*this->latency);
+                    break;
+                }
+                numCycles = 0;
+                this->numInstructions++;
+                if (m_pow_mon) {
+                    dyn_instr++;
                 }
+                curBlockIdx++;
+                curPC += 4;
+                curEntry = &curBlock->entries[curBlockIdx];
+                curInstrPtr = curEntry->instr;
+            }
+        } else if(curEntry != NULL) {
+            // Replay the already decoded and bound instruction, only
+            // the time of the original fetch is charged
+            curInstrPtr = curEntry->instr;
+            curBitString = curEntry->bitString;
+            this->quantKeeper.inc(curEntry->fetchDelay);
+            if(raisedException) {
+                unsigned int exception = raisedException;
+                raisedException = 0;
+                curInstrPtr->RaiseException(raisedExceptionPC, raisedExceptionNPC, exception);
+                trapped = true;
+            }
+        } else {
+            int instrId = 0;
+            sc_time fetchStart = this->quantKeeper.get_current_time();
+            unsigned int bitString = this->instrMem.read_instr(curPC, 0x8 | (PSR[key_S]? 1 : 0),0);
+            curBitString = bitString;
+            if(raisedException) {
+                unsigned int exception = raisedException;
+                raisedException = 0;
+                curInstrPtr->RaiseException(raisedExceptionPC, raisedExceptionNPC, exception);
+                trapped = true;
+            } else {
                 vmap< unsigned int, CacheElem >::iterator cachedInstr = this->instrCache.find(bitString);
                 unsigned int *curCount = NULL;
                 if(cachedInstr != instrCacheEnd) {
@@ -135,28 +288,9 @@ void leon3_funclt_trap::Processor_leon3_funclt::mainLoop() {
                     curInstrPtr = this->INSTRUCTIONS[instrId];
                     curInstrPtr->setParams(bitString);
                 }
-                if (this->historyEnabled) {
-                    srInfo()
-                        ("Address",curPC)
-                        ("Name",curInstrPtr->get_name())
-                        ("Mnemonic",curInstrPtr->get_mnemonic())
-                        ("Instruction History");
-                }
-                try {
-                    #ifndef DISABLE_TOOLS
-                    if (!(this->toolManager.issue(curPC, curInstrPtr))) {
-                        #endif
-                        numCycles = curInstrPtr->behavior();
-                        //curInstrPtr->behavior(); // Replacement for ^^
-                        #ifndef DISABLE_TOOLS
-                    }
-                    #endif
-                } catch (annul_exception &etc) {
-                    numCycles = 0;
-                }
                 if (cachedInstr != instrCacheEnd) {
                     if (curCount && *curCount < 256) {
-//                        *curCount++; // ????
+                        (*curCount)++;
                     } else if (curCount) {
                         // ... and then add the instruction to the cache
                         cachedInstr->second.instr = curInstrPtr;
@@ -166,18 +300,55 @@ void leon3_funclt_trap::Processor_leon3_funclt::mainLoop() {
                     this->instrCache.insert(std::pair< unsigned int, CacheElem >(bitString, CacheElem()));
                     instrCacheEnd = this->instrCache.end();
                 }
-            } catch (annul_exception &etc) {
-                numCycles = 0;
+                if(curBlock != NULL) {
+                    curEntry = this->blockCache.append(curBlock, curInstrPtr, bitString, \
+                        this->quantKeeper.get_current_time() - fetchStart);
+                    curInstrPtr = curEntry->instr;
+                }
             }
         }
-        this->quantKeeper.inc((numCycles + 1)*this->latency);
-        if (this->quantKeeper.need_sync()){
-            this->quantKeeper.sync();
+        if(trapped) {
+            // A pending memory access trap was taken, its handler runs next
+            curBlock = NULL;
+        } else {
+            if (this->historyEnabled) {
+                srInfo()
+                    ("Address",curPC)
+                    ("Name",curInstrPtr->get_name())
+                    ("Mnemonic",curInstrPtr->get_mnemonic())
+                    ("Instruction History");
+            }
+            traced = this->instrTrace.isOpen();
+            if(!threadedRun) {
+                #ifndef DISABLE_TOOLS
+                if (!(this->toolManager.issue(curPC, curInstrPtr))) {
+                    #endif
+                    numCycles = curInstrPtr->behavior();
+                    #ifndef DISABLE_TOOLS
+                }
+                #endif
+            }
+            if(curBlock != NULL) {
+                curBlockIdx++;
+                if(curEntry->flushesCode) {
+                    this->blockCache.flush();
+                    curBlock = NULL;
+                } else if((this->PC + 0) != curPC + 4) {
+                    // Control left the straight-line run
+                    if(curBlockIdx == curBlock->entries.size()) {
+                        curBlock->closed = true;
+                    }
+                    curBlock = NULL;
+                }
+            }
         }
-        this->instrExecuting = false;
-        this->instrEndEvent.notify();
-        this->numInstructions++;
     }
+    this->quantKeeper.inc((numCycles + 1)*this->latency);
+    if (traced) {
+        this->instrTrace.record(curPC, curBitString, this->quantKeeper.get_current_time());
+    }
+    this->numInstructions++;
+    return true;
 }
 
 void leon3_funclt_trap::Processor_leon3_funclt::triggerException(unsigned int exception) {
@@ -245,6 +416,75 @@ void leon3_funclt_trap::Processor_leon3_funclt::resetOp(){
     this->resetCalled = true;
 }
 
+void leon3_funclt_trap::Processor_leon3_funclt::snapshot_save(Snapshot &snapshot){
+    std::vector<unsigned int> regs;
+    regs.push_back(PSR.readNewValue());
+    regs.push_back(WIM.readNewValue());
+    regs.push_back(TBR.readNewValue());
+    regs.push_back(Y.readNewValue());
+    regs.push_back(PC.readNewValue());
+    regs.push_back(NPC.readNewValue());
+    for(int i = 0; i < 8; i++){
+        regs.push_back(GLOBAL[i].readNewValue());
+    }
+    for(int i = 0; i < 128; i++){
+        regs.push_back(WINREGS[i].readNewValue());
+    }
+    for(int i = 0; i < 32; i++){
+        regs.push_back(ASR[i].readNewValue());
+    }
+    snapshot.put("registers", regs);
+    snapshot.put("irq", IRQ);
+    snapshot.put("stopped", irqAck.stopped);
+    snapshot.put("local_time", quantKeeper.get_local_time());
+    snapshot.put("instructions", static_cast<uint64_t>(numInstructions));
+}
+
+void leon3_funclt_trap::Processor_leon3_funclt::snapshot_restore(Snapshot &snapshot){
+    std::vector<unsigned int> regs;
+    if(!snapshot.get("registers", regs) || regs.size() != 6 + 8 + 128 + 32){
+        v::warn << name() << "No processor state in the snapshot" << v::endl;
+        return;
+    }
+    std::vector<unsigned int>::const_iterator reg = regs.begin();
+    PSR.immediateWrite(*reg++);
+    WIM.immediateWrite(*reg++);
+    TBR.immediateWrite(*reg++);
+    Y.immediateWrite(*reg++);
+    PC.immediateWrite(*reg++);
+    NPC.immediateWrite(*reg++);
+    for(int i = 0; i < 8; i++){
+        GLOBAL[i].immediateWrite(*reg++);
+    }
+    for(int i = 0; i < 128; i++){
+        WINREGS[i].immediateWrite(*reg++);
+    }
+    for(int i = 0; i < 32; i++){
+        ASR[i].immediateWrite(*reg++);
+    }
+    // The window registers follow the restored CWP
+    unsigned int cwp = PSR[key_CWP];
+    for(int i = 8; i < 32; i++){
+        REGS[i].updateAlias(WINREGS[(cwp*16 + i - 8) & 0x7f]);
+    }
+    snapshot.get("irq", IRQ);
+    snapshot.get("stopped", irqAck.stopped);
+    sc_time local;
+    if(snapshot.get("local_time", local)){
+        quantKeeper.set(local);
+    }
+    uint64_t instructions;
+    if(snapshot.get("instructions", instructions)){
+        numInstructions = instructions;
+    }
+    // Decoded blocks may hold code of the previous memory content
+    this->blockCache.flush();
+    this->resetCalled = true;
+    // A running processor must not be reset when it leaves the power down loop,
+    // a stopped one is reset on its next start as usual.
+    this->snapshotRestored = !irqAck.stopped;
+}
+
 // Calculate power/energy values from normalized input data
 void leon3_funclt_trap::Processor_leon3_funclt::power_model() {
 
@@ -291,6 +531,17 @@ void leon3_funclt_trap::Processor_leon3_funclt::start_of_simulation() {
     power_model();
 
   }
+
+  if (!traceFile.getValue().empty()) {
+    #ifndef HAVE_ZLIB
+    if (traceCompress) {
+      v::warn << name() << "Built without zlib, the instruction trace is not compressed" << v::endl;
+    }
+    #endif
+    if (!instrTrace.open(traceFile.getValue(), traceCompress, latency)) {
+      v::error << name() << "Unable to open instruction trace " << traceFile.getValue() << v::endl;
+    }
+  }
 }
 
 void leon3_funclt_trap::Processor_leon3_funclt::end_of_simulation() {
@@ -298,6 +549,18 @@ void leon3_funclt_trap::Processor_leon3_funclt::end_of_simulation() {
     v::report << name() << " * LEON3 Statistic:" << v::endl;
     v::report << name() << " * ------------------" << v::endl;
     v::report << name() << " * Total number of processed instructions: " << numInstructions << v::endl;
+    if (blockCacheEnabled) {
+        v::report << name() << " * Decoded block cache hits: " << blockCache.hits << v::endl;
+        v::report << name() << " * Decoded block cache misses: " << blockCache.misses << v::endl;
+        v::report << name() << " * Decoded block cache invalidations: " << blockCache.invalidations << v::endl;
+    }
+    if (threadedCodeEnabled) {
+        v::report << name() << " * Threaded instructions: " << threadedInstructions << v::endl;
+    }
+    if (instrTrace.isOpen()) {
+        instrTrace.close();
+        v::report << name() << " * Traced instructions: " << instrTrace.records << v::endl;
+    }
     v::report << name() << " ******************************************** " << v::endl;
 }
 
@@ -406,6 +669,12 @@ leon3_funclt_trap::Processor_leon3_funclt::Processor_leon3_funclt(
       IRQ_port("IRQ_port", IRQ),
       irqAck("irqAck"),
       historyEnabled("historyEnabled", false),
+      traceFile("traceFile", ""),
+      traceCompress("traceCompress", false),
+      blockCacheEnabled("blockCacheEnabled", false),
+      threadedCodeEnabled("threadedCodeEnabled", false),
+      threadedState(dataMem),
+      threadedInstructions(0),
       m_pow_mon(pow_mon),
       sta_power_norm("power.leon3.sta_power_norm", 5.27e+8, true), // norm. static power
       int_power_norm("power.leon3.int_power_norm", 5.497e-6, true), // norm. dynamic power
@@ -420,6 +689,11 @@ leon3_funclt_trap::Processor_leon3_funclt::Processor_leon3_funclt(
       numInstructions("instruction_count", 0ull)
 {
     this->resetCalled = false;
+    this->snapshotRestored = false;
+    this->parallel = false;
+    this->curBlock = NULL;
+    this->curBlockIdx = 0;
+    this->curBlockGeneration = 0;
     Processor_leon3_funclt::numInstances++;
     // Initialization of the array holding the initial instance of the instructions
     this->INSTRUCTIONS = new Instruction *[145];
@@ -47,11 +47,15 @@
 #include "gaisler/leon3/intunit/registers.hpp"
 #include "gaisler/leon3/intunit/alias.hpp"
 #include "gaisler/leon3/intunit/memory.hpp"
+#include "gaisler/leon3/intunit/blockCache.hpp"
+#include "gaisler/leon3/intunit/threadedCode.hpp"
+#include "gaisler/leon3/intunit/instrTrace.hpp"
 #include <iostream>
 #include <fstream>
 #include <boost/circular_buffer.hpp>
 #include "core/trapgen/modules/instruction.hpp"
 #include "core/base/vmap.h"
+#include "core/base/snapshot.h"
 
 #include "gaisler/leon3/intunit/irqPorts.hpp"
 #include "gaisler/leon3/intunit/externalPins.hpp"
@@ -63,7 +67,7 @@
 using namespace trap;
 namespace leon3_funclt_trap{
 
-    class Processor_leon3_funclt : public sc_module{
+    class Processor_leon3_funclt : public sc_module, public SnapshotDevice{
       private:
         bool resetCalled;
         void beginOp();
@@ -81,12 +85,39 @@ namespace leon3_funclt_trap{
         vmap<unsigned int, CacheElem> instrCache;
         static int numInstances;
         unsigned int IRQ;
+        /// Set by snapshot_restore, keeps mainLoop from resetting the restored state
+        bool snapshotRestored;
+        /// State kept between two calls of step()
+        bool startMet;
+        vmap<unsigned int, CacheElem>::iterator instrCacheEnd;
+        unsigned int firstPC;
+        Instruction *firstinstr;
+        /// Decoded block the processor currently executes from (block cache only)
+        DecodedBlock *curBlock;
+        unsigned int curBlockIdx;
+        unsigned int curBlockGeneration;
 
       public:
         GC_HAS_CALLBACKS();
         SC_HAS_PROCESS(Processor_leon3_funclt);
         Processor_leon3_funclt(sc_module_name name, MemoryInterface *memory = NULL, sc_time latency = sc_time(10, sc_core::SC_NS), bool pow_mon = false);
         void mainLoop();
+        /// Fetches the first instruction, called once before the first step()
+        void beginLoop();
+        /// Executes the next instruction, or a run of threaded instructions,
+        /// and charges its time to quantKeeper. With worker set nothing is
+        /// executed and false is returned if the instruction needs the
+        /// SystemC context: an interrupt is taken, the history is enabled
+        /// or a tool is hooked at PC.
+        bool step(bool worker);
+        /// Issues the tools while the processor is stopped
+        void idle();
+        /// Resets the processor when it leaves the stopped state
+        void wakeUp();
+        /// Sets the state waitInstrEnd() checks, notifies it when cleared
+        void setExecuting(bool executing);
+        /// True if a scireg callback observes any register
+        bool registersObserved();
         void resetOp();
         void start_of_simulation();
         void end_of_simulation();
@@ -130,8 +161,31 @@ namespace leon3_funclt_trap{
         IntrTLMPort_32 IRQ_port;
         PinTLM_out_32 irqAck;
         sr_param<bool> historyEnabled;
+        /// Write a binary trace of every executed instruction to this file,
+        /// decode it with core/tools/itrace.py. Empty disables the trace.
+        sr_param<std::string> traceFile;
+        /// gzip the instruction trace (needs zlib)
+        sr_param<bool> traceCompress;
+        InstrTrace instrTrace;
+        /// Execute from decoded basic blocks instead of fetching every instruction
+        sr_param<bool> blockCacheEnabled;
+        BlockCache blockCache;
+        /// Run integer ALU code, Bicc and the integer loads and stores through
+        /// the threaded handlers, implies blockCacheEnabled. The handlers bypass
+        /// the scireg callbacks, so code is interpreted while callbacks observe
+        /// PSR, PC, NPC or the integer registers.
+        sr_param<bool> threadedCodeEnabled;
+        ThreadedState threadedState;
+        uint64_t threadedInstructions;
         bool m_pow_mon;
+        /// Set by Leon3Parallel before the simulation starts, mainLoop
+        /// then leaves the stepping to it
+        bool parallel;
         void setProfilingRange( unsigned int startAddr, unsigned int endAddr );
+        /// Saves the architectural state (register file, pending IRQ,
+        /// power down state and the local time of the quantum keeper)
+        void snapshot_save(Snapshot &snapshot);
+        void snapshot_restore(Snapshot &snapshot);
         IRQ_IRQ_Instruction * IRQ_irqInstr;
         ~Processor_leon3_funclt();
 
@@ -171,6 +171,11 @@ namespace leon3_funclt_trap{
         }
       }
     };
+
+    /// True if scireg callbacks watch the register (debugger, Python tools)
+    inline bool observed() const throw() {
+      return !scireg_callback_vec.empty();
+    }
   };
 };
 
@@ -392,6 +397,12 @@ namespace leon3_funclt_trap{
         public:
         Reg32_0();
         explicit Reg32_0(const char *name);
+        /// Direct reference to the stored value. Reads and writes through it
+        /// bypass the scireg callbacks, only meant for the threaded code engine,
+        /// which checks observed() before it binds the register.
+        inline unsigned int & rawValue() throw(){
+            return this->m_cur_val;
+        }
 
         inline InnerField & operator []( int bitField ) throw(){
             switch(bitField){
@@ -1400,6 +1411,12 @@ namespace leon3_funclt_trap{
         public:
         Reg32_3();
         explicit Reg32_3(const char *name);
+        /// Direct reference to the stored value. Reads and writes through it
+        /// bypass the scireg callbacks, only meant for the threaded code engine,
+        /// which checks observed() before it binds the register.
+        inline unsigned int & rawValue() throw(){
+            return this->m_cur_val;
+        }
 
         inline InnerField & operator []( int bitField ) throw(){
             return this->field_empty;
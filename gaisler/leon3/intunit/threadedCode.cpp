@@ -0,0 +1,387 @@
+/***************************************************************************\
+ *
+ *
+ *         _/        _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *        _/        _/        _/    _/  _/_/    _/         _/
+ *       _/        _/_/_/    _/    _/  _/  _/  _/     _/_/
+ *      _/        _/        _/    _/  _/    _/_/         _/
+ *     _/_/_/_/  _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *
+ *
+ *
+ *
+ *   This file is part of LEON3.
+ *
+ *   LEON3 is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+\***************************************************************************/
+
+
+
+
+#include "gaisler/leon3/intunit/threadedCode.hpp"
+#include "gaisler/leon3/intunit/registers.hpp"
+#include "gaisler/leon3/intunit/alias.hpp"
+#include "gaisler/leon3/intunit/memory.hpp"
+
+using namespace leon3_funclt_trap;
+
+namespace {
+
+    /// The operations mirror the behavior() methods in instructions.cpp
+    struct OpAnd{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a & b; } };
+    struct OpAndN{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a & ~b; } };
+    struct OpOr{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a | b; } };
+    struct OpOrN{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a | ~b; } };
+    struct OpXor{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a ^ b; } };
+    struct OpXNor{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a ^ ~b; } };
+    struct OpSll{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a << (b & 0x1f); } };
+    struct OpSrl{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a >> (b & 0x1f); } };
+    struct OpSra{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return ((int)a) >> (b & 0x1f); } };
+    struct OpAdd{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a + b; } };
+    struct OpSub{ static inline unsigned int apply( unsigned int a, unsigned int b ){ return a - b; } };
+
+    enum IccUpdate{ ICC_NONE, ICC_LOGIC, ICC_ADD, ICC_SUB };
+
+    template<class Op, bool useImm, IccUpdate icc>
+    unsigned int aluHandler( ThreadedState & state, const ThreadedOp & op ){
+        *state.pc = *state.npc;
+        *state.npc += 4;
+
+        unsigned int rs1_op = *state.regsR[op.rs1];
+        unsigned int rs2_op = useImm ? op.imm : *state.regsR[op.rs2];
+        unsigned int result = Op::apply(rs1_op, rs2_op);
+        if(icc != ICC_NONE){
+            unsigned int flags = ((result & 0x80000000) >> 8) | ((result == 0) << 22);
+            if(icc == ICC_ADD){
+                flags |= (((rs1_op & rs2_op & (~result)) | ((~rs1_op) & (~rs2_op) & result)) >> 31) << 21;
+                flags |= (((rs1_op & rs2_op) | ((rs1_op | rs2_op) & (~result))) >> 31) << 20;
+            } else if(icc == ICC_SUB){
+                flags |= (((rs1_op & (~rs2_op) & (~result)) | ((~rs1_op) & rs2_op & result)) >> 31) << 21;
+                flags |= ((((~rs1_op) & rs2_op) | (((~rs1_op) | rs2_op) & result)) >> 31) << 20;
+            }
+            *state.psr = (*state.psr & 0xff0fffffL) | flags;
+        }
+        *state.regsW[op.rd] = result;
+        return 0;
+    }
+
+    unsigned int sethiHandler( ThreadedState & state, const ThreadedOp & op ){
+        *state.pc = *state.npc;
+        *state.npc += 4;
+
+        *state.regsW[op.rd] = op.imm;
+        return 0;
+    }
+
+    unsigned int branchHandler( ThreadedState & state, const ThreadedOp & op ){
+        unsigned int pcounter = *state.pc;
+        unsigned int npcounter = *state.npc;
+        bool icc_n = (*state.psr & 0x00800000) != 0;
+        bool icc_z = (*state.psr & 0x00400000) != 0;
+        bool icc_v = (*state.psr & 0x00200000) != 0;
+        bool icc_c = (*state.psr & 0x00100000) != 0;
+        bool exec;
+        switch(op.cond){
+            case 0x8: exec = true; break;
+            case 0x0: exec = false; break;
+            case 0x9: exec = !icc_z; break;
+            case 0x1: exec = icc_z; break;
+            case 0xa: exec = !icc_z && (icc_n == icc_v); break;
+            case 0x2: exec = icc_z || (icc_n != icc_v); break;
+            case 0xb: exec = icc_n == icc_v; break;
+            case 0x3: exec = icc_n != icc_v; break;
+            case 0xc: exec = !icc_c && !icc_z; break;
+            case 0x4: exec = icc_c || icc_z; break;
+            case 0xd: exec = !icc_c; break;
+            case 0x5: exec = icc_c; break;
+            case 0xe: exec = !icc_n; break;
+            case 0x6: exec = icc_n; break;
+            case 0xf: exec = !icc_v; break;
+            default: exec = icc_v; break;
+        }
+        if(exec){
+            unsigned int targetPc = pcounter + op.imm;
+            // Only branch always skips its delay slot when annulled
+            if(op.cond == 0x8 && op.annul){
+                *state.pc = targetPc;
+                *state.npc = targetPc + 4;
+            } else {
+                *state.pc = npcounter;
+                *state.npc = targetPc;
+            }
+        } else if(op.annul){
+            *state.pc = npcounter + 4;
+            *state.npc = npcounter + 8;
+        } else {
+            *state.pc = npcounter;
+            *state.npc = npcounter + 4;
+        }
+        return 2;
+    }
+
+    /// Memory accesses of the integer loads and stores, the sign extension
+    /// matches SignExtend() in the behaviors
+    struct AccessWord{
+        static const unsigned int size = 4;
+        static inline unsigned int read( MemoryInterface & mem, unsigned int address, unsigned int asi ){
+            return mem.read_word(address, asi, 0, 0);
+        }
+        static inline void write( MemoryInterface & mem, unsigned int address, unsigned int datum, unsigned int asi ){
+            mem.write_word(address, datum, asi, 0, 0);
+        }
+    };
+    struct AccessUHalf{
+        static const unsigned int size = 2;
+        static inline unsigned int read( MemoryInterface & mem, unsigned int address, unsigned int asi ){
+            return mem.read_half(address, asi, 0, 0);
+        }
+        static inline void write( MemoryInterface & mem, unsigned int address, unsigned int datum, unsigned int asi ){
+            mem.write_half(address, (unsigned short int)(datum & 0x0000FFFF), asi, 0, 0);
+        }
+    };
+    struct AccessSHalf{
+        static const unsigned int size = 2;
+        static inline unsigned int read( MemoryInterface & mem, unsigned int address, unsigned int asi ){
+            return (int)(short int)mem.read_half(address, asi, 0, 0);
+        }
+    };
+    struct AccessUByte{
+        static const unsigned int size = 1;
+        static inline unsigned int read( MemoryInterface & mem, unsigned int address, unsigned int asi ){
+            return mem.read_byte(address, asi, 0, 0);
+        }
+        static inline void write( MemoryInterface & mem, unsigned int address, unsigned int datum, unsigned int asi ){
+            mem.write_byte(address, (unsigned char)(datum & 0x000000FF), asi, 0, 0);
+        }
+    };
+    struct AccessSByte{
+        static const unsigned int size = 1;
+        static inline unsigned int read( MemoryInterface & mem, unsigned int address, unsigned int asi ){
+            return (int)(signed char)mem.read_byte(address, asi, 0, 0);
+        }
+    };
+
+    /// User or supervisor data space, depending on PSR[S]
+    inline unsigned int dataAsi( const ThreadedState & state ){
+        return 0xA | ((*state.psr & 0x80) >> 7);
+    }
+
+    // Misaligned accesses trap, behavior() takes care of them. A bus error
+    // or MMU fault is reported through triggerException() just as for
+    // behavior(), so the PC is only advanced after the access.
+    template<class Access, bool useImm>
+    unsigned int loadHandler( ThreadedState & state, const ThreadedOp & op ){
+        unsigned int address = *state.regsR[op.rs1] + (useImm ? op.imm : *state.regsR[op.rs2]);
+        if((address & (Access::size - 1)) != 0){
+            return ThreadedOp::DECLINED;
+        }
+        *state.regsW[op.rd] = Access::read(state.dataMem, address, dataAsi(state));
+        *state.pc = *state.npc;
+        *state.npc += 4;
+        return 0;
+    }
+
+    template<class Access, bool useImm>
+    unsigned int storeHandler( ThreadedState & state, const ThreadedOp & op ){
+        unsigned int address = *state.regsR[op.rs1] + (useImm ? op.imm : *state.regsR[op.rs2]);
+        if((address & (Access::size - 1)) != 0){
+            return ThreadedOp::DECLINED;
+        }
+        Access::write(state.dataMem, address, *state.regsR[op.rd], dataAsi(state));
+        *state.pc = *state.npc;
+        *state.npc += 4;
+        // stall(1) of the behaviors
+        return 1;
+    }
+
+    template<class Op, IccUpdate icc>
+    inline void setAlu( ThreadedOp & op, bool useImm ){
+        op.handler = useImm ? &aluHandler<Op, true, icc> : &aluHandler<Op, false, icc>;
+    }
+
+    template<class Access>
+    inline void setLoad( ThreadedOp & op, bool useImm ){
+        op.handler = useImm ? &loadHandler<Access, true> : &loadHandler<Access, false>;
+    }
+
+    template<class Access>
+    inline void setStore( ThreadedOp & op, bool useImm ){
+        op.handler = useImm ? &storeHandler<Access, true> : &storeHandler<Access, false>;
+    }
+
+};
+
+leon3_funclt_trap::ThreadedState::ThreadedState( MemoryInterface & dataMem ) : psr(NULL), \
+    pc(NULL), npc(NULL), dataMem(dataMem), zero(0), sink(0){
+    for(int i = 0; i < 32; i++){
+        this->regsR[i] = &this->zero;
+        this->regsW[i] = &this->sink;
+    }
+}
+
+bool leon3_funclt_trap::ThreadedState::bind( Reg32_0 & PSR, Reg32_3 & PC, Reg32_3 & \
+    NPC, Alias * REGS ) throw(){
+    bool observed = PSR.observed() || PC.observed() || NPC.observed();
+    this->psr = &PSR.rawValue();
+    this->pc = &PC.rawValue();
+    this->npc = &NPC.rawValue();
+    // REGS[0] is the constant GLOBAL0, all the others are plain Reg32_3
+    // belonging either to GLOBAL or to the current window of WINREGS
+    this->regsR[0] = &this->zero;
+    this->regsW[0] = &this->sink;
+    for(int i = 1; i < 32; i++){
+        Reg32_3 * reg = static_cast<Reg32_3 *>(REGS[i].getReg());
+        observed |= reg->observed();
+        unsigned int & value = reg->rawValue();
+        this->regsR[i] = &value;
+        this->regsW[i] = &value;
+    }
+    return !observed;
+}
+
+leon3_funclt_trap::ThreadedOp::ThreadedOp() : handler(NULL), rd(0), rs1(0), rs2(0), \
+    imm(0), cond(0), annul(false){
+
+}
+
+ThreadedOp leon3_funclt_trap::ThreadedOp::translate( unsigned int id, unsigned int \
+    bitString ) throw(){
+    ThreadedOp op;
+    op.rd = (bitString & 0x3e000000) >> 25;
+    op.rs1 = (bitString & 0x7c000) >> 14;
+    op.rs2 = (bitString & 0x1f);
+    op.imm = (bitString & 0x1fff);
+    if((op.imm & 0x1000) != 0){
+        op.imm |= 0xffffe000L;
+    }
+    // Instruction ids as returned by get_id(), in every pair of the ALU
+    // operations the first one is the immediate and the second one the
+    // register form, the loads and stores have it the other way round
+    bool useImm = (id & 0x1) != 0;
+    switch(id){
+        case 0: case 1:{
+            setLoad<AccessSByte>(op, !useImm);
+            break;}
+        case 2: case 3:{
+            setLoad<AccessSHalf>(op, !useImm);
+            break;}
+        case 4: case 5:{
+            setLoad<AccessUByte>(op, !useImm);
+            break;}
+        case 6: case 7:{
+            setLoad<AccessUHalf>(op, !useImm);
+            break;}
+        case 8: case 9:{
+            setLoad<AccessWord>(op, !useImm);
+            break;}
+        case 18: case 19:{
+            setStore<AccessUByte>(op, !useImm);
+            break;}
+        case 20: case 21:{
+            setStore<AccessUHalf>(op, !useImm);
+            break;}
+        case 22: case 23:{
+            setStore<AccessWord>(op, !useImm);
+            break;}
+        case 36:{
+            // SETHI
+            op.imm = 0xfffffc00 & ((bitString & 0x3fffff) << 10);
+            op.handler = &sethiHandler;
+            break;}
+        case 37: case 38:{
+            setAlu<OpAnd, ICC_NONE>(op, useImm);
+            break;}
+        case 39: case 40:{
+            setAlu<OpAnd, ICC_LOGIC>(op, useImm);
+            break;}
+        case 41: case 42:{
+            setAlu<OpAndN, ICC_NONE>(op, useImm);
+            break;}
+        case 43: case 44:{
+            setAlu<OpAndN, ICC_LOGIC>(op, useImm);
+            break;}
+        case 45: case 46:{
+            setAlu<OpOr, ICC_NONE>(op, useImm);
+            break;}
+        case 47: case 48:{
+            setAlu<OpOr, ICC_LOGIC>(op, useImm);
+            break;}
+        case 49: case 50:{
+            setAlu<OpOrN, ICC_NONE>(op, useImm);
+            break;}
+        case 51: case 52:{
+            setAlu<OpOrN, ICC_LOGIC>(op, useImm);
+            break;}
+        case 53: case 54:{
+            setAlu<OpXor, ICC_NONE>(op, useImm);
+            break;}
+        case 55: case 56:{
+            setAlu<OpXor, ICC_LOGIC>(op, useImm);
+            break;}
+        case 57: case 58:{
+            setAlu<OpXNor, ICC_NONE>(op, useImm);
+            break;}
+        case 59: case 60:{
+            setAlu<OpXNor, ICC_LOGIC>(op, useImm);
+            break;}
+        case 61: case 62: case 63: case 64: case 65: case 66:{
+            // The immediate shifts use the raw 13 bit field as shift count,
+            // only the well formed encodings are handled here
+            if(useImm){
+                op.imm = (bitString & 0x1fff);
+                if(op.imm > 0x1f){
+                    break;
+                }
+            }
+            if(id <= 62){
+                setAlu<OpSll, ICC_NONE>(op, useImm);
+            } else if(id <= 64){
+                setAlu<OpSrl, ICC_NONE>(op, useImm);
+            } else {
+                setAlu<OpSra, ICC_NONE>(op, useImm);
+            }
+            break;}
+        case 67: case 68:{
+            setAlu<OpAdd, ICC_NONE>(op, useImm);
+            break;}
+        case 69: case 70:{
+            setAlu<OpAdd, ICC_ADD>(op, useImm);
+            break;}
+        case 79: case 80:{
+            setAlu<OpSub, ICC_NONE>(op, useImm);
+            break;}
+        case 81: case 82:{
+            setAlu<OpSub, ICC_SUB>(op, useImm);
+            break;}
+        case 117:{
+            // BRANCH
+            op.cond = (bitString & 0x1e000000) >> 25;
+            op.annul = (bitString & 0x20000000) != 0;
+            op.imm = (bitString & 0x3fffff) << 2;
+            if((bitString & 0x200000) != 0){
+                op.imm |= 0xff000000L;
+            }
+            op.handler = &branchHandler;
+            break;}
+        default:{
+            break;}
+    }
+    return op;
+}
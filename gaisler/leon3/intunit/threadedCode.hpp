@@ -0,0 +1,112 @@
+/***************************************************************************\
+ *
+ *
+ *         _/        _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *        _/        _/        _/    _/  _/_/    _/         _/
+ *       _/        _/_/_/    _/    _/  _/  _/  _/     _/_/
+ *      _/        _/        _/    _/  _/    _/_/         _/
+ *     _/_/_/_/  _/_/_/_/    _/_/    _/      _/   _/_/_/
+ *
+ *
+ *
+ *
+ *   This file is part of LEON3.
+ *
+ *   LEON3 is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+\***************************************************************************/
+
+
+
+#ifndef LT_THREADEDCODE_HPP
+#define LT_THREADEDCODE_HPP
+
+#include "gaisler/leon3/intunit/registers.hpp"
+#include "gaisler/leon3/intunit/alias.hpp"
+
+#define FUNC_MODEL
+#define LT_IF
+namespace leon3_funclt_trap{
+
+    class MemoryInterface;
+    class ThreadedState;
+    class ThreadedOp;
+
+    /// Returns the additional cycles of the instruction like behavior() does,
+    /// or ThreadedOp::DECLINED without touching any state if the instruction
+    /// has to run through behavior() this time (misaligned accesses).
+    typedef unsigned int (*ThreadedHandler)( ThreadedState & state, const ThreadedOp & op );
+
+    /// Raw view of the integer register file used by the threaded handlers.
+    /// The pointers refer straight to the register storage of the current
+    /// window, so neither the aliases nor the scireg callbacks are involved.
+    /// r0 reads from a constant zero and writes to a sink.
+    class ThreadedState{
+
+        public:
+        ThreadedState( MemoryInterface & dataMem );
+        /// Returns false if scireg callbacks observe one of the registers.
+        /// The handlers would not notify them, such code has to run through
+        /// behavior() instead.
+        bool bind( Reg32_0 & PSR, Reg32_3 & PC, Reg32_3 & NPC, Alias * REGS ) throw();
+        unsigned int * regsR[32];
+        unsigned int * regsW[32];
+        unsigned int * psr;
+        unsigned int * pc;
+        unsigned int * npc;
+        /// Loads and stores go through the same interface as behavior()
+        MemoryInterface & dataMem;
+
+        private:
+        unsigned int zero;
+        unsigned int sink;
+    };
+
+};
+
+namespace leon3_funclt_trap{
+
+    /// Pre-bound form of an integer instruction: a plain function pointer and
+    /// its decoded operand fields. The ALU subset, Bicc and the integer loads
+    /// and stores of the default address spaces get a handler, every other
+    /// instruction keeps handler set to NULL and runs through its behavior()
+    /// method. The handlers are written by hand for LEON3, the generated
+    /// processors of the other architectures have none.
+    class ThreadedOp{
+
+        public:
+        static const unsigned int DECLINED = 0xffffffff;
+        ThreadedOp();
+        static ThreadedOp translate( unsigned int id, unsigned int bitString ) throw();
+        ThreadedHandler handler;
+        unsigned char rd;
+        unsigned char rs1;
+        unsigned char rs2;
+        /// Sign extended simm13, imm22 of SETHI, byte displacement of Bicc
+        unsigned int imm;
+        /// Bicc only: condition and annul bit
+        unsigned char cond;
+        bool annul;
+    };
+
+};
+
+
+
+#endif
@@ -16,7 +16,9 @@
 ///
 
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include "gaisler/leon3/leon3.h"
+#include "gaisler/leon3/parallel.h"
 #include "core/common/sr_report.h"
 #include "core/base/vendian.h"
 
@@ -86,8 +88,10 @@ Leon3::Leon3(
       pow_mon,
       abstractionLayer),
   cpu("cpu", this, sc_core::sc_time(10, sc_core::SC_NS), pow_mon),
+  m_worker(NULL),
   debugger(NULL),
   m_intrinsics("intrinsics", *(cpu.abiIf)),
+  m_snapshot("snapshot"),
   g_gdb("gdb", 0, m_generics),
   g_icen("icen", icen, m_generics),
   g_irepl("irepl", irepl, m_generics),
@@ -123,11 +127,13 @@ Leon3::Leon3(
     GC_REGISTER_TYPED_PARAM_CALLBACK(&g_args, gs::cnf::post_write, Leon3, g_args_callback);
     Leon3::init_generics();
     cpu.toolManager.add_tool(m_intrinsics);
+    cpu.toolManager.add_tool(m_snapshot);
 }
 
 Leon3::~Leon3() {
 
   GC_UNREGISTER_CALLBACKS();
+  delete m_worker;
 
 }
 void Leon3::init_generics(){
@@ -193,6 +199,13 @@ void Leon3::start_of_simulation() {
   g_args_callback(g_args, gs::cnf::no_callback);
 }
 
+void Leon3::end_of_simulation() {
+  if (m_worker) {
+    m_worker->stop();
+  }
+  mmu_cache_base::end_of_simulation();
+}
+
 void Leon3::clkcng() {
   mmu_cache_base::clkcng();
   cpu.latency = clock_cycle;
@@ -237,7 +250,7 @@ unsigned int Leon3::read_instr(const unsigned int & address, const unsigned int
 
     //Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
 //std::cout << "Quantum (external) sync" << std::endl;
       this->cpu.quantKeeper.sync();
     }
@@ -263,6 +276,7 @@ sc_dt::uint64 Leon3::read_dword(
     uint32_t debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    this->cpu.instrTrace.dataAccess(address);
     exec_data(
         tlm::TLM_READ_COMMAND,
         address,
@@ -278,7 +292,7 @@ sc_dt::uint64 Leon3::read_dword(
 
     //Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
         this->cpu.quantKeeper.sync();
     }
 
@@ -305,6 +319,7 @@ uint32_t Leon3::read_word(
     uint32_t debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    this->cpu.instrTrace.dataAccess(address);
     exec_data(
         tlm::TLM_READ_COMMAND,
         address,
@@ -320,7 +335,7 @@ uint32_t Leon3::read_word(
 
     //Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
       this->cpu.quantKeeper.sync();
     }
     //Now the code for endianess conversion: the processor is always modeled
@@ -348,6 +363,7 @@ uint16_t Leon3::read_half(
     uint32_t debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    this->cpu.instrTrace.dataAccess(address);
     exec_data(
         tlm::TLM_READ_COMMAND,
         address,
@@ -363,7 +379,7 @@ uint16_t Leon3::read_half(
 
     //Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
         this->cpu.quantKeeper.sync();
     }
 
@@ -386,6 +402,7 @@ uint8_t Leon3::read_byte(
     uint32_t debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    this->cpu.instrTrace.dataAccess(address);
     exec_data(
         tlm::TLM_READ_COMMAND,
         address,
@@ -401,7 +418,7 @@ uint8_t Leon3::read_byte(
 
     // Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
         this->cpu.quantKeeper.sync();
     }
 
@@ -429,6 +446,11 @@ void Leon3::write_dword(
     uint32_t debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    if(this->cpu.blockCache.isCodePage(address)){
+        this->cpu.blockCache.invalidate(address, sizeof(datum));
+    }
+
+    this->cpu.instrTrace.dataAccess(address);
     exec_data(
         tlm::TLM_WRITE_COMMAND,
         address,
@@ -444,7 +466,7 @@ void Leon3::write_dword(
 
     //Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
         this->cpu.quantKeeper.sync();
     }
 }
@@ -468,6 +490,11 @@ void Leon3::write_word(
     unsigned int debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    if(this->cpu.blockCache.isCodePage(address)){
+        this->cpu.blockCache.invalidate(address, sizeof(datum));
+    }
+
+    this->cpu.instrTrace.dataAccess(address);
     exec_data(
         tlm::TLM_WRITE_COMMAND,
         address,
@@ -487,7 +514,7 @@ void Leon3::write_word(
 
     //Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
       this->cpu.quantKeeper.sync();
     }
 }
@@ -512,6 +539,11 @@ void Leon3::write_half(
     uint32_t debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    if(this->cpu.blockCache.isCodePage(address)){
+        this->cpu.blockCache.invalidate(address, sizeof(datum));
+    }
+
+    this->cpu.instrTrace.dataAccess(address);
     exec_data(
         tlm::TLM_WRITE_COMMAND,
         address,
@@ -527,7 +559,7 @@ void Leon3::write_half(
 
     // Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
         this->cpu.quantKeeper.sync();
     }
 }
@@ -547,6 +579,11 @@ void Leon3::write_byte(
     uint32_t debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    if(this->cpu.blockCache.isCodePage(address)){
+        this->cpu.blockCache.invalidate(address, sizeof(datum));
+    }
+
+    this->cpu.instrTrace.dataAccess(address);
     exec_data(
         tlm::TLM_WRITE_COMMAND,
         address,
@@ -562,7 +599,7 @@ void Leon3::write_byte(
 
     //Now lets keep track of time
     this->cpu.quantKeeper.set(delay);
-    if(this->cpu.quantKeeper.need_sync()){
+    if(!this->m_worker && this->cpu.quantKeeper.need_sync()){
         this->cpu.quantKeeper.sync();
     }
 }
@@ -682,6 +719,10 @@ void Leon3::write_dword_dbg(const uint32_t &address, sc_dt::uint64 datum) throw(
     uint32_t debug = 0;
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    if(this->cpu.blockCache.isCodePage(address)){
+        this->cpu.blockCache.invalidate(address, sizeof(datum));
+    }
+
     exec_data(
         tlm::TLM_WRITE_COMMAND,
         address,
@@ -706,6 +747,10 @@ void Leon3::write_word_dbg(const uint32_t &address, uint32_t datum) throw() {
     sc_time delay = this->cpu.quantKeeper.get_local_time();
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    if(this->cpu.blockCache.isCodePage(address)){
+        this->cpu.blockCache.invalidate(address, sizeof(datum));
+    }
+
     exec_data(
         tlm::TLM_WRITE_COMMAND,
         address,
@@ -729,6 +774,10 @@ void Leon3::write_half_dbg(const uint32_t &address, uint16_t datum) throw() {
     sc_time delay = this->cpu.quantKeeper.get_local_time();
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    if(this->cpu.blockCache.isCodePage(address)){
+        this->cpu.blockCache.invalidate(address, sizeof(datum));
+    }
+
     exec_data(
         tlm::TLM_WRITE_COMMAND,
         address,
@@ -748,6 +797,10 @@ void Leon3::write_byte_dbg(const uint32_t &address, uint8_t datum) throw() {
     sc_time delay = this->cpu.quantKeeper.get_local_time();
     tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
 
+    if(this->cpu.blockCache.isCodePage(address)){
+        this->cpu.blockCache.invalidate(address, sizeof(datum));
+    }
+
     exec_data(
         tlm::TLM_WRITE_COMMAND,
         address,
@@ -762,6 +815,64 @@ void Leon3::write_byte_dbg(const uint32_t &address, uint8_t datum) throw() {
         response);
 }
 
+void Leon3::read_block_dbg(const uint32_t &address, uint8_t *data, const uint32_t &len) {
+    uint32_t debug = 0;
+    sc_time delay = this->cpu.quantKeeper.get_local_time();
+    tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
+
+    // Debug reads bypass the cache, so one transaction per page is enough.
+    // Chunks must not cross pages since the MMU translates each page separately.
+    uint32_t done = 0;
+    while (done < len) {
+        uint32_t addr = address + done;
+        uint32_t chunk = std::min(len - done, 0x1000 - (addr & 0xfff));
+        exec_data(
+            tlm::TLM_READ_COMMAND,
+            addr,
+            data + done,
+            chunk,
+            8,
+            &debug,
+            0,
+            0,
+            delay,
+            true,
+            response);
+        done += chunk;
+    }
+}
+
+void Leon3::write_block_dbg(const uint32_t &address, const uint8_t *data, const uint32_t &len) {
+    uint32_t debug = 0;
+    sc_time delay = this->cpu.quantKeeper.get_local_time();
+    tlm::tlm_response_status response = tlm::TLM_INCOMPLETE_RESPONSE;
+
+    // Debug writes still update hit lines in the data cache,
+    // which only handles accesses within one line.
+    uint32_t linesize = static_cast<uint32_t>(g_dlinesize) << 2;
+    uint32_t done = 0;
+    while (done < len) {
+        uint32_t addr = address + done;
+        uint32_t chunk = std::min(len - done, linesize - (addr & (linesize - 1)));
+        if(this->cpu.blockCache.isCodePage(addr)){
+            this->cpu.blockCache.invalidate(addr, chunk);
+        }
+        exec_data(
+            tlm::TLM_WRITE_COMMAND,
+            addr,
+            const_cast<uint8_t *>(data + done),
+            chunk,
+            8,
+            &debug,
+            0,
+            0,
+            delay,
+            true,
+            response);
+        done += chunk;
+    }
+}
+
 void Leon3::lock() {
 
 }
@@ -779,4 +890,46 @@ void Leon3::trigger_exception(unsigned int exception) {
 }
 
 
+void Leon3::code_changed(unsigned int addr, unsigned int len) {
+  cpu.blockCache.invalidate(addr, len);
+}
+
+bool Leon3::code_cached(unsigned int addr, unsigned int len) {
+  if (!len) {
+    return !cpu.blockCache.empty();
+  }
+  unsigned int last = (addr + len - 1) >> cpu.blockCache.PAGE_BITS;
+  for (unsigned int page = addr >> cpu.blockCache.PAGE_BITS; page <= last; page++) {
+    if (cpu.blockCache.isCodePage(page << cpu.blockCache.PAGE_BITS)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Leon3::context_changed(unsigned int context) {
+  cpu.blockCache.setContext(context);
+}
+
+void Leon3::mem_write(unsigned int addr, unsigned int asi, unsigned char * data,
+                      unsigned int length, sc_core::sc_time * t,
+                      unsigned int * debug, bool is_dbg, bool &cacheable, bool is_lock) {
+  if (m_worker && m_worker->active()) {
+    m_worker->write(addr, asi, data, length, t, debug, is_dbg, cacheable, is_lock);
+    return;
+  }
+  mmu_cache_base::mem_write(addr, asi, data, length, t, debug, is_dbg, cacheable, is_lock);
+}
+
+bool Leon3::mem_read(unsigned int addr, unsigned int asi, unsigned char * data,
+                     unsigned int length, sc_core::sc_time * t,
+                     unsigned int * debug, bool is_dbg, bool &cacheable, bool is_lock) {
+  // Reads from DMI regions do not touch any other module
+  if (m_worker && m_worker->active() &&
+      !(m_dmi && !is_dbg && !is_lock && m_abstractionLayer == amba::amba_LT && dmi_find(addr, length))) {
+    return m_worker->read(addr, asi, data, length, t, debug, is_dbg, cacheable, is_lock);
+  }
+  return mmu_cache_base::mem_read(addr, asi, data, length, t, debug, is_dbg, cacheable, is_lock);
+}
+
 /// @}
@@ -38,6 +38,9 @@
 #include "gaisler/leon3/intunit/processor.hpp"
 #include "core/trapgen/debugger/gdb_stub.hpp"
 #include "core/sr_iss/intrinsics/intrinsicmanager.h"
+#include "core/sr_iss/snapshottrigger.h"
+
+class Leon3Worker;
 
 /// @addtogroup mmu_cache MMU_Cache
 /// @{
@@ -95,6 +98,8 @@ class Leon3 :
       ~Leon3();
       void init_generics();
       void start_of_simulation();
+      /// Joins the worker thread of the parallel mode
+      void end_of_simulation();
       virtual void clkcng();
       gs::cnf::callback_return_type g_gdb_callback(gs::gs_param_base& changed_param, gs::cnf::callback_type reason);
       gs::cnf::callback_return_type g_history_callback(gs::gs_param_base& changed_param, gs::cnf::callback_type reason);
@@ -110,6 +115,7 @@ class Leon3 :
       virtual unsigned int read_word_dbg( const unsigned int & address ) throw();
       virtual unsigned short int read_half_dbg( const unsigned int & address ) throw();
       virtual unsigned char read_byte_dbg( const unsigned int & address ) throw();
+      virtual void read_block_dbg( const unsigned int & address, unsigned char * data, const unsigned int & len );
       virtual void write_dword( const unsigned int & address, sc_dt::uint64 datum, const unsigned int asi, const unsigned int flush, const unsigned int lock ) throw();
       virtual void write_word( const unsigned int & address, unsigned int datum, const unsigned int asi, const unsigned int flush, const unsigned int lock ) throw();
       virtual void write_half( const unsigned int & address, unsigned short int datum, const unsigned int asi, const unsigned int flush, const unsigned int lock ) throw();
@@ -118,13 +124,29 @@ class Leon3 :
       virtual void write_word_dbg( const unsigned int & address, unsigned int datum ) throw();
       virtual void write_half_dbg( const unsigned int & address, unsigned short int datum ) throw();
       virtual void write_byte_dbg( const unsigned int & address, unsigned char datum ) throw();
+      virtual void write_block_dbg( const unsigned int & address, const unsigned char * data, const unsigned int & len );
       virtual void lock();
       virtual void unlock();
       virtual void trigger_exception(unsigned int exception);
+      virtual void code_changed(unsigned int addr, unsigned int len);
+      virtual bool code_cached(unsigned int addr, unsigned int len);
+      virtual void context_changed(unsigned int context);
+
+      /// Bus accesses from the worker thread are issued by Leon3Parallel,
+      /// reads from DMI regions stay on the worker
+      virtual void mem_write(unsigned int addr, unsigned int asi, unsigned char * data,
+                             unsigned int length, sc_core::sc_time * t,
+                             unsigned int * debug, bool is_dbg, bool &cacheable, bool is_lock);
+      virtual bool mem_read(unsigned int addr, unsigned int asi, unsigned char * data,
+                            unsigned int length, sc_core::sc_time * t,
+                            unsigned int * debug, bool is_dbg, bool &cacheable, bool is_lock);
 
     LEON3 cpu;
+    /// Host thread of the parallel mode, set by Leon3Parallel::add()
+    Leon3Worker *m_worker;
     GDBStub<uint32_t> *debugger;
     IntrinsicManager<uint32_t> m_intrinsics;
+    SnapshotTrigger<uint32_t> m_snapshot;
 
     sr_param<int> g_gdb;
     sr_param<std::string> g_history;
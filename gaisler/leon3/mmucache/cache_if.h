@@ -53,6 +53,13 @@ class cache_if : public mem_if {
 	/// snooping function (invalidates cache line(s))
 	virtual void snoop_invalidate(const t_snoop &snoop, const sc_core::sc_time& delay) = 0;
 
+	/// snoop filter, returns false if no line in [address, address + length) can be cached
+	virtual bool snoop_present(unsigned int address, unsigned int length) = 0;
+
+	/// instruction fetch from the line buffer, returns false if the word is not buffered
+	virtual bool fetch_buffered(unsigned int address, unsigned char *data,
+	                            sc_core::sc_time *t, unsigned int *debug) = 0;
+
 	// Helper functions for definition of clock cycle
 	virtual void clkcng(sc_core::sc_time &clk) = 0;
 
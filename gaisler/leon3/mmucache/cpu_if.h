@@ -27,6 +27,12 @@ class cpu_if {
         return this->read_byte(address, 0x8, 0, 0);
     }
 
+    virtual void read_block_dbg(const uint32_t &address, uint8_t *data, const uint32_t &len) {
+        for (uint32_t i = 0; i < len; i++) {
+            data[i] = this->read_byte_dbg(address + i);
+        }
+    }
+
     virtual void write_dword(const uint32_t &address, sc_dt::uint64 datum, const uint32_t asi = 0xA, const uint32_t flush = 0, const uint32_t lock = 0) throw() = 0;
     virtual void write_word(const uint32_t &address, uint32_t datum, const uint32_t asi = 0xA, const uint32_t flush = 0, const uint32_t lock = 0) throw() = 0;
     virtual void write_half(const uint32_t &address, uint16_t datum, const uint32_t asi = 0xA, const uint32_t flush = 0, const uint32_t lock = 0) throw() = 0;
@@ -47,6 +53,12 @@ class cpu_if {
         this->write_byte(address, datum, 0x8, 0, 0);
     }
 
+    virtual void write_block_dbg(const uint32_t &address, const uint8_t *data, const uint32_t &len) {
+        for (uint32_t i = 0; i < len; i++) {
+            this->write_byte_dbg(address + i, data[i]);
+        }
+    }
+
     virtual void lock() = 0;
     virtual void unlock() = 0;
     inline void swapEndianess(uint32_t & datum) const throw() {
@@ -6,3 +6,4 @@ const uint32_t t_cache_line::ATAG =  0x00000004;
 const uint32_t t_cache_line::LRR =   0x00000008;
 const uint32_t t_cache_line::LRU =   0x0000000C;
 const uint32_t t_cache_line::LOCK =  0x00000010;
+const uint32_t t_cache_line::DATA =  0x00000020;
@@ -20,6 +20,7 @@
 #include "core/common/sr_register.h"
 #include "core/common/sr_report.h"
 #include "core/base/base.h"
+#include "core/base/snapshot.h"
 
 // Structure of a cache tag
 // ========================
@@ -36,14 +37,14 @@
 typedef struct {
         unsigned int atag;
         unsigned int lrr;
-        int lru;
+        unsigned int lru;
         unsigned int lock;
         unsigned int valid;
 } t_cache_tag;
 
 // single cache data entry
 
-class t_cache_data : public sc_object, public scireg_ns::scireg_region_if {
+class t_cache_data : public sc_object, public scireg_ns::scireg_region_if, public SnapshotDevice {
   public:
     t_cache_data(sc_module_name name, uint32_t size) :
       sc_object(name),
@@ -176,8 +177,20 @@ class t_cache_data : public sc_object, public scireg_ns::scireg_region_if {
       return scireg_ns::SCIREG_FAILURE;
     }
 
+    void snapshot_save(Snapshot &snapshot) {
+      snapshot.put("data", i, size * sizeof(uint32_t));
+    }
+
+    void snapshot_restore(Snapshot &snapshot) {
+      if (!snapshot.get("data", i, size * sizeof(uint32_t))) {
+        srWarn()
+          ("size", size)
+          ("No matching content in the snapshot, the content is kept");
+      }
+    }
+
   private:
-    uint8_t size;
+    uint32_t size;
     ::std::vector<scireg_ns::scireg_callback*> callback_vector;
     uint32_t *i;
     uint8_t *c;
@@ -197,46 +210,42 @@ class t_cache_data : public sc_object, public scireg_ns::scireg_region_if {
     }
 };
 
-// cacheline consists of tag and up to 8 entries (depending on configuration)
-//typedef struct {
-class t_cache_line : public sc_module, public scireg_ns::scireg_region_if {
+// Cache owning t_cache_line views, learns about tool accesses through them
+class t_cache_line_owner {
   public:
-        sr_register_bank<uint32_t, uint32_t> tag;
-        t_cache_data entry;
+        virtual ~t_cache_line_owner() {}
+
+        // A tool attached a callback to a view
+        virtual void line_observer_added() = 0;
 
-        t_cache_line(sc_core::sc_object &parent, sc_module_name name, const uint32_t linesize) :
-          sc_module(name),
+        // A tool removed a callback from a view. The owner may delete all
+        // views in here, including the calling one.
+        virtual void line_observer_removed() = 0;
+
+        // A tool wrote tag or data words through a view
+        virtual void line_written() = 0;
+};
+
+// cacheline consists of tag and up to 8 entries (depending on configuration)
+// The line state itself is kept in the flat tag and data arrays of the
+// vectorcache. A t_cache_line is only a scireg view on one of those lines,
+// created on demand when a tool walks the child regions of the cache.
+// Layout of the view: tag words at VALID..LOCK, line data starting at DATA.
+class t_cache_line : public scireg_ns::scireg_region_if {
+  public:
+        t_cache_line(const std::string &name, t_cache_tag &tag, uint8_t *data,
+                     const uint32_t linesize, t_cache_line_owner &owner) :
           scireg_ns::scireg_region_if(),
-          tag("tag"),
-          entry("entry", linesize) {
-            this->parent = &parent;
-            tag.create_register(
-                "valid",      // name
-                VALID,        // addr
-                0,            // init value
-                0xFFFFFFFF); // write mask
-            tag.create_register(
-                "atag",       // name
-                ATAG,         // addr
-                0,            // init value
-                0xFFFFFFFF); // write mask
-            tag.create_register(
-                "lrr",        // name
-                LRR,          // addr
-                0,            // init value
-                0xFFFFFFFF); // write mask
-            tag.create_register(
-                "lru",        // name
-                LRU,          // addr
-                0,            // init value
-                0xFFFFFFFF); // write mask
-            tag.create_register(
-                "lock",       // name
-                LOCK,         // addr
-                0,            // init value
-                0xFFFFFFFF); // write mask
-            srDebug()("name", name)("create");
-          }
+          m_name(name),
+          m_tag(tag),
+          m_data(data),
+          m_linesize(linesize),
+          m_owner(owner) {
+        }
+
+        const char *name() const {
+          return m_name.c_str();
+        }
 
         /// Get the region_type of this region:
         virtual scireg_ns::scireg_response scireg_get_region_type(scireg_ns::scireg_region_type& t) const {
@@ -244,19 +253,121 @@ class t_cache_line : public sc_module, public scireg_ns::scireg_region_if {
           return scireg_ns::SCIREG_SUCCESS;
         }
 
+        /// Read a vector of "size" bytes at given offset in this region:
+        virtual scireg_ns::scireg_response scireg_read(scireg_ns::vector_byte& v, sc_dt::uint64 size, sc_dt::uint64 offset=0) const {
+          if (offset + size > scireg_get_byte_width()) {
+            return scireg_ns::SCIREG_FAILURE;
+          }
+          v.resize(size);
+          for (sc_dt::uint64 i = 0; i < size; i++) {
+            uint8_t *b = byte_at(offset + i);
+            v[i] = b? *b : 0;
+          }
+          return scireg_ns::SCIREG_SUCCESS;
+        }
+
+        /// Write a vector of "size" bytes at given offset in this region:
+        virtual scireg_ns::scireg_response scireg_write(const scireg_ns::vector_byte& v, sc_dt::uint64 size, sc_dt::uint64 offset=0) {
+          if (offset + size > scireg_get_byte_width()) {
+            return scireg_ns::SCIREG_FAILURE;
+          }
+          for (sc_dt::uint64 i = 0; i < size; i++) {
+            uint8_t *b = byte_at(offset + i);
+            if (b) {
+              *b = v[i];
+            }
+          }
+          m_owner.line_written();
+          return scireg_ns::SCIREG_SUCCESS;
+        }
+
+        virtual sc_dt::uint64 scireg_get_bit_width() const {
+          return (DATA + (m_linesize << 2)) * 8;
+        }
+
+        scireg_ns::scireg_response scireg_add_callback(scireg_ns::scireg_callback &cb) {
+          callback_vector.push_back(&cb);
+          m_owner.line_observer_added();
+          return scireg_ns::SCIREG_SUCCESS;
+        }
+
+        scireg_ns::scireg_response scireg_remove_callback(scireg_ns::scireg_callback& cb) {
+          ::std::vector<scireg_ns::scireg_callback*>::iterator it;
+          it = find(callback_vector.begin(), callback_vector.end(), &cb);
+          if (it != callback_vector.end()) {
+            callback_vector.erase(it);
+            // Might delete this view, no member access after this call
+            m_owner.line_observer_removed();
+          }
+          return scireg_ns::SCIREG_SUCCESS;
+        }
+
+        virtual scireg_ns::scireg_response scireg_get_string_attribute(const char *& s, scireg_ns::scireg_string_attribute_type t) const {
+          switch (t) {
+            case scireg_ns::SCIREG_NAME:
+              s = m_name.c_str();
+              return scireg_ns::SCIREG_SUCCESS;
+
+            case scireg_ns::SCIREG_DESCRIPTION:
+              return scireg_ns::SCIREG_UNSUPPORTED;
+
+            case scireg_ns::SCIREG_STRING_VALUE:
+              return scireg_ns::SCIREG_UNSUPPORTED;
+          }
+
+          return scireg_ns::SCIREG_FAILURE;
+        }
+
+        /// Notifies the attached tools about an access to the line.
+        /// Called by the owning cache only while at least one callback is attached.
+        void execute_callbacks(const scireg_ns::scireg_callback_type &type, const uint32_t &offset, const uint32_t &size) const {
+          scireg_ns::scireg_callback* p;
+          ::std::vector<scireg_ns::scireg_callback*>::const_iterator it;
+          for (it = callback_vector.begin(); it != callback_vector.end(); ++it)
+          {
+            p = *it;
+            if (p->type == type) {
+              p->offset = offset;
+              p->size = size;
+              p->do_callback(*(const_cast<t_cache_line*>(this)));
+            }
+          }
+        }
+
         static const uint32_t VALID ;
         static const uint32_t ATAG  ;
         static const uint32_t LRR   ;
         static const uint32_t LRU   ;
         static const uint32_t LOCK  ;
+        static const uint32_t DATA  ;
 
-  protected:
-        sc_core::sc_object *parent;
+  private:
+        /// Maps an offset of the view onto the backing tag or data storage.
+        /// Returns NULL for the unused gap between the tag words and the data.
+        uint8_t *byte_at(const sc_dt::uint64 offset) const {
+          if (offset >= DATA) {
+            return &m_data[offset - DATA];
+          }
+          unsigned int *word;
+          switch (offset & ~0x3ull) {
+            case 0x00: word = &m_tag.valid; break;
+            case 0x04: word = &m_tag.atag;  break;
+            case 0x08: word = &m_tag.lrr;   break;
+            case 0x0C: word = &m_tag.lru;   break;
+            case 0x10: word = &m_tag.lock;  break;
+            default: return NULL;
+          }
+          return reinterpret_cast<uint8_t *>(word) + (offset & 0x3);
+        }
 
+        std::string m_name;
+        t_cache_tag &m_tag;
+        uint8_t *m_data;
+        uint32_t m_linesize;
+        t_cache_line_owner &m_owner;
+        ::std::vector<scireg_ns::scireg_callback*> callback_vector;
 };
 
-//} t_cache_line;
-
 // structure of a tlb entry (page descriptor cache entry)
 // ========================
 // virtual address tag:
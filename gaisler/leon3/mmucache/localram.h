@@ -114,16 +114,16 @@ class localram : public DefaultBase, public mem_if {
   gs::gs_param_array m_performance_counters;
 
   /// Number of read accesses
-  sr_param<uint64_t> sreads;
+  sr_counter sreads;
 
   /// Number of write accesses
-  sr_param<uint64_t> swrites;
+  sr_counter swrites;
 
   /// Volume of total reads (bytes)
-  sr_param<uint64_t> sreads_byte;
+  sr_counter sreads_byte;
 
   /// Volume of total writes (bytes)
-  sr_param<uint64_t> swrites_byte;
+  sr_counter swrites_byte;
 
   /// *****************************************************
   /// Power Modeling Parameters
@@ -162,10 +162,10 @@ class localram : public DefaultBase, public mem_if {
   sr_param<double> dyn_write_energy;
 
   /// Number of reads from memory (read & reset by monitor)
-  sr_param<uint64_t> dyn_reads;
+  sr_counter dyn_reads;
 
   /// Number of writes to memory (read & reset by monitor)
-  sr_param<uint64_t> dyn_writes;
+  sr_counter dyn_writes;
 
   /// Clock cycle time
   sc_core::sc_time clockcycle;
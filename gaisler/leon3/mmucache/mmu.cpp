@@ -37,6 +37,7 @@ mmu::mmu(ModuleName name, // sysc module name,
 	    m_tlb_rep(tlb_rep),
             m_mmupgsz(mmupgsz),
 	    m_pseudo_rand(0),
+	    m_lru_stamp(0),
 	    m_pow_mon(pow_mon),
             m_performance_counters("performance_counters"),
             tihits("instruction_tlb_hits", 8, m_performance_counters),
@@ -111,6 +112,8 @@ mmu::mmu(ModuleName name, // sysc module name,
 
     }
 
+    micro_tlb_flush();
+
     // The page size can be 4k, 8k, 16k or 32k.
     // Depending on the configuration the indices for the address table
     // lookup have different range.
@@ -474,92 +477,70 @@ signed mmu::tlb_lookup(unsigned int addr, unsigned asi,
     *paddr = 0xffffffffffff0000ULL; // has size of 36bits!
     unsigned int pde;
 
-/*
-    // Search virtual address tag in ipdc (associative)
-    v::debug << this->name() << "Access with ADDR: " << std::hex << addr << " VPN: " << std::hex << vpn
-            << " and OFFSET: " << std::hex << offset << v::endl;
-    pdciter = tlb->find(vpn);
-
-    // Log tlb reads for power monitoring
-    if (m_pow_mon) {
-      // All tlbs are read in parallel !
-      if (tlb == itlb) {
-        dyn_itlb_reads += tlb_size;
-      } else {
-        dyn_dtlb_reads += tlb_size;
-      }
-    }
-
-    // TLB hit
-    if (pdciter != tlb->end()) {
-
-      // Read the PDC entry
-      tmp = pdciter->second;
+    // TLB lookup, skipped if the TLB is disabled (TD)
+    if (!(MMU_CONTROL_REG & (1 << 15))) {
 
-      v::debug << this->name() << "Virtual Address Tag Hit in TLB " << tmp.tlb_no << " for address: "
-                << hex << addr << v::endl;
+      // The direct mapped micro TLB remembers where a virtual address tag
+      // lives in the architected TLB and saves the map lookup.
+      t_micro_tlb_entry * micro = micro_tlb(tlb, vpn);
+      t_PTE_context * entry = (micro->vpn == vpn)? micro->pte_context : NULL;
 
-        // Check the context tag
-        if (tmp.context == MMU_CONTEXT_REG) {
-
-            v::debug << this->name() << "CONTEXT hit " << hex << MMU_CONTEXT_REG << v::endl;
-
-            // Build physical address from PTE and offset, and return
-            //paddr = (((tmp.pte >> 8) << (32 - m_vtag_width)) | (addr & (tmp.page_size -1)));
-            *paddr = ((tmp.pte & ~0xff) << 4 | (addr & (tmp.page_size - 1)));
-            *paddr &= ((0x1ull << 36) - 1);
-            if ((tmp.pte & (1<<7)) == 0) {
-              v::debug << this->name() << "data not cacheable!" << v::endl;
-              cacheable = false;
-            } else {
-              cacheable = true;
-            }
-
-            // Update debug information
-            TLBHIT_SET(*debug);
-
-            if (tlb == itlb) {
-                tihits[tmp.tlb_no]++;
-            } else {
-                tdhits[tmp.tlb_no]++;
-            }
+      if (!entry) {
+        pdciter = tlb->find(vpn);
+        if (pdciter != tlb->end()) {
+          entry = &pdciter->second;
+          micro->vpn = vpn;
+          micro->pte_context = entry;
+        }
+      }
 
-            // Update LRU history
-            if (m_tlb_rep==0) {
-                lru_update(vpn, tlb, tlb_size);
-            }
-            return 0;
+      // Log tlb reads for power monitoring
+      if (m_pow_mon) {
+        // All tlbs are read in parallel !
+        if (tlb == itlb) {
+          dyn_itlb_reads += tlb_size;
         } else {
-
-            v::debug << this->name() << "CONTEXT miss" << v::endl;
-
-            // Update debug information
-            TLBMISS_SET(*debug);
-
-            if (tlb == itlb) {
-                timisses++;
-            } else {
-	        tdmisses++;
-            }
+          dyn_dtlb_reads += tlb_size;
         }
-    } else {
+      }
 
-        v::debug << this->name() << "Virtual Address Tag miss" << v::endl;
+      // TLB hit: the context tag matches and the access is permitted.
+      // Otherwise the page table walk below refreshes the entry or raises the fault.
+      if (entry && (entry->context == MMU_CONTEXT_REG)) {
+        unsigned access_index = (is_write << 2) | ((!(asi & 0x2)) << 1) | (asi & 0x1);
+        if (!access_table[access_index][(entry->pte >> 2) & 0x7]) {
 
-        // Update debug information
-        TLBMISS_SET(*debug);
+          // Build physical address from PTE and offset, and return
+          *paddr = ((entry->pte & ~0xff) << 4 | (addr & (entry->page_size - 1)));
+          *paddr &= ((0x1ull << 36) - 1);
+          cacheable = (entry->pte & (1 << 7)) != 0;
 
-	      if (tlb == itlb) {
-	        timisses++;
-	      } else {
-	        tdmisses++;
-	      }
-    }
+          // Update debug information
+          TLBHIT_SET(*debug);
 
-*/
+          if (tlb == itlb) {
+            tihits[entry->tlb_no]++;
+          } else {
+            tdhits[entry->tlb_no]++;
+          }
 
+          // Update LRU history
+          if (m_tlb_rep == 0) {
+            entry->lru = ++m_lru_stamp;
+          }
+          return 0;
+        }
+      }
 
+      // Update debug information
+      TLBMISS_SET(*debug);
 
+      if (tlb == itlb) {
+        timisses++;
+      } else {
+        tdmisses++;
+      }
+    }
 
     uint64_t page_size;
     unsigned access_index;
@@ -637,7 +618,10 @@ signed mmu::tlb_lookup(unsigned int addr, unsigned asi,
 
         // In case of a virtual address tag miss a new PDC entry is created.
         // For context miss the existing entry will be replaced.
-        if (tlb->size() == tlb_size) {
+        pdciter = tlb->find(vpn);
+        if (pdciter != tlb->end()) {
+            tmp.tlb_no = pdciter->second.tlb_no;
+        } else if (tlb->size() == tlb_size) {
             v::debug << this->name() << "TLB full" << std::hex << pde  << v::endl;
 
             // Remove a TLB entry, with respect to replacement strategy
@@ -650,10 +634,13 @@ signed mmu::tlb_lookup(unsigned int addr, unsigned asi,
         // add to PDC
         tmp.context = MMU_CONTEXT_REG;
         tmp.pte = pde;
-        tmp.lru = 0xffffffffffffffff - 1;
+        tmp.lru = ++m_lru_stamp;
         tmp.page_size = page_size;
 
-        (*tlb)[vpn] = tmp;
+        t_micro_tlb_entry * micro;
+        micro = micro_tlb(tlb, vpn);
+        micro->vpn = vpn;
+        micro->pte_context = &((*tlb)[vpn] = tmp);
 
         // Log TLB writes for power monitoring
         if (m_pow_mon) {
@@ -776,6 +763,7 @@ void mmu::write_mctxr(unsigned int * data) {
   #endif
 
   MMU_CONTEXT_REG = tmp;
+  micro_tlb_flush();
 
   v::debug << name() << "Write to MMU_CONTEXT_REG: " << hex << v::setw(8) << MMU_CONTEXT_REG << v::endl;
 }
@@ -873,7 +861,7 @@ void mmu::diag_read_itlb(unsigned int addr, unsigned int * data) {
 unsigned int mmu::tlb_remove(std::map<t_VAT, t_PTE_context> * tlb, unsigned int tlb_size) {
 
   std::map<t_VAT, t_PTE_context>::iterator selector;
-  std::map<t_VAT, t_PTE_context>::iterator lru_selector;
+  std::map<t_VAT, t_PTE_context>::iterator victim;
 
   unsigned int tlb_select=0;
   uint64_t min_lru = 0xffffffffffffffff;
@@ -891,7 +879,7 @@ unsigned int mmu::tlb_remove(std::map<t_VAT, t_PTE_context> * tlb, unsigned int
       for(selector = tlb->begin(); selector != tlb->end(); selector++) {
 
         if (selector->second.lru < min_lru) {
-          lru_selector = selector;
+          victim = selector;
           tlb_select = selector->second.tlb_no;
           min_lru = selector->second.lru;
         }
@@ -899,9 +887,6 @@ unsigned int mmu::tlb_remove(std::map<t_VAT, t_PTE_context> * tlb, unsigned int
 
       v::debug << this->name() << "Select TLB (LRU): " << tlb_select << " for replacement. " << v::endl;
 
-      tlb->erase(lru_selector);
-      v::debug << this->name() << "Erased TLB " << tlb_select << v::endl;
-
       break;
 
     // Pseudo Random
@@ -910,23 +895,26 @@ unsigned int mmu::tlb_remove(std::map<t_VAT, t_PTE_context> * tlb, unsigned int
       // Random replacement is implemented through
       // modulo-N counter that selects the TLB entry
       // to be removed from the PDC.
-      tlb_select = m_pseudo_rand % (tlb_size + 1);
+      count = m_pseudo_rand++ % tlb->size();
 
-      v::debug << this->name() << "Select TLB (Random): " << tlb_select << " for replacement. " << v::endl;
-
-      count = 0;
-
-      for(selector = tlb->begin(); selector != tlb->end(); selector++) {
-	        if (count == tlb_select) {
+      for(victim = tlb->begin(); count; victim++) {
+        count--;
+      }
+      tlb_select = victim->second.tlb_no;
 
-	          tlb->erase(selector);
-	          break;
+      v::debug << this->name() << "Select TLB (Random): " << tlb_select << " for replacement. " << v::endl;
 
-	        }
-      }
+  }
 
+  // The micro TLB must not point to the removed entry
+  t_micro_tlb_entry * micro = micro_tlb(tlb, victim->first);
+  if (micro->vpn == victim->first) {
+    micro->pte_context = NULL;
   }
 
+  tlb->erase(victim);
+  v::debug << this->name() << "Erased TLB " << tlb_select << v::endl;
+
   return tlb_select;
 
 }
@@ -934,28 +922,11 @@ unsigned int mmu::tlb_remove(std::map<t_VAT, t_PTE_context> * tlb, unsigned int
 // LRU replacement history updater
 void mmu::lru_update(t_VAT vpn, std::map<t_VAT, t_PTE_context> * tlb, unsigned int tlb_size) {
 
-  std::map<t_VAT, t_PTE_context>::iterator selector;
-
-  // The LRU counters of all TLBs, except the selected one (vpn),
-  // are decrement. The counter of the selected TLB is set to the maximum.
-  for (selector = tlb->begin(); selector != tlb->end(); selector++) {
-
-    if (selector->first != vpn) {
-
-      if (selector->second.lru != 0) {
-
-        (selector->second.lru)--;
-
-      }
-
-    } else {
-
-      selector->second.lru = 0xffffffffffffffff - 1;
-
-    }
-
-    v::debug << name() << "TLB " << selector->second.tlb_no << " LRU " << selector->second.lru << v::endl;
-
+  // The selected TLB gets the latest access stamp, which makes all other
+  // TLBs less recently used.
+  pdciter = tlb->find(vpn);
+  if (pdciter != tlb->end()) {
+    pdciter->second.lru = ++m_lru_stamp;
   }
 }
 
@@ -1162,6 +1133,7 @@ void mmu::clkcng(sc_core::sc_time &clk) {
 void mmu::tlb_flush() {
   itlb->clear();
   dtlb->clear();
+  micro_tlb_flush();
   v::debug << name() << "TLB flush" << v::endl;
 };
 
@@ -1169,6 +1141,77 @@ void mmu::tlb_flush() {
 void mmu::tlb_flush(uint32_t vpn) {
   itlb->clear();
   dtlb->clear();
+  micro_tlb_flush();
   v::debug << name() << "TLB flush" << v::endl;
 }
+
+/// Invalidate all micro TLB entries
+void mmu::micro_tlb_flush() {
+  memset(m_imicro_tlb, 0, sizeof(m_imicro_tlb));
+  memset(m_dmicro_tlb, 0, sizeof(m_dmicro_tlb));
+}
+
+namespace {
+
+/// TLB entry as stored in snapshots
+typedef struct {
+  t_VAT vat;
+  t_PTE_context pte;
+} t_snapshot_tlb_entry;
+
+void save_tlb(Snapshot &snapshot, const std::string &key, const std::map<t_VAT, t_PTE_context> &tlb) {
+  std::vector<t_snapshot_tlb_entry> entries;
+  for (std::map<t_VAT, t_PTE_context>::const_iterator iter = tlb.begin(); iter != tlb.end(); ++iter) {
+    t_snapshot_tlb_entry entry;
+    entry.vat = iter->first;
+    entry.pte = iter->second;
+    entries.push_back(entry);
+  }
+  snapshot.put(key, entries);
+}
+
+void restore_tlb(Snapshot &snapshot, const std::string &key, std::map<t_VAT, t_PTE_context> &tlb) {
+  std::vector<t_snapshot_tlb_entry> entries;
+  if (snapshot.get(key, entries)) {
+    tlb.clear();
+    for (std::vector<t_snapshot_tlb_entry>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter) {
+      tlb.insert(std::make_pair(iter->vat, iter->pte));
+    }
+  }
+}
+
+}  // namespace
+
+/// Save registers and TLBs into a snapshot
+void mmu::snapshot_save(Snapshot &snapshot) {
+  snapshot.put("control", MMU_CONTROL_REG);
+  snapshot.put("context_table_pointer", MMU_CONTEXT_TABLE_POINTER_REG);
+  snapshot.put("context", MMU_CONTEXT_REG);
+  snapshot.put("fault_status", MMU_FAULT_STATUS_REG);
+  snapshot.put("fault_address", MMU_FAULT_ADDRESS_REG);
+  snapshot.put("pseudo_rand", m_pseudo_rand);
+  snapshot.put("lru_stamp", m_lru_stamp);
+  save_tlb(snapshot, "itlb", *itlb);
+  if (dtlb != itlb) {
+    save_tlb(snapshot, "dtlb", *dtlb);
+  }
+}
+
+/// Restore registers and TLBs from a snapshot
+void mmu::snapshot_restore(Snapshot &snapshot) {
+  snapshot.get("control", MMU_CONTROL_REG);
+  snapshot.get("context_table_pointer", MMU_CONTEXT_TABLE_POINTER_REG);
+  snapshot.get("context", MMU_CONTEXT_REG);
+  snapshot.get("fault_status", MMU_FAULT_STATUS_REG);
+  snapshot.get("fault_address", MMU_FAULT_ADDRESS_REG);
+  snapshot.get("pseudo_rand", m_pseudo_rand);
+  snapshot.get("lru_stamp", m_lru_stamp);
+  // Pointers into the old TLB content are invalid now
+  micro_tlb_flush();
+  m_current_PTE_context = NULL;
+  restore_tlb(snapshot, "itlb", *itlb);
+  if (dtlb != itlb) {
+    restore_tlb(snapshot, "dtlb", *dtlb);
+  }
+}
 /// @}
@@ -29,13 +29,25 @@
 #include "gaisler/leon3/mmucache/mmu_cache_if.h"
 
 #include "core/base/vendian.h"
+#include "core/base/snapshot.h"
 #include "gaisler/leon3/mmucache/defines.h"
 
 // implementation of a memory management unit
 // ------------------------------------------
 
 /// @brief Memory Management Unit (MMU) for TrapGen LEON3 simulator
-class mmu : public DefaultBase, public mmu_if {
+class mmu : public DefaultBase, public mmu_if, public SnapshotDevice {
+
+ public:
+  /// Number of micro TLB entries (direct mapped, power of two)
+  static const unsigned int MICRO_TLB_SIZE = 64;
+
+  /// Micro TLB entry: caches the position of a virtual address tag in the
+  /// architected TLB (pte_context is NULL for invalid entries).
+  typedef struct {
+    t_VAT vpn;
+    t_PTE_context * pte_context;
+  } t_micro_tlb_entry;
 
  private:
   signed get_physical_address( uint64_t * paddr, signed * prot, unsigned * access_index,
@@ -105,6 +117,14 @@ class mmu : public DefaultBase, public mmu_if {
   /// LRU replacement history updater
   void lru_update(t_VAT vpn, std::map<t_VAT, t_PTE_context> * tlb, unsigned int tlb_size);
 
+  /// Returns the micro TLB slot of vpn for the given TLB
+  inline t_micro_tlb_entry * micro_tlb(std::map<t_VAT, t_PTE_context> * tlb, t_VAT vpn) {
+    return &((tlb == itlb)? m_imicro_tlb : m_dmicro_tlb)[vpn & (MICRO_TLB_SIZE - 1)];
+  }
+
+  /// Invalidate all micro TLB entries
+  void micro_tlb_flush();
+
   /// Return pointer to tlb instruction interface
   tlb_adaptor * get_itlb_if();
   /// Return pointer to tlb data interface
@@ -137,6 +157,12 @@ class mmu : public DefaultBase, public mmu_if {
   /// Helper functions for definition of clock cycle
   void clkcng(sc_core::sc_time &clk);
 
+  /// Saves the MMU registers and the TLB entries
+  void snapshot_save(Snapshot &snapshot);
+
+  /// Restores the MMU registers and the TLB entries, the micro TLBs start empty
+  void snapshot_restore(Snapshot &snapshot);
+
  public:
 
   // Data members
@@ -160,6 +186,11 @@ class mmu : public DefaultBase, public mmu_if {
   /// iterator for PDC lookup
   std::map<t_VAT, t_PTE_context>::iterator pdciter;
 
+  /// micro TLBs in front of the instruction and data TLB (one shared in shared mode).
+  /// Entries point into itlb/dtlb and are invalidated whenever the entry is removed.
+  t_micro_tlb_entry m_imicro_tlb[MICRO_TLB_SIZE];
+  t_micro_tlb_entry m_dmicro_tlb[MICRO_TLB_SIZE];
+
   /// helper for tlb handling
   t_PTE_context * m_current_PTE_context;
 
@@ -300,6 +331,9 @@ class mmu : public DefaultBase, public mmu_if {
   /// Pseudo random counter for LRU
   uint32_t m_pseudo_rand;
 
+  /// Access stamp for LRU (entry with the smallest stamp is the least recently used)
+  uint64_t m_lru_stamp;
+
   /// Power Monitoring enabled?
   bool m_pow_mon;
 
@@ -315,12 +349,12 @@ class mmu : public DefaultBase, public mmu_if {
   gs::gs_param_array m_performance_counters;
 
   /// Number of TLB hits
-  gs::gs_param<unsigned long long *> tihits;
-  gs::gs_param<unsigned long long *> tdhits;
+  sr_counter_array tihits;
+  sr_counter_array tdhits;
 
   /// Number of TLB misses
-  sr_param<uint64_t> timisses;
-  sr_param<uint64_t> tdmisses;
+  sr_counter timisses;
+  sr_counter tdmisses;
 
 
   // *****************************************************
@@ -369,10 +403,10 @@ class mmu : public DefaultBase, public mmu_if {
   sr_param<double> dyn_itlb_write_energy;
 
   /// Number of itlb reads
-  sr_param<uint64_t> dyn_itlb_reads;
+  sr_counter dyn_itlb_reads;
 
   /// Number of itlb writes
-  sr_param<uint64_t> dyn_itlb_writes;
+  sr_counter dyn_itlb_writes;
 
   /// Parameter array for power output of dtlb
   gs::gs_param_array dtlbram;
@@ -384,10 +418,10 @@ class mmu : public DefaultBase, public mmu_if {
   sr_param<double> dyn_dtlb_write_energy;
 
   /// Number of dtlb reads
-  sr_param<uint64_t> dyn_dtlb_reads;
+  sr_counter dyn_dtlb_reads;
 
   /// Number of dtlb writes
-  sr_param<uint64_t> dyn_dtlb_writes;
+  sr_counter dyn_dtlb_writes;
 
   /// Clock cycle time
   sc_core::sc_time clockcycle;
@@ -62,6 +62,7 @@ mmu_cache_base::mmu_cache_base(
               abstractionLayer), // LT or AT
   snoop(&mmu_cache_base::snoopingCallBack,"snoop"),
   irq("irq"),
+  g_dmi("dmi", false, m_generics),
   m_icen(icen),
   m_dcen(dcen),
   m_dsnoop(dsnoop),
@@ -72,9 +73,14 @@ mmu_cache_base::mmu_cache_base(
   m_cached(cached),
   m_mmu_en(mmu_en),
   m_master_id(hindex),
+  m_dmi(false),
+  m_dmi_last(0),
+  m_dmi_reads("dmi_reads", 0ull, m_counters),
   bus_in_fifo("bus_in_fifo",1),
   m_right_transactions("successful_transactions", 0ull, m_counters),
   m_total_transactions("total_transactions", 0ull, m_counters),
+  m_payload_allocations("payload_allocations", 0ull, m_counters),
+  m_lt_trans(NULL),
   m_pow_mon(pow_mon),
   m_abstractionLayer(abstractionLayer),
   ahb_response_event(),
@@ -140,7 +146,22 @@ mmu_cache_base::mmu_cache_base(
     // Initialize cache control registers
     CACHE_CONTROL_REG = 0;
 
-    SC_THREAD(mem_access);
+    // Write buffer is empty
+    m_wb_drained = SC_ZERO_TIME;
+
+    // LT transactions are issued directly from the processor thread
+    if (m_abstractionLayer == amba::amba_AT) {
+      SC_THREAD(mem_access);
+    }
+
+    // Slaves withdraw DMI regions over the backward path
+    ahb.register_invalidate_direct_mem_ptr(this, &mmu_cache_base::invalidate_direct_mem_ptr);
+
+    g_dmi.add_properties()
+      ("name", "LT DMI reads")
+      ("If true LT reads are served from DMI regions granted by the AHB slaves instead of the bus. "
+       "Writes, locked and debug accesses always use the bus, so snooping is not affected. "
+       "No effect in AT mode.");
 
     // Register power callback functions
     if (m_pow_mon) {
@@ -167,6 +188,11 @@ mmu_cache_base::~mmu_cache_base() {
 
   GC_UNREGISTER_CALLBACKS();
 
+  // Hand the LT payload back to the pool
+  if (m_lt_trans) {
+    m_lt_trans->release();
+  }
+
 }
 
 void mmu_cache_base::dorst() {
@@ -181,8 +207,10 @@ void mmu_cache_base::exec_instr(const unsigned int &addr, unsigned char *ptr, un
 
     ilocalram->mem_read((unsigned int)addr, asi, ptr, 4, &delay, debug, is_dbg, cacheable);
 
-  // Instruction cache access
-  } else {
+  // Instruction cache access, fetches from the line of the last hit are
+  // served by the fetch buffer if the cache is enabled or frozen
+  } else if (is_dbg || (asi <= 3) || (asi == 0x1c) || !(CACHE_CONTROL_REG & 0x1) ||
+             !icache->fetch_buffered((unsigned int)addr, ptr, &delay, debug)) {
 
     icache->mem_read((unsigned int)addr, asi, ptr, 4, &delay, debug, is_dbg, cacheable, false);
 
@@ -199,6 +227,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
     // Simultaneous flush of both caches
     icache->flush(&delay, debug, is_dbg);
     dcache->flush(&delay, debug, is_dbg);
+    code_changed(0, 0);
 
     response = (tlm::TLM_OK_RESPONSE);
 
@@ -579,6 +608,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
       srDebug()("addr", addr)("asi", asi)("ASI write instruction cache tags");
 
       icache->write_cache_tag((unsigned int)addr, (unsigned int*)ptr, &delay);
+      code_changed(0, 0);
       // Set TLM response
       response = (tlm::TLM_OK_RESPONSE);
 
@@ -589,6 +619,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
       srDebug()("addr", addr)("asi", asi)("ASI write instruction cache entry");
 
       icache->write_cache_entry((unsigned int)addr, (unsigned int*)ptr, &delay);
+      code_changed(0, 0);
 
       // Set TLM response
       response = (tlm::TLM_OK_RESPONSE);
@@ -622,6 +653,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
 
       icache->flush(&delay, debug, is_dbg);
       dcache->flush(&delay, debug, is_dbg);
+      code_changed(0, 0);
       // Set TLM response
       response = (tlm::TLM_OK_RESPONSE);
 
@@ -633,6 +665,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
       srDebug()("addr", addr)("asi", asi)("ASI flush instruction chache");
 
       icache->flush(&delay, debug, is_dbg);
+      code_changed(0, 0);
       // Set TLM response
       response = (tlm::TLM_OK_RESPONSE);
 
@@ -655,6 +688,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
       srDebug()("addr", addr)("asi", asi)("ASI flush TLB");
 
       m_mmu->tlb_flush();
+      code_changed(0, 0);
       // Set TLM response
       response = (tlm::TLM_OK_RESPONSE);
 
@@ -675,6 +709,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
           v::debug << name() << "ASI write MMU Control Register" << v::endl;
 
           m_mmu->write_mcr((unsigned int *)ptr);
+          code_changed(0, 0);
           // Set TLM response
           response = (tlm::TLM_OK_RESPONSE);
 
@@ -684,6 +719,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
           srDebug()("addr", addr)("asi", asi)("ASI write MMU Context Table Pointer Register");
 
           m_mmu->write_mctpr((unsigned int*)ptr);
+          code_changed(0, 0);
           // Set TLM response
           response = (tlm::TLM_OK_RESPONSE);
 
@@ -693,6 +729,7 @@ void mmu_cache_base::exec_data(const tlm::tlm_command cmd, const unsigned int &a
           srDebug()("addr", addr)("asi", asi)("ASI write MMU Context Register");
 
           m_mmu->write_mctxr((unsigned int*)ptr);
+          context_changed(*(unsigned int*)ptr);
           // Set TLM response
           response = (tlm::TLM_OK_RESPONSE);
 
@@ -796,24 +833,44 @@ void mmu_cache_base::mem_write(unsigned int addr, unsigned int asi, unsigned cha
                           unsigned int length, sc_core::sc_time * delay,
                           unsigned int * debug, bool is_dbg, bool &cacheable, bool is_lock) {
 
-  // Allocate new transaction (reference counter = 1)
-  tlm::tlm_generic_payload * trans = ahb.get_transaction();
+  // LT accesses reuse one payload, all others allocate a new transaction
+  // (reference counter = 1)
+  tlm::tlm_generic_payload * trans = (!is_dbg && m_abstractionLayer == amba::amba_LT) ?
+                                     lt_payload() : acquire_payload();
 
   srDebug()("pointer", reinterpret_cast<size_t>(trans))("refcount", trans->get_ref_count())("Allocate new transaction (mem_write) Acquire / Ref-Count");
 
-  // Copy payload data
-  memcpy(write_buf + wb_pointer, data, length);
-
   // Initialize transaction
   trans->set_command(tlm::TLM_WRITE_COMMAND);
   trans->set_address(addr);
   trans->set_data_length(length);
-  trans->set_data_ptr(write_buf + wb_pointer);
   trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
-  wb_pointer = (wb_pointer + length) % 256;
+  if (!is_dbg && m_abstractionLayer == amba::amba_LT) {
 
-  if (!is_dbg) {
+    if (is_lock) {
+      ahb.validate_extension<amba::amba_lock>(*trans);
+    } else {
+      ahb.invalidate_extension<amba::amba_lock>(*trans);
+    }
+
+    // The transaction completes within b_transport, no copy is needed
+    trans->set_data_ptr(data);
+
+    // The write buffer holds one store. The processor only stalls if the
+    // previous store has not left the buffer yet, the bus latency of this
+    // store is charged to the following access.
+    wb_stall(delay);
+    sc_core::sc_time wb_delay = *delay;
+    ahbaccess_lt(trans, &wb_delay);
+    m_wb_drained = sc_core::sc_time_stamp() + wb_delay;
+
+  } else if (!is_dbg) {
+
+    // Copy payload data
+    memcpy(write_buf + wb_pointer, data, length);
+    trans->set_data_ptr(write_buf + wb_pointer);
+    wb_pointer = (wb_pointer + length) % 256;
 
     if (is_lock) {
       ahb.validate_extension<amba::amba_lock>(*trans);
@@ -831,6 +888,7 @@ void mmu_cache_base::mem_write(unsigned int addr, unsigned int asi, unsigned cha
   } else {
 
     // Debug transport
+    trans->set_data_ptr(data);
     ahbaccess_dbg(trans);
 
   }
@@ -849,8 +907,20 @@ bool mmu_cache_base::mem_read(unsigned int addr, unsigned int asi, unsigned char
 
   bool cacheable_local = true;
 
-  // Allocate new transaction (reference counter = 1)
-  tlm::tlm_generic_payload * trans = ahb.get_transaction();
+  // LT: Reads from a granted DMI region do not need a transaction
+  if (m_dmi && !is_dbg && !is_lock && m_abstractionLayer == amba::amba_LT &&
+      dmi_read(addr, data, length, delay, cacheable)) {
+
+    if ((m_cached != 0))  {
+      cacheable_local = (m_cached & (1 << (addr >> 28))) ? true : false;
+    }
+    return cacheable_local && cacheable;
+  }
+
+  // LT accesses reuse one payload, all others allocate a new transaction
+  // (reference counter = 1)
+  tlm::tlm_generic_payload * trans = (!is_dbg && m_abstractionLayer == amba::amba_LT) ?
+                                     lt_payload() : acquire_payload();
 
   srDebug()("pointer", reinterpret_cast<size_t>(trans))("refcount", trans->get_ref_count())("Allocate new transaction (mem_read) Acquire / Ref-Count");
 
@@ -869,18 +939,37 @@ bool mmu_cache_base::mem_read(unsigned int addr, unsigned int asi, unsigned char
       ahb.invalidate_extension<amba::amba_lock>(*trans);
     }
 
-    srDebug()("pointer", reinterpret_cast<size_t>(trans))("fifo_level", bus_in_fifo.used())("Schedule transaction (READ)");
-    srDebug()("pointer", reinterpret_cast<size_t>(trans))("refcount", trans->get_ref_count())("Acquire / Ref-Count before (bus_in_fifo)");
-    trans->acquire();
-    bus_in_fifo.put(trans);
-    srDebug()("pointer", reinterpret_cast<size_t>(trans))("fifo_level", bus_in_fifo.used())("Done sheduling transaction (READ)");
+    if (m_abstractionLayer == amba::amba_LT) {
+
+      // Reads are not passing buffered stores
+      wb_stall(delay);
+      // The reused payload still carries the answer of the last slave
+      ahb.invalidate_extension<amba::amba_cacheable>(*trans);
+      trans->set_dmi_allowed(false);
+      ahbaccess_lt(trans, delay);
+
+    } else {
+
+      srDebug()("pointer", reinterpret_cast<size_t>(trans))("fifo_level", bus_in_fifo.used())("Schedule transaction (READ)");
+      srDebug()("pointer", reinterpret_cast<size_t>(trans))("refcount", trans->get_ref_count())("Acquire / Ref-Count before (bus_in_fifo)");
+      trans->acquire();
+      bus_in_fifo.put(trans);
+      srDebug()("pointer", reinterpret_cast<size_t>(trans))("fifo_level", bus_in_fifo.used())("Done sheduling transaction (READ)");
+
+      // Read misses are blocking the cache !!
+      wait(bus_read_completed);
+      srDebug()("pointer", reinterpret_cast<size_t>(trans))("fifo_level", bus_in_fifo.used())("Done transaction (READ) / bus_read_completed event");
 
-    // Read misses are blocking the cache !!
-    wait(bus_read_completed);
-    srDebug()("pointer", reinterpret_cast<size_t>(trans))("fifo_level", bus_in_fifo.used())("Done transaction (READ) / bus_read_completed event");
+    }
     // cacheable handling!!!
     cacheable = (ahb.get_extension<amba::amba_cacheable>(*trans)) ? true : false;
 
+    // The slave offers a DMI region for the following reads
+    if (m_dmi && m_abstractionLayer == amba::amba_LT && trans->is_dmi_allowed() &&
+        trans->get_response_status() == tlm::TLM_OK_RESPONSE) {
+      dmi_request(trans, addr, length, cacheable);
+    }
+
     // Check cacheability
     //if ((m_cached != 0) && (cacheable))  {
     if ((m_cached != 0))  {
@@ -901,7 +990,153 @@ bool mmu_cache_base::mem_read(unsigned int addr, unsigned int asi, unsigned char
 
 }
 
-// Thread for serializing memory access
+// Takes a payload from the AHB socket pool and accounts the ones never seen before
+tlm::tlm_generic_payload * mmu_cache_base::acquire_payload() {
+
+  tlm::tlm_generic_payload * trans = ahb.get_transaction();
+
+  // Recycling keeps extensions set with set_extension, so an untagged
+  // payload is one the pool has just allocated
+  if (!trans->get_extension<pool_tag_extension>()) {
+    trans->set_extension(new pool_tag_extension());
+    m_payload_allocations++;
+  }
+  return trans;
+}
+
+// LT: The payload is taken from the pool on first use and kept by this
+// module. Each access holds one more reference and releases it when done,
+// all fields and the lock extension are set again for every access.
+tlm::tlm_generic_payload * mmu_cache_base::lt_payload() {
+
+  if (!m_lt_trans) {
+    m_lt_trans = acquire_payload();
+  }
+  m_lt_trans->acquire();
+  return m_lt_trans;
+}
+
+// LT: Blocking transport in the calling thread. The bus delay is added to the
+// local time offset in delay instead of being consumed with wait.
+void mmu_cache_base::ahbaccess_lt(tlm::tlm_generic_payload * trans, sc_core::sc_time * delay) {
+
+  srDebug()("pointer", reinterpret_cast<size_t>(trans))("addr", trans->get_address())("LT transaction issued to AHB");
+  msclogger::forward(this, &ahb, trans, tlm::BEGIN_REQ);
+  ahb->b_transport(*trans, *delay);
+
+  if (trans->get_response_status() != tlm::TLM_OK_RESPONSE) {
+    response_error = true;
+  }
+  if (trans->is_read()) {
+    response_callback(trans);
+  }
+}
+
+// LT: Stalls the access until the write buffer is empty
+void mmu_cache_base::wb_stall(sc_core::sc_time * delay) {
+
+  sc_core::sc_time now = sc_core::sc_time_stamp() + *delay;
+  if (m_wb_drained > now) {
+    *delay += m_wb_drained - now;
+  }
+}
+
+// LT: Returns the DMI region covering [addr, addr + length), the last hit
+// is tried before the binary search
+const mmu_cache_base::dmi_region * mmu_cache_base::dmi_find(unsigned int addr, unsigned int length) {
+
+  if (m_dmi_regions.empty()) {
+    return NULL;
+  }
+
+  sc_dt::uint64 end = static_cast<sc_dt::uint64>(addr) + length - 1;
+  const dmi_region * region = &m_dmi_regions[m_dmi_last];
+  if (addr < region->dmi.get_start_address() || end > region->dmi.get_end_address()) {
+
+    // Binary search for the last region starting at or below addr
+    size_t lower = 0;
+    size_t upper = m_dmi_regions.size();
+    while (lower < upper) {
+      size_t middle = (lower + upper) >> 1;
+      if (m_dmi_regions[middle].dmi.get_start_address() <= addr) {
+        lower = middle + 1;
+      } else {
+        upper = middle;
+      }
+    }
+    if (lower == 0 || end > m_dmi_regions[lower - 1].dmi.get_end_address()) {
+      return NULL;
+    }
+    m_dmi_last = lower - 1;
+    region = &m_dmi_regions[m_dmi_last];
+  }
+  return region;
+}
+
+// LT: Copies the data from the DMI region covering the access. The delay is
+// the one of an idle bus: one arbitration cycle, one cycle per word and the
+// read latency of the slave.
+bool mmu_cache_base::dmi_read(unsigned int addr, unsigned char * data, unsigned int length,
+                              sc_core::sc_time * delay, bool &cacheable) {
+
+  const dmi_region * region = dmi_find(addr, length);
+  if (!region) {
+    return false;
+  }
+
+  // Reads are not passing buffered stores
+  wb_stall(delay);
+  memcpy(data, region->dmi.get_dmi_ptr() + (addr - region->dmi.get_start_address()), length);
+  unsigned int words = (length < 4) ? 1 : (length >> 2);
+  *delay += clock_cycle * (words + 1) + region->dmi.get_read_latency();
+  cacheable = region->cacheable;
+  m_dmi_reads++;
+  return true;
+}
+
+// LT: Requests the DMI region around a completed bus read and replaces all
+// regions it overlaps
+void mmu_cache_base::dmi_request(tlm::tlm_generic_payload * trans, unsigned int addr,
+                                 unsigned int length, bool cacheable) {
+
+  dmi_region region;
+  region.cacheable = cacheable;
+  if (!ahb->get_direct_mem_ptr(*trans, region.dmi) || !region.dmi.is_read_allowed() ||
+      !region.dmi.get_dmi_ptr()) {
+    return;
+  }
+  // The region has to cover the access which made it known
+  if (region.dmi.get_start_address() > addr ||
+      region.dmi.get_end_address() < static_cast<sc_dt::uint64>(addr) + length - 1) {
+    return;
+  }
+
+  invalidate_direct_mem_ptr(region.dmi.get_start_address(), region.dmi.get_end_address());
+  std::vector<dmi_region>::iterator pos = m_dmi_regions.begin();
+  while (pos != m_dmi_regions.end() && pos->dmi.get_start_address() < region.dmi.get_start_address()) {
+    pos++;
+  }
+  m_dmi_last = pos - m_dmi_regions.begin();
+  m_dmi_regions.insert(pos, region);
+
+  srDebug()("start", region.dmi.get_start_address())("end", region.dmi.get_end_address())("DMI region granted");
+}
+
+// DMI backward path, only the regions overlapping the range are dropped
+void mmu_cache_base::invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range) {
+
+  std::vector<dmi_region>::iterator region = m_dmi_regions.begin();
+  while (region != m_dmi_regions.end()) {
+    if (region->dmi.get_start_address() <= end_range && region->dmi.get_end_address() >= start_range) {
+      region = m_dmi_regions.erase(region);
+    } else {
+      region++;
+    }
+  }
+  m_dmi_last = 0;
+}
+
+// Thread for serializing memory access (AT only)
 void mmu_cache_base::mem_access() {
 
   tlm::tlm_generic_payload * trans;
@@ -918,7 +1153,7 @@ void mmu_cache_base::mem_access() {
       ahbaccess(trans);
       srDebug()("pointer", reinterpret_cast<size_t>(trans))("addr", trans->get_address())("Transaction returned from AHB");
 
-      if (m_abstractionLayer == amba::amba_AT) wait(ahb_response_event);
+      wait(ahb_response_event);
       if (trans->is_read()) bus_read_completed.notify();
 
       // Decrement ref counter
@@ -962,6 +1197,7 @@ void mmu_cache_base::write_ccr(unsigned char * data, unsigned int len,
     // [FI] icache flush (do not set; always reads as zero)
     if (tmp & (1 << 21)) {
         icache->flush(delay, debug, is_dbg);
+        code_changed(0, 0);
     }
     // [IB] instruction burst fetch (todo)
     if (tmp & (1 << 16)) {
@@ -1004,6 +1240,20 @@ unsigned int mmu_cache_base::read_ccr(bool internal) {
   return (tmp);
 }
 
+// True if the MMU is enabled and translates addresses
+bool mmu_cache_base::mmu_translating() {
+  if (!m_mmu_en) {
+    return false;
+  }
+  unsigned int mmu_ctrl = m_mmu->read_mcr();
+
+  #ifdef LITTLE_ENDIAN_BO
+  swap_Endianess(mmu_ctrl);
+  #endif
+
+  return mmu_ctrl & 0x1;
+}
+
 // Snooping function
 void mmu_cache_base::snoopingCallBack(const t_snoop& snoop, const sc_core::sc_time& delay) {
 
@@ -1011,6 +1261,17 @@ void mmu_cache_base::snoopingCallBack(const t_snoop& snoop, const sc_core::sc_ti
   // Make sure we are not snooping ourself ;)
   if (snoop.master_id != m_master_id) {
 
+    // Other masters may overwrite code. The snooped address is physical,
+    // the pre-decoded code is tracked by virtual PC, so with the MMU
+    // translating all of it has to go.
+    if (snoop.length) {
+      if (mmu_translating()) {
+        code_changed(0, 0);
+      } else {
+        code_changed(snoop.address, snoop.length);
+      }
+    }
+
     // If dcache and snooping enabled
     if (m_dcen && m_dsnoop) {
 
@@ -1019,8 +1280,26 @@ void mmu_cache_base::snoopingCallBack(const t_snoop& snoop, const sc_core::sc_ti
   }
 }
 
+// Snoop filter
+bool mmu_cache_base::snoop_relevant(const t_snoop &snoop) {
+  if (snoop.master_id == m_master_id || !snoop.length) {
+    return false;
+  }
+  // The pre-decoded code is tracked by virtual PC, with the MMU translating
+  // the physical snoop address can not be looked up (see snoopingCallBack)
+  bool code = mmu_translating()? code_cached(0, 0) : code_cached(snoop.address, snoop.length);
+  return code || (m_dcen && m_dsnoop && dcache->snoop_present(snoop.address, snoop.length));
+}
+
 
 // Automatically called at the beginning of the simulation
+// Caches parameters used on every bus access
+void mmu_cache_base::end_of_elaboration() {
+
+  m_dmi = g_dmi;
+
+}
+
 void mmu_cache_base::start_of_simulation() {
 
   // Initialize power model
@@ -1080,6 +1359,7 @@ void mmu_cache_base::end_of_simulation() {
     v::report << name() << " * --------------------- " << v::endl;
     v::report << name() << " * Successful Transactions: " << m_right_transactions << v::endl;
     v::report << name() << " * Total Transactions: " << m_total_transactions << v::endl;
+    v::report << name() << " * Payload Allocations: " << m_payload_allocations << v::endl;
     v::report << name() << " * " << v::endl;
     v::report << name() << " * AHB Master interface reports: " << v::endl;
     print_transport_statistics(name());
@@ -1121,4 +1401,12 @@ void mmu_cache_base::clkcng() {
       ilocalram->clkcng(clock_cycle);
     }
 }
+
+void mmu_cache_base::snapshot_save(Snapshot &snapshot) {
+  snapshot.put("cache_control", CACHE_CONTROL_REG);
+}
+
+void mmu_cache_base::snapshot_restore(Snapshot &snapshot) {
+  snapshot.get("cache_control", CACHE_CONTROL_REG);
+}
 /// @}
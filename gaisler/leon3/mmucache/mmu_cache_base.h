@@ -24,6 +24,7 @@
 //#include <tlm_1/tlm_req_rsp/tlm_channels/tlm_fifo/tlm_fifo.h>
 
 #include <math.h>
+#include <vector>
 
 #include "gaisler/leon3/mmucache/icio_payload_extension.h"
 #include "gaisler/leon3/mmucache/dcio_payload_extension.h"
@@ -32,6 +33,7 @@
 #include "core/common/sr_signal.h"
 #include "amba/ahbmaster.h"
 #include "core/base/clkdevice.h"
+#include "core/base/snapshot.h"
 
 #include "core/base/verbose.h"
 #include "gaisler/leon3/mmucache/cache_if.h"
@@ -45,11 +47,22 @@
 /// @addtogroup mmu_cache MMU_Cache
 /// @{
 
+/// Tags the payloads of the AHB socket pool that were already counted
+class pool_tag_extension : public tlm::tlm_extension<pool_tag_extension> {
+  public:
+    tlm::tlm_extension_base *clone() const {
+      return new pool_tag_extension();
+    }
+    void copy_from(const tlm::tlm_extension_base &extension) {}
+};
+
 /// Top-level class of the memory sub-system for the TrapGen LEON3 simulator
 class mmu_cache_base :
   public AHBMaster<>,
   public mmu_cache_if,
-  public CLKDevice {
+  public CLKDevice,
+  public SnapshotDevice,
+  public snoop_filter_if {
 
  public:
 
@@ -150,9 +163,29 @@ class mmu_cache_base :
   /// Read the cache control register
   virtual unsigned int read_ccr(bool internal);
 
+  /// True if the MMU is enabled and translates addresses
+  bool mmu_translating();
+
   /// Snooping function (For calling dcache->snoop_invalidate)
   void snoopingCallBack(const t_snoop& snoop, const sc_core::sc_time& delay);
 
+  /// Snoop filter: False if the snoop changes neither the dcache nor the pre-decoded code
+  bool snoop_relevant(const t_snoop &snoop);
+
+  /// Code in [addr, addr + len) might have changed (len == 0: all code).
+  /// Lets the ISS drop pre-decoded instructions.
+  virtual void code_changed(unsigned int addr, unsigned int len) {}
+
+  /// True if the ISS holds pre-decoded instructions from [addr, addr + len)
+  /// (len == 0: any pre-decoded instructions)
+  virtual bool code_cached(unsigned int addr, unsigned int len) { return false; }
+
+  /// The MMU context changed (raw value written to the context register)
+  virtual void context_changed(unsigned int context) {}
+
+  /// Automatically called at the end of elaboration
+  void end_of_elaboration();
+
   /// Automatically called at the beginning of the simulation
   void start_of_simulation();
 
@@ -177,9 +210,18 @@ class mmu_cache_base :
   /// Deal with clock changes
   void clkcng();
 
+  /// Stores the cache control register, caches and mmu save themselves
+  void snapshot_save(Snapshot &snapshot);
+
+  /// Restores the cache control register
+  void snapshot_restore(Snapshot &snapshot);
+
   /// Return clock period (for ahb interface)
   sc_core::sc_time get_clock();
 
+  /// DMI backward path: drops all regions overlapping [start_range, end_range]
+  void invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range);
+
   // data members
   // ------------
 
@@ -194,6 +236,9 @@ class mmu_cache_base :
   /// data scratchpad pointer
   localram * dlocalram;
 
+  /// LT: Serve reads from DMI regions granted by the AHB slaves
+  sr_param<bool> g_dmi;
+
  protected:
 
   // CACHE CONTROL REGISTER
@@ -233,8 +278,46 @@ class mmu_cache_base :
   /// amba master id
   unsigned int m_master_id;
 
+  /// Thread serializing the bus accesses of the AT abstraction layer
   void mem_access();
 
+  /// LT: Issues trans with b_transport in the calling thread, the bus delay
+  /// is added to the local time offset delay
+  void ahbaccess_lt(tlm::tlm_generic_payload * trans, sc_core::sc_time * delay);
+
+  /// LT: Adds the time until the write buffer is empty to delay
+  void wb_stall(sc_core::sc_time * delay);
+
+  /// Read-only DMI region granted by an AHB slave
+  struct dmi_region {
+    tlm::tlm_dmi dmi;
+    /// Cacheability reported by the read that led to the grant
+    bool cacheable;
+  };
+
+  /// LT: Region covering [addr, addr + length), NULL if there is none
+  const dmi_region * dmi_find(unsigned int addr, unsigned int length);
+
+  /// LT: Reads [addr, addr + length) from a DMI region, false if no region covers it
+  bool dmi_read(unsigned int addr, unsigned char * data, unsigned int length,
+                sc_core::sc_time * delay, bool &cacheable);
+
+  /// LT: Asks for a DMI region after trans was read over the bus
+  void dmi_request(tlm::tlm_generic_payload * trans, unsigned int addr,
+                   unsigned int length, bool cacheable);
+
+  /// Copy of g_dmi, read on every bus access
+  bool m_dmi;
+
+  /// DMI regions sorted by start address, they never overlap
+  std::vector<dmi_region> m_dmi_regions;
+
+  /// Index of the last region hit in m_dmi_regions
+  size_t m_dmi_last;
+
+  /// Number of reads served from DMI regions
+  sr_counter m_dmi_reads;
+
   unsigned char write_buf[1024];
   unsigned int wb_pointer;
 
@@ -243,10 +326,23 @@ class mmu_cache_base :
   tlm::tlm_fifo<tlm::tlm_generic_payload *> bus_in_fifo;
 
   /// Total number of successful transactions for execution statistics 
-  sr_param<uint64_t> m_right_transactions;
+  sr_counter m_right_transactions;
 
   /// Total number of transactions for execution statistics
-  sr_param<uint64_t> m_total_transactions;
+  sr_counter m_total_transactions;
+
+  /// Number of bus payloads the AHB socket pool had to allocate. Payloads
+  /// are recycled, so this stays constant once the pool is warmed up.
+  sr_counter m_payload_allocations;
+
+  /// LT: Payload of all non-debug bus accesses, reset in place
+  tlm::tlm_generic_payload * m_lt_trans;
+
+  /// Takes a recycled payload from the AHB socket pool
+  tlm::tlm_generic_payload * acquire_payload();
+
+  /// LT: Returns m_lt_trans with one more reference for the next access
+  tlm::tlm_generic_payload * lt_payload();
 
   /// power monitoring enabled
   bool m_pow_mon;
@@ -257,6 +353,9 @@ class mmu_cache_base :
   /// begin response signal for AT
   sc_event ahb_response_event;
 
+  /// LT: Time at which the last buffered store has left the write buffer
+  sc_core::sc_time m_wb_drained;
+
   // ****************************************************
   // Power Modeling Parameters
 
@@ -291,10 +390,10 @@ class mmu_cache_base :
   sr_param<double> dyn_write_energy;
 
   /// Number of reads from memory (read & reset by monitor)
-  sr_param<uint64_t> dyn_reads;
+  sr_counter dyn_reads;
 
   /// Number of writes to memory (read & reset by monitor)
-  sr_param<uint64_t> dyn_writes;    
+  sr_counter dyn_writes;    
 
   uint64_t globl_count;
   
@@ -123,6 +123,21 @@ void nocache::snoop_invalidate(const t_snoop& snoop, const sc_core::sc_time& del
 
 }
 
+// dummy snoop filter
+bool nocache::snoop_present(unsigned int address, unsigned int length) {
+
+  return false;
+
+}
+
+// dummy fetch buffer
+bool nocache::fetch_buffered(unsigned int address, unsigned char *data,
+                             sc_core::sc_time *t, unsigned int *debug) {
+
+  return false;
+
+}
+
 // Helper for setting clock cycle latency using sc_clock argument
 void nocache::clkcng(sc_core::sc_time &clk) {
   // nothing to do
@@ -65,6 +65,13 @@ class nocache : public DefaultBase, public cache_if {
 	/// dummy snooping function
 	virtual void snoop_invalidate(const t_snoop& snoop, const sc_core::sc_time& delay);
 
+	/// dummy snoop filter (nothing is cached)
+	virtual bool snoop_present(unsigned int address, unsigned int length);
+
+	/// dummy fetch buffer (nothing is buffered)
+	virtual bool fetch_buffered(unsigned int address, unsigned char *data,
+	                            sc_core::sc_time *t, unsigned int *debug);
+
 	/// Helper functions for definition of clock cycle
 	void clkcng(sc_core::sc_time &clk);
 
@@ -14,6 +14,8 @@
 /// @author Thomas Schuster
 ///
 
+#include <algorithm>
+
 #include "gaisler/leon3/mmucache/vectorcache.h"
 
 
@@ -35,6 +37,11 @@ vectorcache::vectorcache(ModuleName name,
     sc_module(name),
     m_mmu_cache(_mmu_cache),
     m_tlb_adaptor(_tlb_adaptor),
+    m_line_observers(0),
+    m_fetch_line(NULL),
+    m_fetch_address(0),
+    m_fetch_way(0),
+    m_fetch_data(NULL),
     m_burst_en(burst_en),
     m_new_linefetch_en(new_linefetch_en),
     m_pseudo_rand(0),
@@ -101,24 +108,13 @@ vectorcache::vectorcache(ModuleName name,
     }
 
     // Create the cache sets
+    // Tags and data are plain arrays. The scireg views on the lines are only
+    // created when a tool asks for them (see create_line_views).
     srDebug()("Creating cache memory");
-    //cache_mem = new std::vector<t_cache_line>(m_number_of_vectors*sets);
-    cache_mem = new std::vector<t_cache_line*>();
-    mapped_regions = new std::vector<scireg_ns::scireg_mapped_region*>();
-    for (uint32_t i = 0; i < m_number_of_vectors*sets; i++) {
-      char *buffer = new char[11];
-      snprintf(buffer, 11, "line_%d", i);
-
-      t_cache_line *line = new t_cache_line(*this, buffer, linesize);
-//      srInfo()("name", buffer)("line created");
-      cache_mem->push_back(line);
-
-      scireg_ns::scireg_mapped_region *mapped_region = new scireg_ns::scireg_mapped_region();
-      mapped_region->region = line;
-      mapped_region->offset = i*32;
-      mapped_region->name = buffer;
-      mapped_regions->push_back(mapped_region);
-    }
+    t_cache_tag empty_tag = {0, 0, 0, 0, 0};
+    m_tags.assign(m_number_of_vectors * sets, empty_tag);
+    m_data.assign(m_number_of_vectors * sets * linesize, 0);
+    m_presence.assign(PRESENCE_REGIONS, 0);
 
 
     // Configuration report
@@ -193,14 +189,7 @@ vectorcache::vectorcache(ModuleName name,
 
 /// Destructor
 vectorcache::~vectorcache() {
-  for (std::vector<t_cache_line*>::iterator it = cache_mem->begin() ; it != cache_mem->end(); ++it) {
-    delete (*it);
-  }
-  for (std::vector<scireg_ns::scireg_mapped_region*>::iterator it = mapped_regions->begin() ; it != mapped_regions->end(); ++it) {
-    delete (*it);
-  }
-  delete cache_mem;
-  delete mapped_regions;
+  destroy_line_views();
 
 } // vectorcache::~vectorcache()
 
@@ -239,6 +228,9 @@ bool vectorcache::mem_read(unsigned int address, unsigned int asi, unsigned char
   // Data for refilling a cache line of maximum size
   unsigned char ahb_data[32];
 
+  // Any lookup may change the replacement state, the buffered line is refilled on a hit
+  fetch_buffer_invalidate();
+
   /// --------------------------------------------------------------------------
   /// !Bypass MMU && (Enabled || Frozen): Search cache
 
@@ -267,7 +259,8 @@ bool vectorcache::mem_read(unsigned int address, unsigned int asi, unsigned char
         ("offset", offset)
         ("byt", byt)
         ("read");
-      (*lookup_line(idx, cache_hit))->entry.copy_from(data, len, offset >> 2, byt);
+      memcpy(data, lookup_data(idx, cache_hit) + offset, len);
+      notify_line(idx, cache_hit, scireg_ns::SCIREG_READ_ACCESS, offset, len);
 
 
       // Update flags
@@ -282,9 +275,12 @@ bool vectorcache::mem_read(unsigned int address, unsigned int asi, unsigned char
       if (m_pow_mon) dyn_data_reads += (len - 1) >> 2;
 
       // Update debug information
-      rhits[cache_hit] = rhits[cache_hit].getValue() + 1;
+      rhits[cache_hit]++;
       CACHEREADHIT_SET(*debug, cache_hit);
 
+      // Following fetches from this line are served by the fetch buffer
+      fetch_buffer_fill(address, idx, cache_hit);
+
     /// ------------------------------------------------------------------------
     /// Forced miss || !In cache: Read from memory
     } else {
@@ -370,6 +366,10 @@ bool vectorcache::mem_read(unsigned int address, unsigned int asi, unsigned char
       rmisses++;
       CACHEREADMISS_SET(*debug, cache_hit);
 
+      if (cache_hit != -1) {
+        fetch_buffer_fill(address, idx, cache_hit);
+      }
+
     } // Cache miss
 
   /// --------------------------------------------------------------------------
@@ -457,7 +457,7 @@ void vectorcache::mem_write(unsigned int address, unsigned int asi, unsigned cha
                               data, delay, debug, cacheable, is_dbg);
 
       // Update debug information
-      whits[cache_hit] = whits[cache_hit].getValue() + 1;
+      whits[cache_hit]++;
       CACHEWRITEHIT_SET(*debug, cache_hit);
 
     } // Cache hit
@@ -541,19 +541,16 @@ void vectorcache::read_cache_tag(unsigned int address, unsigned int * data,
   unsigned way = get_tag(address) & 0x3;
 
   // find the required cache line
-  t_cache_line* line = (*lookup_line(idx, way));
+  t_cache_tag &line = lookup_tag(idx, way);
 
   // build bitmask from tag fields
   // (! The atag field starts bit 10. It is not MSB aligned as in the actual tag layout.)
-  uint32_t tmp_valid;
-  line->tag[t_cache_line::VALID].bus_read(tmp_valid);
+  tmp = line.atag << 10;
+  tmp |= line.lrr << 9;
+  tmp |= line.lock << 8;
+  tmp |= line.valid;
 
-  tmp = line->tag[t_cache_line::ATAG].bus_read() << 10;
-  tmp |= line->tag[t_cache_line::LRR].bus_read() << 9;
-  tmp |= line->tag[t_cache_line::LOCK].bus_read() << 8;
-  tmp |= tmp_valid;
-
-  srDebug()("tag", line->tag[t_cache_line::ATAG])
+  srDebug()("tag", line.atag)
            ("idx", idx)
            ("way", way)
            ("Diagnostic read cache tag");
@@ -593,23 +590,28 @@ void vectorcache::write_cache_tag(unsigned int address, unsigned int * data,
   unsigned way = get_tag(address) & 0x3;
 
   // find the required cache line
-  t_cache_line* line = (*lookup_line(idx, way));
+  t_cache_tag &line = lookup_tag(idx, way);
+
+  presence_remove(line, idx);
+  fetch_buffer_invalidate();
 
   // update the tag with write data
   // (! The atag field is expected to start at bit 10. Not MSB aligned as in tag layout.)
-  line->tag[t_cache_line::ATAG].bus_write( *data >> 10);
-  line->tag[t_cache_line::LRR].bus_write((*data & 0x100) >> 9);
+  line.atag = *data >> 10;
+  line.lrr = (*data & 0x100) >> 9;
   // lock bit can only be set, if line locking is enabled
   // locking only works in multi-way configurations. the last way must never be locked.
-  line->tag[t_cache_line::LOCK].bus_write(((m_setlock) && (way != m_sets))? ((*data & 0x100) >> 8) : 0);
-  line->tag[t_cache_line::VALID].bus_write((*data & 0xff));
+  line.lock = ((m_setlock) && (way != m_sets))? ((*data & 0x100) >> 8) : 0;
+  line.valid = (*data & 0xff);
+
+  presence_add(line, idx);
 
-  srDebug()("tag", line->tag[t_cache_line::ATAG])
+  srDebug()("tag", line.atag)
            ("idx", idx)
            ("way", way)
-           ("lrr", line->tag[t_cache_line::LRR])
-           ("lock", line->tag[t_cache_line::LOCK])
-           ("valid", line->tag[t_cache_line::VALID])
+           ("lrr", line.lrr)
+           ("lock", line.lock)
+           ("valid", line.valid)
            ("Diagnostic write cache tag");
 
   // increment time
@@ -634,9 +636,8 @@ void vectorcache::read_cache_entry(unsigned int address, unsigned int * data,
   unsigned way = get_tag(address) & 0x3;
 
   // find the required cache line
-  t_cache_line* line = (*lookup_line(idx, way));
-
-  *data = line->entry.get_int(sb);
+  memcpy(data, lookup_data(idx, way) + (sb << 2), 4);
+  notify_line(idx, way, scireg_ns::SCIREG_READ_ACCESS, sb << 2, 4);
 
   srDebug()("idx", idx)
            ("subblock", sb)
@@ -666,9 +667,8 @@ void vectorcache::write_cache_entry(unsigned int address, unsigned int * data,
   unsigned way = get_tag(address) & 0x3;
 
   // find the required cache line
-  t_cache_line* line = (*lookup_line(idx, way));
-
-  line->entry.set_int(sb, *data);
+  memcpy(lookup_data(idx, way) + (sb << 2), data, 4);
+  notify_line(idx, way, scireg_ns::SCIREG_WRITE_ACCESS, sb << 2, 4);
 
   srDebug()("idx", idx)
            ("subblock", sb)
@@ -691,35 +691,37 @@ void vectorcache::flush(sc_core::sc_time *t, unsigned int * debug, bool is_dbg)
 //  bool cacheable = true;
 
   // for all cache lines
-  for (std::vector<t_cache_line*>::iterator line = cache_mem->begin();
-       line < cache_mem->end(); line++, i_line++) {
+  for (std::vector<t_cache_tag>::iterator line = m_tags.begin();
+       line < m_tags.end(); line++, i_line++) {
 
 // it's a write-through cache. we should never need the following code
 /*    for (unsigned entry = 0; entry < m_wordsperline; entry++) {
 
       // check for valid data
-      if ((*line)->tag.dirty && (*line)->tag[t_cache_line::VALID] & (1 << entry)) {
+      if (line->valid & (1 << entry)) {
 
         // construct address from tag
-        addr = ((*line)->tag[t_cache_line::ATAG] << (m_idx_bits + m_offset_bits));
-        addr |= ((i_line/(m_sets+1)) << m_offset_bits);
+        addr = (line->atag << (m_idx_bits + m_offset_bits));
+        addr |= ((i_line % m_number_of_vectors) << m_offset_bits);
         addr |= (entry << 2);
 
         srDebug()("addr", addr)
                  ("line", i_line)
-                 ("idx", i_line/(m_sets+1))
-                 ("way", i_line%(m_sets+1))
-                 ("data", (*line)->entry.get_int(entry))
+                 ("idx", i_line % m_number_of_vectors)
+                 ("way", i_line / m_number_of_vectors)
                  ("Cache flush");
 
-        m_tlb_adaptor->mem_write(addr, 0x8,(unsigned char*)&((*line)->entry.get_int(entry)),
+        m_tlb_adaptor->mem_write(addr, 0x8,
+                                 lookup_data(i_line % m_number_of_vectors, i_line / m_number_of_vectors) + (entry << 2),
                                  4, t, debug, is_dbg, cacheable, false);
 
       }
     }*/
     // invalidate all entries
-    (*line)->tag[t_cache_line::VALID].bus_write(0);
+    line->valid = 0;
   }
+  m_presence.assign(PRESENCE_REGIONS, 0);
+  fetch_buffer_invalidate();
 
   // Update debug information
   CACHEFLUSH_SET(*debug);
@@ -733,41 +735,130 @@ void vectorcache::flush(sc_core::sc_time *t, unsigned int * debug, bool is_dbg)
 void vectorcache::snoop_invalidate(const t_snoop& snoop, const sc_core::sc_time& delay) {
 
   unsigned address;
+  unsigned last;
   unsigned tag;
   unsigned idx;
-  unsigned offset;
+  unsigned first_word;
+  unsigned last_word;
+  unsigned mask;
   unsigned way;
 
-  // Is the cache enabled
-  if (check_mode() & 0x3) {
+  // Is the cache enabled and may it hold any line of the written range
+  if ((check_mode() & 0x3) && snoop_present(snoop.address, snoop.length)) {
+
+    last = snoop.address + snoop.length - 1;
+    fetch_buffer_invalidate();
 
-    for (address = snoop.address; address < snoop.address + snoop.length; address += 4) {
+    // Invalidate line by line
+    for (address = snoop.address & ~(m_bytesperline - 1); ; address += m_bytesperline) {
       // Extract index and tag from address
       tag    = get_tag(address);
       idx    = get_idx(address);
-      offset = get_offset(address);
-      way    = 0;
 
-      for (std::vector<t_cache_line*>::iterator line = lookup_line(idx, 0);
-           way <= m_sets; line++, way++) {
+      // Valid bits of the words written in this line
+      first_word = (address < snoop.address)? get_offset(snoop.address) >> 2 : 0;
+      last_word  = (last - address < m_bytesperline)? get_offset(last) >> 2 : m_wordsperline - 1;
+      mask = ((2u << last_word) - 1) & ~((1u << first_word) - 1);
+
+      for (way = 0; way <= m_sets; way++) {
+        t_cache_tag &line = lookup_tag(idx, way);
 
         // Check the cache tag
-        if (((*line)->tag[t_cache_line::ATAG]).bus_read() == tag) {
+        if (line.atag == tag) {
 
-          uint32_t tmp;
+          presence_remove(line, idx);
           if (!m_new_linefetch_en) {
-            (*line)->tag[t_cache_line::VALID].bus_read(tmp);
-
-            (*line)->tag[t_cache_line::VALID].bus_write(tmp & ~offset2valid(offset));
+            line.valid &= ~mask;
           } else {
-            (*line)->tag[t_cache_line::VALID].bus_write(0);
+            line.valid = 0;
           }
+          presence_add(line, idx);
         }
       }
+
+      if (last - address < m_bytesperline) {
+        break;
+      }
     }
   }
 } // vectorcache::snoop_invalidate()
 
+/// ----------------------------------------------------------------------------
+
+/// Snoop filter: Looks up the regions of the address range in the presence filter
+bool vectorcache::snoop_present(unsigned int address, unsigned int length) {
+
+  if (!length) {
+    return false;
+  }
+
+  // Tools attached to the line views see every snoop
+  if (m_line_observers) {
+    return true;
+  }
+
+  unsigned first = address >> PRESENCE_REGION_BITS;
+  unsigned last = (address + length - 1) >> PRESENCE_REGION_BITS;
+
+  if (last - first >= PRESENCE_REGIONS) {
+    return true;
+  }
+
+  for (unsigned region = first; region <= last; region++) {
+    if (m_presence[region & (PRESENCE_REGIONS - 1)]) {
+      return true;
+    }
+  }
+  return false;
+} // vectorcache::snoop_present()
+
+/// ----------------------------------------------------------------------------
+
+/// Instruction fetch buffer: A read hit on the buffered line. The tag lookup
+/// is skipped, the line already is the most recently used of its set.
+bool vectorcache::fetch_buffered(unsigned int address, unsigned char *data,
+                                 sc_core::sc_time *delay, unsigned int *debug) {
+
+  // Tools attached to the line views see every access
+  if (!m_fetch_line || (address & ~(m_bytesperline - 1)) != m_fetch_address || m_line_observers) {
+    return false;
+  }
+
+  unsigned offset = address & (m_bytesperline - 1);
+  if ((!m_new_linefetch_en && !(m_fetch_line->valid & (1u << (offset >> 2))))
+  || (m_new_linefetch_en && !(m_fetch_line->valid & 0x1))) {
+    return false;
+  }
+
+  memcpy(data, m_fetch_data + offset, 4);
+
+  // Same timing and power as a read hit (tag lookup + data read)
+  *delay += clockcycle;
+  if (m_pow_mon) {
+    dyn_tag_reads += m_sets + 1;
+    dyn_data_reads += m_sets + 1;
+  }
+
+  // Update debug information
+  rhits[m_fetch_way]++;
+  CACHEREADHIT_SET(*debug, m_fetch_way);
+
+  return true;
+} // vectorcache::fetch_buffered()
+
+/// ----------------------------------------------------------------------------
+
+/// Recounts the presence filter from the tags
+void vectorcache::presence_rebuild() {
+
+  m_presence.assign(PRESENCE_REGIONS, 0);
+  for (unsigned way = 0; way <= m_sets; way++) {
+    for (unsigned idx = 0; idx < m_number_of_vectors; idx++) {
+      presence_add(lookup_tag(idx, way), idx);
+    }
+  }
+} // vectorcache::presence_rebuild()
+
 /// @} Interface Control Methods
 /// ****************************************************************************
 /// @name Internal Methods
@@ -811,7 +902,6 @@ unsigned int vectorcache::offset2valid(unsigned int offset, unsigned int len) {
 /// Selects way to be refilled depending on replacement strategy
 unsigned int vectorcache::replacement_selector(unsigned int idx, unsigned int mode) {
 
-  std::vector<t_cache_line*>::iterator line = lookup_line(idx, 0);
   unsigned way = 0, way_select = 0;
   uint32_t min_lru;
 
@@ -835,15 +925,12 @@ unsigned int vectorcache::replacement_selector(unsigned int idx, unsigned int mo
       // Find the cache line with the lowest LRU value.
       min_lru = m_max_lru;
 
-      for (; way <= m_sets; line++, way++) {
+      for (; way <= m_sets; way++) {
 
         // The last way will never be locked.
-        uint32_t tmp_lru;
-        (*line)->tag[t_cache_line::LRU].bus_read(tmp_lru);
-        uint32_t tmp_lock;
-        (*line)->tag[t_cache_line::LRU].bus_read(tmp_lock);
-        if ((tmp_lru <= min_lru) && (tmp_lock == 0)) {
-          min_lru = tmp_lru;
+        t_cache_tag &line = lookup_tag(idx, way);
+        if ((line.lru <= min_lru) && (line.lock == 0)) {
+          min_lru = line.lru;
           way_select = way;
         }
       }
@@ -859,9 +946,9 @@ unsigned int vectorcache::replacement_selector(unsigned int idx, unsigned int mo
       // The last way (way 1) will never be locked.
       way_select = 1;
 
-      for (; way <= 2; line++, way++) {
+      for (; way < 2; way++) {
 
-        if (((*line)->tag[t_cache_line::LRR].bus_read() == 0) && ((*line)->tag[t_cache_line::LOCK].bus_read() == 0)) {
+        if ((lookup_tag(idx, way).lrr == 0) && (lookup_tag(idx, way).lock == 0)) {
 
           srDebug()("selected way", way)("LRR Replacement");
           way_select = way;
@@ -883,7 +970,7 @@ unsigned int vectorcache::replacement_selector(unsigned int idx, unsigned int mo
 
       }
       // The last way will never be locked.
-      while (line[way_select]->tag[t_cache_line::LOCK].bus_read() != 0);
+      while (lookup_tag(idx, way_select).lock != 0);
 
       srDebug()("selected way", way_select)("Pseudo Random Replacement");
   }
@@ -897,15 +984,14 @@ unsigned int vectorcache::replacement_selector(unsigned int idx, unsigned int mo
 /// Updates the LRR bits for every line replacement
 void vectorcache::lrr_update(unsigned int idx, unsigned int way_select) {
 
-  std::vector<t_cache_line*>::iterator line = lookup_line(idx, 0);
-
   // LRR may only be used for 2-way associative caches.
-  for (unsigned way = 0; way < 2; line++, way++) {
+  for (unsigned way = 0; way < 2; way++) {
+    t_cache_tag &line = lookup_tag(idx, way);
 
     // Switch the lrr bit on for the selected way and off for the remaining.
-    (*line)->tag[t_cache_line::LRR].bus_write((way == way_select)? 1 : 0);
+    line.lrr = (way == way_select)? 1 : 0;
 
-    srDebug()("way", way)("LRR", (*line)->tag[t_cache_line::LRR])("LRR update");
+    srDebug()("way", way)("LRR", line.lrr)("LRR update");
 
   }
 
@@ -916,23 +1002,21 @@ void vectorcache::lrr_update(unsigned int idx, unsigned int way_select) {
 /// Updates the LRU counters for every cache hit
 void vectorcache::lru_update(unsigned int idx, unsigned int way_select) {
 
-  std::vector<t_cache_line*>::iterator line = lookup_line(idx, 0);
-  uint32_t pivot = (*lookup_line(idx, way_select))->tag[t_cache_line::LRU].bus_read();
+  uint32_t pivot = lookup_tag(idx, way_select).lru;
   unsigned lru;
 
-  for (unsigned way = 0; way <= m_sets; line++, way++) {
-    lru = (*line)->tag[t_cache_line::LRU].bus_read();
+  for (unsigned way = 0; way <= m_sets; way++) {
+    t_cache_tag &line = lookup_tag(idx, way);
+    lru = line.lru;
 
     // LRU: Counter for each line of a way
     if (way == way_select) {
-      (*line)->tag[t_cache_line::LRU].bus_write(m_max_lru);
-    } else if ((*line)->tag[t_cache_line::LRU].bus_read() > pivot) {
-      uint32_t tmp_lru;
-      (*line)->tag[t_cache_line::LRU].bus_read(tmp_lru);
-      (*line)->tag[t_cache_line::LRU].bus_write(tmp_lru-1);
+      line.lru = m_max_lru;
+    } else if (line.lru > pivot) {
+      line.lru--;
     }
 
-    srDebug()("way", way)("old LRU", lru)("new LRU", (*line)->tag[t_cache_line::LRU])("LRU update");
+    srDebug()("way", way)("old LRU", lru)("new LRU", line.lru)("LRU update");
 
   }
 
@@ -950,20 +1034,19 @@ int vectorcache::locate_line(unsigned int const tag,
   bool found = false;
 
   // Lookup all cache ways
-  for (std::vector<t_cache_line*>::iterator line = lookup_line(idx, 0);
-       way <= m_sets; line++, way++) {
+  for (; way <= m_sets; way++) {
+    t_cache_tag &line = lookup_tag(idx, way);
 
     // Check the cache tag
-    if ((*line)->tag[t_cache_line::ATAG].bus_read() == tag) {
+    if (line.atag == tag) {
 
       // Check the valid bit
-      uint32_t tmp_valid;
-      (*line)->tag[t_cache_line::VALID].bus_read(tmp_valid);
+      uint32_t tmp_valid = line.valid;
       if ((!m_new_linefetch_en && (tmp_valid & offset2valid(offset, len)) == offset2valid(offset, len))
       || (m_new_linefetch_en && (tmp_valid & 0x1))) {
 
         srDebug()("way", way)
-                 ("valid", (*line)->tag[t_cache_line::VALID])
+                 ("valid", tmp_valid)
                  ("valid mask",offset2valid(offset, len))
                  ("Cache hit in current way");
         found = true;
@@ -971,7 +1054,7 @@ int vectorcache::locate_line(unsigned int const tag,
       } else {
 
         srDebug()("way", way)
-                 ("valid", (*line)->tag[t_cache_line::VALID])
+                 ("valid", tmp_valid)
                  ("valid mask",offset2valid(offset, len))
                  ("Cache hit but invalid data in current way");
 
@@ -1007,32 +1090,34 @@ int vectorcache::update_line (unsigned const tag,
                               unsigned int * debug,
                               bool& cacheable, bool is_dbg) {
 
-    t_cache_line* line = (*lookup_line(idx, way));
+    t_cache_tag &line = lookup_tag(idx, way);
+
+    presence_remove(line, idx);
 
     // Update data in cache
     // This is written generically to serve both aligned reads and non-aligned
     // writes.
-    line->entry.copy_to(data, len, offset >> 2, offset & 0x3);
+    memcpy(lookup_data(idx, way) + offset, data, len);
+    notify_line(idx, way, scireg_ns::SCIREG_WRITE_ACCESS, offset, len);
 
     // Update tag and flags for line allocate
-    if (line->tag[t_cache_line::ATAG].bus_read() != tag) {
+    if (line.atag != tag) {
 
-      line->tag[t_cache_line::ATAG].bus_write(tag);
+      line.atag = tag;
 
       if (m_repl == 2) lrr_update(idx, way);
 
-      line->tag[t_cache_line::VALID].bus_write(0);
+      line.valid = 0;
 
     }
 
     // Update flags for line allocate or update
     if (!m_new_linefetch_en) {
-      uint32_t tmp_valid;
-      line->tag[t_cache_line::VALID].bus_read(tmp_valid);
-      line->tag[t_cache_line::VALID].bus_write(tmp_valid | offset2valid(offset, len));
+      line.valid |= offset2valid(offset, len);
     } else {
-      line->tag[t_cache_line::VALID].bus_write(0x1);
+      line.valid = 0x1;
     }
+    presence_add(line, idx);
     if (m_repl == 1) lru_update(idx, way);
 
     // Increment time
@@ -1074,11 +1159,9 @@ int vectorcache::allocate_line (unsigned const tag,
   bool found = false;
 
   // Easiest option for replacement is using invalid cache lines.
-  for (std::vector<t_cache_line*>::iterator line = lookup_line(idx, 0);
-       way <= m_sets; line++, way++) {
+  for (; way <= m_sets; way++) {
 
-    uint32_t tmp_valid;
-    (*line)->tag[t_cache_line::VALID].bus_read(tmp_valid);
+    uint32_t tmp_valid = lookup_tag(idx, way).valid;
     if ((!m_new_linefetch_en && (tmp_valid & offset2valid(offset, len)) == 0 /* == offset2valid(offset, len) instead of 0? */)
     || (m_new_linefetch_en && (tmp_valid & 0x1) == 0)) {
 
@@ -1098,6 +1181,77 @@ int vectorcache::allocate_line (unsigned const tag,
   return update_line(tag, idx, offset, way, len, data, delay, debug, cacheable, is_dbg);
 } // vectorcache::allocate_line()
 
+/// ----------------------------------------------------------------------------
+
+/// Creates the scireg views of all cache lines
+/** @details
+*   The views only wrap the tag and data arrays. They are not needed for
+*   simulation and are therefore created the first time a tool asks for the
+*   child regions of the cache. Line i of the view is index i / ways and way
+*   i % ways. Each view is 64 bytes: tag words at 0x0-0x13, data from 0x20.
+*/
+void vectorcache::create_line_views() const {
+  if (!m_line_views.empty()) {
+    return;
+  }
+
+  vectorcache *self = const_cast<vectorcache *>(this);
+  unsigned ways = m_sets + 1;
+  for (uint32_t i = 0; i < m_number_of_vectors * ways; i++) {
+    std::stringstream name;
+    name << "line_" << i;
+
+    t_cache_line *line = new t_cache_line(name.str(),
+                                          self->lookup_tag(i / ways, i % ways),
+                                          self->lookup_data(i / ways, i % ways),
+                                          m_wordsperline, *self);
+    m_line_views.push_back(line);
+
+    scireg_ns::scireg_mapped_region mapped_region;
+    mapped_region.region = line;
+    mapped_region.offset = i * 64;
+    mapped_region.name = line->name();
+    m_mapped_regions.push_back(mapped_region);
+  }
+} // vectorcache::create_line_views()
+
+/// ----------------------------------------------------------------------------
+
+/// Deletes the scireg views of all cache lines
+void vectorcache::destroy_line_views() {
+  for (std::vector<t_cache_line*>::iterator it = m_line_views.begin() ; it != m_line_views.end(); ++it) {
+    delete (*it);
+  }
+  m_line_views.clear();
+  m_mapped_regions.clear();
+  m_line_observers = 0;
+} // vectorcache::destroy_line_views()
+
+/// ----------------------------------------------------------------------------
+
+/// A tool attached a callback to one of the line views
+void vectorcache::line_observer_added() {
+  m_line_observers++;
+} // vectorcache::line_observer_added()
+
+/// ----------------------------------------------------------------------------
+
+/// A tool removed a callback from one of the line views. Without observers
+/// the views are of no further use and the fast paths are enabled again.
+void vectorcache::line_observer_removed() {
+  if (m_line_observers && !--m_line_observers) {
+    destroy_line_views();
+  }
+} // vectorcache::line_observer_removed()
+
+/// ----------------------------------------------------------------------------
+
+/// A tool changed tags or data through a line view
+void vectorcache::line_written() {
+  presence_rebuild();
+  fetch_buffer_invalidate();
+} // vectorcache::line_written()
+
 /// @} Internal Methods
 /// ****************************************************************************
 /// @name Diagnostic Methods
@@ -1114,13 +1268,12 @@ void vectorcache::dbg_out(unsigned int idx) {
 
   unsigned way = 0;
 
-  for (std::vector<t_cache_line*>::iterator line = lookup_line(idx, 0);
-       way <= m_sets; line++, way++) {
+  for (; way <= m_sets; way++) {
 
     // display the tag
-    srDebug()("tag", (*line)->tag[t_cache_line::ATAG])
+    srDebug()("tag", lookup_tag(idx, way).atag)
              ("way", way)
-             ("valid", (*line)->tag[t_cache_line::VALID])
+             ("valid", lookup_tag(idx, way).valid)
              ("Diagnostic cache line display (big-endian)");
 
     // display all entries
@@ -1129,7 +1282,7 @@ void vectorcache::dbg_out(unsigned int idx) {
       std::cout << "Entry: " << j << " - ";
 
       for (unsigned k = 0; k < 4; k++) {
-        std::cout << hex << std::setw(2) << (unsigned)(*line)->entry.get_char(j, k);
+        std::cout << hex << std::setw(2) << (unsigned)lookup_data(idx, way)[(j << 2) + k];
       }
 
       std::cout << " " << std::endl;
@@ -1146,6 +1299,38 @@ void vectorcache::clkcng(sc_core::sc_time &clk) {
 
 /// ----------------------------------------------------------------------------
 
+/// Save the cache content into a snapshot
+void vectorcache::snapshot_save(Snapshot &snapshot) {
+  snapshot.put("tags", m_tags);
+  snapshot.put("data", m_data);
+  snapshot.put("pseudo_rand", m_pseudo_rand);
+} // vectorcache::snapshot_save
+
+/// ----------------------------------------------------------------------------
+
+/// Restore the cache content from a snapshot
+void vectorcache::snapshot_restore(Snapshot &snapshot) {
+  std::vector<t_cache_tag> tags;
+  std::vector<uint32_t> data;
+  if (!snapshot.get("tags", tags) || tags.size() != m_tags.size() ||
+      !snapshot.get("data", data) || data.size() != m_data.size()) {
+    srWarn()
+      ("The cache geometry differs from the snapshot, the cache is flushed");
+    unsigned int debug = 0;
+    sc_core::sc_time t = sc_core::SC_ZERO_TIME;
+    flush(&t, &debug, true);
+    return;
+  }
+  // Copy in place, the line views point into m_tags and m_data
+  std::copy(tags.begin(), tags.end(), m_tags.begin());
+  std::copy(data.begin(), data.end(), m_data.begin());
+  snapshot.get("pseudo_rand", m_pseudo_rand);
+  presence_rebuild();
+  fetch_buffer_invalidate();
+} // vectorcache::snapshot_restore
+
+/// ----------------------------------------------------------------------------
+
 /// Print execution statistic at end of simulation
 void vectorcache::end_of_simulation() {
 
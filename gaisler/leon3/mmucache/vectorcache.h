@@ -34,10 +34,12 @@
 #include "gaisler/leon3/mmucache/tlb_adaptor.h"
 #include "gaisler/leon3/mmucache/mem_if.h"
 #include "core/base/vendian.h"
+#include "core/base/snapshot.h"
 
 // implementation of cache memory and controller
 /// @brief virtual cache model, contain common functionality of instruction and data cache
-class vectorcache : public DefaultBase, public cache_if, public scireg_ns::scireg_region_if
+class vectorcache : public DefaultBase, public cache_if, public scireg_ns::scireg_region_if, public SnapshotDevice,
+                    public t_cache_line_owner
 {
 
   /// --------------------------------------------------------------------------
@@ -80,6 +82,15 @@ public:
   /// Snooping function (invalidates cache line(s))
   virtual void snoop_invalidate(const t_snoop& snoop, const sc_core::sc_time& delay);
 
+  /// Snoop filter, returns false if no line in the address range can be cached
+  virtual bool snoop_present(unsigned int address, unsigned int length);
+
+  /// Serves a 4 byte instruction fetch from the line of the last read hit.
+  /// Has the same effect as a read hit in mem_read, returns false if the
+  /// word is not buffered.
+  virtual bool fetch_buffered(unsigned int address, unsigned char *data,
+                              sc_core::sc_time *t, unsigned int *debug);
+
   virtual scireg_ns::scireg_response scireg_get_region_type(scireg_ns::scireg_region_type& t) const {
     t = scireg_ns::SCIREG_BANK;
     return scireg_ns::SCIREG_SUCCESS;
@@ -92,14 +103,13 @@ public:
   }
 
   /// Get child regions mapped into this region, by returning a mapped region object representing each mapping.
-  /// The size and offset parameters can be used to constrain the range of the search
+  /// The size and offset parameters can be used to constrain the range of the search.
+  /// The regions are deleted again when the last callback attached to one of them is removed.
   virtual scireg_ns::scireg_response scireg_get_child_regions(
       std::vector<scireg_ns::scireg_mapped_region>& mapped_regions,
       sc_dt::uint64 size=sc_dt::uint64(-1), sc_dt::uint64 offset=0) const {
-   for (std::vector<scireg_ns::scireg_mapped_region*>::const_iterator i = this->mapped_regions->begin();
-       i != this->mapped_regions->end(); ++i) {
-     mapped_regions.push_back(**i);
-   }
+    create_line_views();
+    mapped_regions.insert(mapped_regions.end(), m_mapped_regions.begin(), m_mapped_regions.end());
     return scireg_ns::SCIREG_SUCCESS;
   }
 
@@ -130,10 +140,58 @@ protected:
   /// Updates the lrr bits for every line replacement
   void lrr_update(unsigned int idx, unsigned int set_select);
 
-  /// Reads a cache line from a given cache way.
-  /// Returns an iterator to found line (more useful than pointer for looping through ways of a given index).
-  /// Returns null for incorrect parameters.
-  inline std::vector<t_cache_line*>::iterator lookup_line(unsigned idx, unsigned way) {return (cache_mem->begin())+(idx*(m_sets+1)+way);}
+  /// Returns the tag of the cache line at index idx in the given way.
+  inline t_cache_tag &lookup_tag(unsigned idx, unsigned way) {return m_tags[way * m_number_of_vectors + idx];}
+
+  /// Returns the data of the cache line at index idx in the given way.
+  inline uint8_t *lookup_data(unsigned idx, unsigned way)
+    {return reinterpret_cast<uint8_t *>(&m_data[(way * m_number_of_vectors + idx) << m_linesize]);}
+
+  /// Forwards an access to a cache line to its scireg view.
+  /// Costs a single compare as long as no tool attached a callback.
+  inline void notify_line(unsigned idx, unsigned way, scireg_ns::scireg_callback_type type,
+                          unsigned offset, unsigned len) {
+    if (m_line_observers) {
+      m_line_views[idx * (m_sets + 1) + way]->execute_callbacks(type, t_cache_line::DATA + offset, len);
+    }
+  }
+
+  /// Creates the scireg views of all cache lines, if not done yet.
+  void create_line_views() const;
+
+  /// Deletes the scireg views of all cache lines
+  void destroy_line_views();
+
+  /// t_cache_line_owner: Tool accesses through the line views
+  virtual void line_observer_added();
+  virtual void line_observer_removed();
+  virtual void line_written();
+
+  /// Presence filter region of a cache line
+  inline unsigned presence_region(unsigned address)
+    {return (address >> PRESENCE_REGION_BITS) & (PRESENCE_REGIONS - 1);}
+
+  /// Removes a line from the presence filter, call before changing its tag or valid bits
+  inline void presence_remove(const t_cache_tag &line, unsigned idx)
+    {if (line.valid) m_presence[presence_region(get_address(line.atag, idx, 0))]--;}
+
+  /// Adds a line to the presence filter, call after changing its tag or valid bits
+  inline void presence_add(const t_cache_tag &line, unsigned idx)
+    {if (line.valid) m_presence[presence_region(get_address(line.atag, idx, 0))]++;}
+
+  /// Recounts the presence filter from the tags
+  void presence_rebuild();
+
+  /// Remembers the line of a read hit in the fetch buffer
+  inline void fetch_buffer_fill(unsigned address, unsigned idx, unsigned way) {
+    m_fetch_line = &lookup_tag(idx, way);
+    m_fetch_address = address & ~(m_bytesperline - 1);
+    m_fetch_way = way;
+    m_fetch_data = lookup_data(idx, way);
+  }
+
+  /// Empties the fetch buffer
+  inline void fetch_buffer_invalidate() {m_fetch_line = NULL;}
 
   /// Searches for a cache tag in all cache ways. Updates power information for reading tags.
   /// Returns found way if tag matches and data is valid, otherwise -1.
@@ -173,6 +231,12 @@ public:
   /// Helper functions for definition of clock cycle
   void clkcng(sc_core::sc_time &clk);
 
+  /// Saves tags, data and the replacement state
+  void snapshot_save(Snapshot &snapshot);
+
+  /// Restores tags, data and the replacement state if the geometry matches
+  void snapshot_restore(Snapshot &snapshot);
+
   /// @} Diagnostic Methods
   /// --------------------------------------------------------------------------
   /// @name Constructors and Destructors
@@ -233,11 +297,34 @@ protected:
   /// [31]    Cache locking (CL) - Set if cache locking is implemented
   unsigned int CACHE_CONFIG_REG;
 
-  /// The actual cache memory
-  std::vector<t_cache_line*> *cache_mem;
+  /// The cache tags, one contiguous block of m_number_of_vectors tags per way
+  std::vector<t_cache_tag> m_tags;
+
+  /// The cache data, lines stored in the same order as the tags
+  std::vector<uint32_t> m_data;
+
+  /// scireg views of the cache lines (only exist after a tool asked for them)
+  mutable std::vector<t_cache_line*> m_line_views;
 
   /// The children scireg_reagion_ifs
-  std::vector<scireg_ns::scireg_mapped_region*> *mapped_regions;
+  mutable std::vector<scireg_ns::scireg_mapped_region> m_mapped_regions;
+
+  /// Number of scireg callbacks attached to the line views
+  mutable unsigned int m_line_observers;
+
+  /// Snoop presence filter: Number of valid lines per address region.
+  /// Regions alias modulo PRESENCE_REGIONS, which only causes false positives.
+  static const unsigned int PRESENCE_REGION_BITS = 10;
+  static const unsigned int PRESENCE_REGIONS = 1024;
+  std::vector<uint32_t> m_presence;
+
+  /// Instruction fetch buffer: tag, address, way and data of the line of the
+  /// last read hit (m_fetch_line is NULL if empty). The line is the most
+  /// recently used of its set as long as it is buffered.
+  t_cache_tag *m_fetch_line;
+  unsigned int m_fetch_address;
+  unsigned int m_fetch_way;
+  uint8_t *m_fetch_data;
 
   /// Indicates whether the cache can be put in burst mode or not
   unsigned int m_burst_en;
@@ -304,19 +391,19 @@ protected:
   gs::gs_param_array m_performance_counters;
 
   /// Counter for read hits
-  gs::gs_param<unsigned long long *> rhits;
+  sr_counter_array rhits;
 
   /// Counter for read misses
-  sr_param<uint64_t> rmisses;
+  sr_counter rmisses;
 
   /// Counter for write hits
-  gs::gs_param<unsigned long long *> whits;
+  sr_counter_array whits;
 
   /// Counter for write misses
-  sr_param<uint64_t> wmisses;
+  sr_counter wmisses;
 
   /// Counter for bypass operations
-  sr_param<uint64_t> bypassops;
+  sr_counter bypassops;
 
   /// Enable power monitoring
   bool m_pow_mon;
@@ -328,16 +415,16 @@ protected:
 
 protected:
   /// Number of tag ram reads (monitor read & reset)
-  sr_param<uint64_t> dyn_tag_reads;
+  sr_counter dyn_tag_reads;
 
   /// Number of tag ram writes (monitor read & reset)
-  sr_param<uint64_t> dyn_tag_writes;
+  sr_counter dyn_tag_writes;
 
   /// Number of data ram reads (monitor read & reset)
-  sr_param<uint64_t> dyn_data_reads;
+  sr_counter dyn_data_reads;
 
   /// Number of data ram writes (monitor read & reset)
-  sr_param<uint64_t> dyn_data_writes;
+  sr_counter dyn_data_writes;
 
   /// Timing parameters
   sc_core::sc_time m_hit_read_response_delay;
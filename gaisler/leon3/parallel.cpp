@@ -0,0 +1,291 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup leon3
+/// @{
+/// @file parallel.cpp
+/// Worker threads and round scheduler of the parallel LEON3 mode.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+
+#include <stdexcept>
+#include "gaisler/leon3/parallel.h"
+#include "gaisler/leon3/leon3.h"
+
+Leon3Worker::Leon3Worker(Leon3 &core) :
+  m_core(core),
+  m_request(NULL),
+  m_state(READY),
+  m_quit(false),
+  m_thread(&Leon3Worker::run, this) {
+}
+
+Leon3Worker::~Leon3Worker() {
+  stop();
+}
+
+void Leon3Worker::release() {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_state = RUNNING;
+  m_cond.notify_all();
+}
+
+Leon3Worker::state_t Leon3Worker::wait() {
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  while (m_state == RUNNING) {
+    m_cond.wait(lock);
+  }
+  return m_state;
+}
+
+void Leon3Worker::rearm() {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_state = READY;
+}
+
+bool Leon3Worker::service() {
+  // The worker waits in relay(), the request stays valid until release()
+  request &req = *m_request;
+  if (req.write) {
+    m_core.mmu_cache_base::mem_write(req.addr, req.asi, req.data, req.length, req.delay, req.debug,
+                                     req.is_dbg, *req.cacheable, req.is_lock);
+  } else {
+    req.result = m_core.mmu_cache_base::mem_read(req.addr, req.asi, req.data, req.length, req.delay,
+                                                 req.debug, req.is_dbg, *req.cacheable, req.is_lock);
+  }
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_state = SERVED;
+  return req.is_lock && !req.write;
+}
+
+void Leon3Worker::stop() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_quit = true;
+    m_cond.notify_all();
+  }
+  m_thread.join();
+}
+
+bool Leon3Worker::read(unsigned int addr, unsigned int asi, unsigned char *data, unsigned int length,
+                       sc_core::sc_time *delay, unsigned int *debug, bool is_dbg, bool &cacheable,
+                       bool is_lock) {
+  request req = { false, addr, asi, data, length, delay, debug, is_dbg, &cacheable, is_lock, false };
+  relay(req);
+  return req.result;
+}
+
+void Leon3Worker::write(unsigned int addr, unsigned int asi, unsigned char *data, unsigned int length,
+                        sc_core::sc_time *delay, unsigned int *debug, bool is_dbg, bool &cacheable,
+                        bool is_lock) {
+  request req = { true, addr, asi, data, length, delay, debug, is_dbg, &cacheable, is_lock, false };
+  relay(req);
+}
+
+void Leon3Worker::run() {
+  while (true) {
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while (m_state != RUNNING && !m_quit) {
+        m_cond.wait(lock);
+      }
+      if (m_quit) {
+        return;
+      }
+    }
+    state_t state = execute();
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_state = state;
+    m_cond.notify_all();
+  }
+}
+
+Leon3Worker::state_t Leon3Worker::execute() {
+  leon3_funclt_trap::Processor_leon3_funclt &cpu = m_core.cpu;
+  try {
+    // A core stopped by another one (irqmp) pauses until the next round
+    while (!m_quit && !cpu.irqAck.stopped && !cpu.quantKeeper.need_sync()) {
+      if (!cpu.step(true)) {
+        return DECLINED;
+      }
+    }
+  } catch (std::exception &e) {
+    m_error = e.what();
+    return FAILED;
+  }
+  return QUANTUM;
+}
+
+bool Leon3Worker::relay(request &req) {
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  if (m_quit) {
+    return false;
+  }
+  m_request = &req;
+  m_state = REQUEST;
+  m_cond.notify_all();
+  while (m_state != RUNNING && !m_quit) {
+    m_cond.wait(lock);
+  }
+  // After stop() an access which was not issued yet is abandoned
+  return m_state != REQUEST;
+}
+
+Leon3Parallel::Leon3Parallel(sc_core::sc_module_name mn) : sc_core::sc_module(mn) {
+  SC_THREAD(run);
+}
+
+void Leon3Parallel::add(Leon3 *core) {
+  slot s = { core, false, false, true };
+  core->cpu.parallel = true;
+  core->m_worker = new Leon3Worker(*core);
+  m_slots.push_back(s);
+}
+
+void Leon3Parallel::run() {
+  // Same as Processor_leon3_funclt::mainLoop, the register callbacks need
+  // the SystemC infrastructure
+  wait(sc_core::SC_ZERO_TIME);
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    m_slots[i].core->cpu.beginLoop();
+  }
+  while (true) {
+    if (!round()) {
+      wait(100, sc_core::SC_NS);
+    }
+  }
+}
+
+bool Leon3Parallel::round() {
+  bool running = false;
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    slot &s = m_slots[i];
+    leon3_funclt_trap::Processor_leon3_funclt &cpu = s.core->cpu;
+    s.active = !cpu.irqAck.stopped;
+    s.done = !s.active;
+    if (!s.active) {
+      s.stopped = true;
+      cpu.idle();
+      continue;
+    }
+    if (s.stopped) {
+      s.stopped = false;
+      cpu.wakeUp();
+    }
+    cpu.setExecuting(true);
+    running = true;
+  }
+  if (!running) {
+    return false;
+  }
+
+  // Release the workers in waves until every running core is done. Memory,
+  // interrupts and DMI regions only change between the waves.
+  std::vector<bool> released(m_slots.size());
+  std::vector<bool> local(m_slots.size());
+  while (true) {
+    bool pending = false;
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      slot &s = m_slots[i];
+      leon3_funclt_trap::Processor_leon3_funclt &cpu = s.core->cpu;
+      Leon3Worker &worker = *s.core->m_worker;
+      released[i] = false;
+      local[i] = false;
+      if (s.done) {
+        continue;
+      }
+      if (worker.state() == Leon3Worker::SERVED) {
+        // Finish the instruction waiting for its access
+        released[i] = true;
+      } else if (cpu.irqAck.stopped || cpu.quantKeeper.need_sync()) {
+        s.done = true;
+        continue;
+      } else if (cpu.historyEnabled || cpu.registersObserved()) {
+        // Register callbacks and the history report run in this thread
+        local[i] = true;
+      } else {
+        released[i] = true;
+      }
+      if (released[i]) {
+        worker.release();
+      }
+      pending = true;
+    }
+    if (!pending) {
+      break;
+    }
+    // Every worker has to halt before anything is issued
+    std::vector<Leon3Worker::state_t> states(m_slots.size(), Leon3Worker::DECLINED);
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      if (released[i]) {
+        states[i] = m_slots[i].core->m_worker->wait();
+      }
+    }
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      if (released[i] || local[i]) {
+        handle(m_slots[i], states[i]);
+      }
+    }
+  }
+
+  // Advance to the earliest local time, the others keep their lead
+  sc_core::sc_time step = sc_core::SC_ZERO_TIME;
+  bool first = true;
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    slot &s = m_slots[i];
+    if (!s.active) {
+      continue;
+    }
+    s.core->cpu.setExecuting(false);
+    sc_core::sc_time time = s.core->cpu.quantKeeper.get_local_time();
+    if (first || time < step) {
+      step = time;
+      first = false;
+    }
+  }
+  wait(step);
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    slot &s = m_slots[i];
+    if (!s.active) {
+      continue;
+    }
+    tlm_utils::tlm_quantumkeeper &keeper = s.core->cpu.quantKeeper;
+    sc_core::sc_time rest = keeper.get_local_time() - step;
+    keeper.reset();
+    keeper.set(rest);
+    s.core->m_worker->rearm();
+  }
+  return true;
+}
+
+void Leon3Parallel::handle(slot &s, Leon3Worker::state_t state) {
+  Leon3Worker &worker = *s.core->m_worker;
+  while (state == Leon3Worker::REQUEST) {
+    if (!worker.service()) {
+      return;
+    }
+    // A locked read: the core runs alone up to its write
+    worker.release();
+    state = worker.wait();
+  }
+  switch (state) {
+    case Leon3Worker::DECLINED:
+      s.core->cpu.step(false);
+      worker.rearm();
+      break;
+    case Leon3Worker::QUANTUM:
+      s.done = true;
+      break;
+    case Leon3Worker::FAILED:
+      throw std::runtime_error(worker.error());
+    default:
+      break;
+  }
+}
+/// @}
@@ -0,0 +1,166 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup leon3
+/// @{
+/// @file parallel.h
+/// Runs the instruction set simulators of several LEON3 cores on host threads.
+/// Every core executes its quantum on its own worker thread. Bus accesses
+/// are handed to one SystemC thread, which issues them in core order while
+/// all workers are halted. Reads from granted DMI regions stay on the
+/// workers. The interleaving only depends on the simulated program, so runs
+/// are reproducible.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+#ifndef LEON3_PARALLEL_H_
+#define LEON3_PARALLEL_H_
+
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "core/base/systemc.h"
+
+class Leon3;
+
+/// Host thread executing the instructions of one core. The worker and the
+/// SystemC thread of Leon3Parallel hand the control back and forth, they
+/// never run the same core at the same time.
+class Leon3Worker {
+  public:
+    enum state_t {
+      READY,     ///< Between two instructions, waits for release()
+      RUNNING,   ///< Executes instructions
+      QUANTUM,   ///< The quantum of the core is used up
+      DECLINED,  ///< The next instruction has to run in the SystemC context
+      REQUEST,   ///< Waits in the middle of an instruction for a bus access
+      SERVED,    ///< The bus access is done, waits for release()
+      FAILED     ///< An instruction threw, see error()
+    };
+
+    explicit Leon3Worker(Leon3 &core);
+    ~Leon3Worker();
+
+    /// @name SystemC side
+    /// @{
+
+    /// Lets the worker continue from READY or SERVED
+    void release();
+
+    /// Waits until the worker halts, returns the new state
+    state_t wait();
+
+    state_t state() const {
+      return m_state;
+    }
+
+    /// Sets the state back to READY after a declined instruction
+    void rearm();
+
+    /// Issues the pending bus access, true if it was a locked read
+    bool service();
+
+    /// Abandons pending accesses and joins the thread, can be called twice
+    void stop();
+
+    const std::string &error() const {
+      return m_error;
+    }
+
+    /// @}
+    /// @name Worker side
+    /// @{
+
+    /// True if called from the worker thread
+    bool active() const {
+      return boost::this_thread::get_id() == m_thread.get_id();
+    }
+
+    /// Hands a bus read to the SystemC thread and waits for the result
+    bool read(unsigned int addr, unsigned int asi, unsigned char *data, unsigned int length,
+              sc_core::sc_time *delay, unsigned int *debug, bool is_dbg, bool &cacheable, bool is_lock);
+
+    /// Hands a bus write to the SystemC thread and waits until it is done
+    void write(unsigned int addr, unsigned int asi, unsigned char *data, unsigned int length,
+               sc_core::sc_time *delay, unsigned int *debug, bool is_dbg, bool &cacheable, bool is_lock);
+
+    /// @}
+
+  private:
+    /// Arguments of mem_read/mem_write
+    struct request {
+      bool write;
+      unsigned int addr;
+      unsigned int asi;
+      unsigned char *data;
+      unsigned int length;
+      sc_core::sc_time *delay;
+      unsigned int *debug;
+      bool is_dbg;
+      bool *cacheable;
+      bool is_lock;
+      bool result;
+    };
+
+    void run();
+
+    /// Steps the core until its quantum is used up
+    state_t execute();
+
+    /// Passes req to the SystemC thread, false if the worker got stopped
+    bool relay(request &req);
+
+    Leon3 &m_core;
+    request *m_request;
+    state_t m_state;
+    std::string m_error;
+    boost::atomic<bool> m_quit;
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    boost::thread m_thread;
+};
+
+/// Schedules the cores added to it in rounds of one global quantum. Every
+/// round the workers are released in waves. After each wave the halted
+/// cores are handled in core order: bus accesses are issued, declined
+/// instructions (interrupts, history, hooked tools, observed registers) are
+/// executed here. The read of a locked access (LDSTUB, SWAP) is followed by
+/// its write before any other core continues.
+class Leon3Parallel : public sc_core::sc_module {
+  public:
+    SC_HAS_PROCESS(Leon3Parallel);
+
+    explicit Leon3Parallel(sc_core::sc_module_name mn);
+
+    /// Takes over the execution of core, call before the simulation starts
+    void add(Leon3 *core);
+
+  private:
+    struct slot {
+      Leon3 *core;
+      /// The core was stopped in the previous round
+      bool stopped;
+      /// The core takes part in the current round
+      bool active;
+      /// The quantum of the core is used up
+      bool done;
+    };
+
+    void run();
+
+    /// One round of all running cores, false if every core is stopped
+    bool round();
+
+    /// Handles a core halted in state
+    void handle(slot &s, Leon3Worker::state_t state);
+
+    std::vector<slot> m_slots;
+};
+
+#endif  // LEON3_PARALLEL_H_
+/// @}
@@ -0,0 +1,232 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup leon3
+/// @{
+/// @file dmi.cpp
+/// Reads through mmu_cache_base with disabled caches from three AHB memories:
+/// one granting a single DMI region, one granting a region per storage page
+/// and one without DMI. Checks which reads bypass the bus, that they return
+/// the data and take the time of a bus read, and that invalidating a part of
+/// one region leaves all other regions in place.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <stdint.h>
+#include <iostream>
+#include "core/common/sr_param.h"
+#include "core/base/systemc.h"
+#include "core/sr_registry/sr_registry.h"
+#include "amba/amba.h"
+#include "gaisler/ahbctrl/ahbctrl.h"
+#include "gaisler/ahbmem/ahbmem.h"
+#include "gaisler/leon3/mmucache/mmu_cache_base.h"
+
+namespace {
+
+/// Base addresses of the memories (1 MB each)
+const uint32_t FAST = 0x000000;   ///< ArrayStorage, one region, no wait states
+const uint32_t SLOW = 0x100000;   ///< PagedStorage, 64 kB regions, 2 wait states
+const uint32_t PLAIN = 0x200000;  ///< MapStorage, no DMI
+
+/// Content written to every address before the reads
+uint32_t pattern(uint32_t addr) {
+  return addr ^ 0xa5a5a5a5;
+}
+
+/// mmu_cache_base without caches and MMU, running the accesses of the test
+class TestCache : public mmu_cache_base {
+  public:
+    SC_HAS_PROCESS(TestCache);
+
+    TestCache(ModuleName nm, AHBCtrl &ahbctrl) :
+      mmu_cache_base(nm,
+                     false, 1, 4, 8, 8, true,          // no icache
+                     false, 1, 2, 4, 8, true, false,   // no dcache
+                     false, 0, 0, false, 0, 0,         // no scratch pads
+                     0,                                // cacheability from the slaves
+                     false, 8, 8, 0, 1, 0,             // no MMU
+                     0, false, amba::amba_LT),
+      errors(0),
+      done(false),
+      m_ahbctrl(ahbctrl) {
+      SC_THREAD(run);
+    }
+
+    void trigger_exception(unsigned int exception) {
+      std::cout << "Unexpected exception " << exception << std::endl;
+      errors++;
+    }
+
+    int errors;
+    bool done;
+
+  private:
+    /// Reads a word, time is the simulated time the read took
+    uint32_t read(uint32_t addr, sc_core::sc_time &time, unsigned int lock = 0) {
+      uint32_t data = 0;
+      unsigned int debug = 0;
+      sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+      sc_core::sc_time start = sc_core::sc_time_stamp();
+      tlm::tlm_response_status response;
+      exec_data(tlm::TLM_READ_COMMAND, addr, reinterpret_cast<unsigned char *>(&data), 4, 8, &debug, 0, lock,
+                delay, false, response);
+      wait(delay);
+      time = sc_core::sc_time_stamp() - start;
+      return data;
+    }
+
+    void write(uint32_t addr, uint32_t data, unsigned int lock = 0) {
+      unsigned int debug = 0;
+      sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+      tlm::tlm_response_status response;
+      exec_data(tlm::TLM_WRITE_COMMAND, addr, reinterpret_cast<unsigned char *>(&data), 4, 8, &debug, 0, lock,
+                delay, false, response);
+      wait(delay);
+    }
+
+    /// Reads addr and compares data, path and time with an idle bus read
+    void expect(uint32_t addr, uint32_t value, bool dmi, unsigned int lock = 0) {
+      uint64_t before = m_dmi_reads;
+      sc_core::sc_time time;
+      uint32_t data = read(addr, time, lock);
+      // Arbitration cycle, one data cycle and the wait states of the memory
+      sc_core::sc_time expected = clock_cycle * (((addr >= SLOW) && (addr < PLAIN)) ? 4 : 2);
+      if (data != value) {
+        std::cout << "0x" << std::hex << addr << ": read 0x" << data << " instead of 0x" << value << std::dec
+                  << std::endl;
+        errors++;
+      }
+      if ((m_dmi_reads != before) != dmi) {
+        std::cout << "0x" << std::hex << addr << std::dec << ": served " << (dmi ? "over the bus" : "from DMI")
+                  << std::endl;
+        errors++;
+      }
+      if (time != expected) {
+        std::cout << "0x" << std::hex << addr << std::dec << ": took " << time << " instead of " << expected
+                  << std::endl;
+        errors++;
+      }
+    }
+
+    void regions(size_t expected, const char *when) {
+      if (m_dmi_regions.size() != expected) {
+        std::cout << m_dmi_regions.size() << " DMI regions " << when << " instead of " << expected << std::endl;
+        errors++;
+      }
+    }
+
+    void run() {
+      const uint32_t addrs[] = {
+        FAST, FAST + 4, FAST + 0xff000,
+        SLOW, SLOW + 4, SLOW + 0x10000, SLOW + 0x10004,
+        PLAIN, PLAIN + 4
+      };
+      for (unsigned int i = 0; i < sizeof(addrs) / sizeof(addrs[0]); i++) {
+        write(addrs[i], pattern(addrs[i]));
+      }
+      regions(0, "after the writes");
+
+      // One region for the whole array storage
+      expect(FAST, pattern(FAST), false);
+      expect(FAST + 4, pattern(FAST + 4), true);
+      expect(FAST + 0xff000, pattern(FAST + 0xff000), true);
+
+      // One region per page of the paged storage
+      expect(SLOW, pattern(SLOW), false);
+      expect(SLOW + 4, pattern(SLOW + 4), true);
+      expect(SLOW + 0x10000, pattern(SLOW + 0x10000), false);
+      expect(SLOW + 0x10004, pattern(SLOW + 0x10004), true);
+
+      // The map storage does not grant DMI, every read uses b_transport
+      expect(PLAIN, pattern(PLAIN), false);
+      expect(PLAIN + 4, pattern(PLAIN + 4), false);
+      regions(3, "after the first reads");
+
+      // Writes use the bus and are seen by the following DMI reads
+      write(FAST + 4, 0x12345678);
+      expect(FAST + 4, 0x12345678, true);
+
+      // Invalidating a few bytes drops only the first page of the paged storage
+      m_ahbctrl.invalidate_direct_mem_ptr(1, SLOW + 0x10, SLOW + 0x13);
+      regions(2, "after the partial invalidation");
+      expect(SLOW + 0x10004, pattern(SLOW + 0x10004), true);
+      expect(FAST, pattern(FAST), true);
+      expect(SLOW + 4, pattern(SLOW + 4), false);
+      expect(SLOW, pattern(SLOW), true);
+      regions(3, "after the new grant");
+
+      // Locked reads (LDSTUB/SWAP) always use the bus
+      expect(FAST, pattern(FAST), false, 1);
+      write(FAST, pattern(FAST), 1);
+      expect(FAST, pattern(FAST), true);
+
+      // A wide invalidation drops everything
+      m_ahbctrl.invalidate_direct_mem_ptr(0, 0, 0xffffffff);
+      regions(0, "after invalidating everything");
+      expect(SLOW + 0x10000, pattern(SLOW + 0x10000), false);
+
+      std::cout << m_dmi_reads << " reads served from DMI, " << errors << " errors" << std::endl;
+      done = true;
+    }
+
+    AHBCtrl &m_ahbctrl;
+};
+
+/// The cache and three memories on one LT bus with a 10 ns clock
+class System : public sc_core::sc_module {
+  public:
+    System(sc_core::sc_module_name nm) :
+      sc_core::sc_module(nm),
+      ahbctrl("ahbctrl", amba::amba_LT),
+      fast("fast", amba::amba_LT, FAST >> 20, 0xfff, 0, true, 0),
+      slow("slow", amba::amba_LT, SLOW >> 20, 0xfff, 1, true, 2),
+      plain("plain", amba::amba_LT, PLAIN >> 20, 0xfff, 2, true, 0),
+      cache("cache", ahbctrl) {
+      ahbctrl.ahbOUT(fast.ahb);
+      ahbctrl.ahbOUT(slow.ahb);
+      ahbctrl.ahbOUT(plain.ahb);
+      cache.ahb(ahbctrl.ahbIN);
+      ahbctrl.set_clk(10, sc_core::SC_NS);
+      fast.set_clk(10, sc_core::SC_NS);
+      slow.set_clk(10, sc_core::SC_NS);
+      plain.set_clk(10, sc_core::SC_NS);
+      cache.set_clk(10, sc_core::SC_NS);
+      cache.g_dmi = true;
+    }
+
+    AHBCtrl ahbctrl;
+    AHBMem fast;
+    AHBMem slow;
+    AHBMem plain;
+    TestCache cache;
+};
+
+}  // namespace
+
+int sc_main(int argc, char *argv[]) {
+  gs::ctr::GC_Core core;
+  gs::cnf::ConfigDatabase cnfdatabase("ConfigDatabase");
+  gs::cnf::ConfigPlugin configPlugin(&cnfdatabase);
+  SR_INCLUDE_MODULE(ArrayStorage);
+  SR_INCLUDE_MODULE(MapStorage);
+  SR_INCLUDE_MODULE(PagedStorage);
+
+  gs::cnf::cnf_api *api = gs::cnf::GCnf_Api::getApiInstance(NULL);
+  api->setInitValue("system.slow.generics.storage", "PagedStorage");
+  api->setInitValue("system.plain.generics.storage", "MapStorage");
+
+  System system("system");
+  sc_core::sc_start(sc_core::sc_time(100, sc_core::SC_US));
+
+  if (!system.cache.done) {
+    std::cout << "The accesses did not complete" << std::endl;
+    return 1;
+  }
+  return system.cache.errors ? 1 : 0;
+}
+/// @}
@@ -0,0 +1,213 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup leon3
+/// @{
+/// @file parallel.cpp
+/// Runs two LEON3 cores incrementing a counter under an LDSTUB spinlock,
+/// once sequentially and twice in the parallel mode. Every system has to
+/// count every increment, the two parallel runs have to execute exactly the
+/// same number of instructions on every core.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "core/common/sr_param.h"
+#include "core/base/systemc.h"
+#include "core/sr_registry/sr_registry.h"
+#include "amba/amba.h"
+#include "gaisler/ahbctrl/ahbctrl.h"
+#include "gaisler/ahbmem/ahbmem.h"
+#include "gaisler/leon3/leon3.h"
+#include "gaisler/leon3/parallel.h"
+
+namespace {
+
+const unsigned int CORES = 2;
+const unsigned int ITERATIONS = 1 << 12;
+const unsigned int LOCK = 0x800;   ///< Spinlock byte, the counter follows
+const unsigned int END = 0x34;
+
+// SPARC V8 encodings, as in threadedcode.cpp
+unsigned int alu(unsigned int op3, unsigned int rd, unsigned int rs1, unsigned int rs2) {
+  return 0x80000000 | (rd << 25) | (op3 << 19) | (rs1 << 14) | rs2;
+}
+
+unsigned int alui(unsigned int op3, unsigned int rd, unsigned int rs1, int simm13) {
+  return 0x80000000 | (rd << 25) | (op3 << 19) | (rs1 << 14) | (1 << 13) | (simm13 & 0x1fff);
+}
+
+unsigned int sethi(unsigned int rd, unsigned int imm22) {
+  return (rd << 25) | (4 << 22) | (imm22 & 0x3fffff);
+}
+
+unsigned int branch(unsigned int cond, int disp) {
+  return (cond << 25) | (2 << 22) | (disp & 0x3fffff);
+}
+
+unsigned int ldst(unsigned int op3, unsigned int rd, unsigned int rs1, int simm13) {
+  return 0xc0000000 | (rd << 25) | (op3 << 19) | (rs1 << 14) | (1 << 13) | (simm13 & 0x1fff);
+}
+
+uint64_t dmi_reads(Leon3 &core) {
+  gs::cnf::cnf_api *api = gs::cnf::GCnf_Api::getApiInstance(NULL);
+  return strtoull(api->getValue(std::string(core.name()) + ".counters.dmi_reads").c_str(), NULL, 0);
+}
+
+/// Two cores with disabled caches sharing a memory on an LT bus
+class System : public sc_core::sc_module {
+  public:
+    System(sc_core::sc_module_name nm, bool parallel) :
+      sc_core::sc_module(nm),
+      ahbctrl("ahbctrl", amba::amba_LT),
+      mem("mem", amba::amba_LT, 0x000, 0xfff, 0),
+      scheduler(parallel ? new Leon3Parallel("parallel") : NULL) {
+      ahbctrl.ahbOUT(mem.ahb);
+      ahbctrl.set_clk(10, sc_core::SC_NS);
+      mem.set_clk(10, sc_core::SC_NS);
+      for (unsigned int i = 0; i < CORES; i++) {
+        cores[i] = new Leon3(sc_core::sc_gen_unique_name("leon3", false),
+                             true, 1, 4, 8, 8, true,
+                             true, 1, 2, 4, 8, true, true,
+                             false, 0, 0, false, 0, 0,
+                             0,
+                             false, 8, 8, 0, 1, 0,
+                             i, false, amba::amba_LT);
+        cores[i]->ahb(ahbctrl.ahbIN);
+        cores[i]->set_clk(10, sc_core::SC_NS);
+        cores[i]->g_dmi = true;
+        // Park the cores until the program is loaded
+        cores[i]->cpu.irqAck.stopped = true;
+        if (scheduler) {
+          scheduler->add(cores[i]);
+        }
+      }
+    }
+
+    /// The spinlock loop, ends in a branch to itself at END
+    void load() {
+      const unsigned int program[] = {
+        sethi(5, ITERATIONS >> 10),   // sethi %hi(ITERATIONS), %g5
+        alui(0x02, 2, 0, LOCK),       // or    %g0, LOCK, %g2
+        ldst(0x0d, 3, 2, 0),          // lock: ldstub [%g2], %g3
+        alu(0x12, 0, 3, 0),           // orcc  %g3, %g0, %g0
+        branch(9, -2),                // bne   lock
+        sethi(0, 0),                  // nop
+        ldst(0x00, 4, 2, 4),          // ld    [%g2 + 4], %g4
+        alui(0x00, 4, 4, 1),          // add   %g4, 1, %g4
+        ldst(0x04, 4, 2, 4),          // st    %g4, [%g2 + 4]
+        ldst(0x05, 0, 2, 0),          // stb   %g0, [%g2]
+        alui(0x14, 5, 5, 1),          // subcc %g5, 1, %g5
+        branch(9, -9),                // bne   lock
+        sethi(0, 0),                  // nop
+        branch(8, 0),                 // end: ba end
+        sethi(0, 0),                  // nop
+      };
+      for (unsigned int i = 0; i < sizeof(program) / sizeof(program[0]); i++) {
+        write(i * 4, program[i]);
+      }
+      write(LOCK, 0);
+      write(LOCK + 4, 0);
+      for (unsigned int i = 0; i < CORES; i++) {
+        cores[i]->cpu.irqAck.stopped = false;
+      }
+    }
+
+    bool finished() {
+      for (unsigned int i = 0; i < CORES; i++) {
+        unsigned int pc = cores[i]->cpu.PC.readNewValue();
+        if (pc != END && pc != END + 4) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// Memory is big endian
+    uint32_t read(uint32_t addr) {
+      uint32_t word = 0;
+      for (unsigned int i = 0; i < 4; i++) {
+        word = (word << 8) | mem.read_dbg(addr + i);
+      }
+      return word;
+    }
+
+    AHBCtrl ahbctrl;
+    AHBMem mem;
+    Leon3Parallel *scheduler;
+    Leon3 *cores[CORES];
+
+  private:
+    void write(uint32_t addr, uint32_t word) {
+      for (unsigned int i = 0; i < 4; i++) {
+        mem.write_dbg(addr + i, (word >> (24 - 8 * i)) & 0xff);
+      }
+    }
+};
+
+int check(System &system) {
+  int errors = 0;
+  uint32_t count = system.read(LOCK + 4);
+  std::cout << system.name() << ": counter " << count << ", instructions";
+  for (unsigned int i = 0; i < CORES; i++) {
+    std::cout << " " << system.cores[i]->cpu.numInstructions.getValue();
+  }
+  std::cout << std::endl;
+  if (!system.finished()) {
+    std::cout << system.name() << ": the cores did not reach the end" << std::endl;
+    errors++;
+  }
+  if (count != CORES * ITERATIONS) {
+    std::cout << system.name() << ": " << count << " increments instead of " << CORES * ITERATIONS << std::endl;
+    errors++;
+  }
+  return errors;
+}
+
+}  // namespace
+
+int sc_main(int argc, char *argv[]) {
+  gs::ctr::GC_Core core;
+  gs::cnf::ConfigDatabase cnfdatabase("ConfigDatabase");
+  gs::cnf::ConfigPlugin configPlugin(&cnfdatabase);
+  SR_INCLUDE_MODULE(ArrayStorage);
+
+  System sequential("sequential", false);
+  System first("first", true);
+  System second("second", true);
+  sc_core::sc_start(sc_core::sc_time(1, sc_core::SC_US));
+
+  sequential.load();
+  first.load();
+  second.load();
+  for (unsigned int i = 0; i < 1000; i++) {
+    if (sequential.finished() && first.finished() && second.finished()) {
+      break;
+    }
+    sc_core::sc_start(sc_core::sc_time(100, sc_core::SC_US));
+  }
+
+  int errors = check(sequential) + check(first) + check(second);
+  for (unsigned int i = 0; i < CORES; i++) {
+    // Both runs stopped at the same time, the interleaving has to match
+    if (first.cores[i]->cpu.numInstructions.getValue() != second.cores[i]->cpu.numInstructions.getValue()) {
+      std::cout << "Core " << i << " executed a different number of instructions in the parallel runs"
+                << std::endl;
+      errors++;
+    }
+    // Instruction fetches are served from DMI on the workers
+    if (dmi_reads(*first.cores[i]) == 0) {
+      std::cout << first.cores[i]->name() << " did not read from DMI" << std::endl;
+      errors++;
+    }
+  }
+  return errors ? 1 : 0;
+}
+/// @}
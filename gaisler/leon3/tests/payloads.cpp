@@ -0,0 +1,159 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup leon3
+/// @{
+/// @file payloads.cpp
+/// Issues many bus accesses through mmu_cache_base with disabled caches, in
+/// LT and in AT mode, and reads the payload_allocations counter from the
+/// parameter tree. The counter has to stay flat once the first accesses
+/// are done, LT accesses have to share a single payload.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "core/common/sr_param.h"
+#include "core/base/systemc.h"
+#include "core/sr_registry/sr_registry.h"
+#include "amba/amba.h"
+#include "gaisler/ahbctrl/ahbctrl.h"
+#include "gaisler/ahbmem/ahbmem.h"
+#include "gaisler/leon3/mmucache/mmu_cache_base.h"
+
+namespace {
+
+/// Accesses before the first and between the two counter samples
+const unsigned int WARMUP = 256;
+const unsigned int ACCESSES = 4096;
+
+uint64_t allocations(const std::string &cache) {
+  gs::cnf::cnf_api *api = gs::cnf::GCnf_Api::getApiInstance(NULL);
+  return strtoull(api->getValue(cache + ".counters.payload_allocations").c_str(), NULL, 0);
+}
+
+/// mmu_cache_base without caches and MMU, alternating stores and loads
+class TestCache : public mmu_cache_base {
+  public:
+    SC_HAS_PROCESS(TestCache);
+
+    TestCache(ModuleName nm, AbstractionLayer ambaLayer) :
+      mmu_cache_base(nm,
+                     false, 1, 4, 8, 8, true,          // no icache
+                     false, 1, 2, 4, 8, true, false,   // no dcache
+                     false, 0, 0, false, 0, 0,         // no scratch pads
+                     0,                                // cacheability from the slaves
+                     false, 8, 8, 0, 1, 0,             // no MMU
+                     0, false, ambaLayer),
+      errors(0),
+      warm(0),
+      done(0) {
+      SC_THREAD(run);
+    }
+
+    void trigger_exception(unsigned int exception) {
+      std::cout << "Unexpected exception " << exception << std::endl;
+      errors++;
+    }
+
+    int errors;
+    /// Counter values after WARMUP and after WARMUP + ACCESSES accesses
+    uint64_t warm;
+    uint64_t done;
+
+  private:
+    void access(unsigned int i) {
+      uint32_t addr = (i * 4) & 0xffff;
+      uint32_t data = i ^ 0x5a5a5a5a;
+      uint32_t back = 0;
+      unsigned int debug = 0;
+      sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+      tlm::tlm_response_status response;
+      exec_data(tlm::TLM_WRITE_COMMAND, addr, reinterpret_cast<unsigned char *>(&data), 4, 8, &debug, 0, 0,
+                delay, false, response);
+      exec_data(tlm::TLM_READ_COMMAND, addr, reinterpret_cast<unsigned char *>(&back), 4, 8, &debug, 0, 0,
+                delay, false, response);
+      wait(delay);
+      if (back != data) {
+        std::cout << name() << " 0x" << std::hex << addr << ": read 0x" << back << " instead of 0x" << data
+                  << std::dec << std::endl;
+        errors++;
+      }
+    }
+
+    void run() {
+      for (unsigned int i = 0; i < WARMUP; i++) {
+        access(i);
+      }
+      warm = allocations(name());
+      for (unsigned int i = 0; i < ACCESSES; i++) {
+        access(WARMUP + i);
+      }
+      done = allocations(name());
+    }
+};
+
+/// The cache and a memory on one bus with a 10 ns clock
+class System : public sc_core::sc_module {
+  public:
+    System(sc_core::sc_module_name nm, AbstractionLayer ambaLayer) :
+      sc_core::sc_module(nm),
+      ahbctrl("ahbctrl", ambaLayer),
+      mem("mem", ambaLayer, 0x000, 0xfff, 0),
+      cache("cache", ambaLayer) {
+      ahbctrl.ahbOUT(mem.ahb);
+      cache.ahb(ahbctrl.ahbIN);
+      ahbctrl.set_clk(10, sc_core::SC_NS);
+      mem.set_clk(10, sc_core::SC_NS);
+      cache.set_clk(10, sc_core::SC_NS);
+    }
+
+    AHBCtrl ahbctrl;
+    AHBMem mem;
+    TestCache cache;
+};
+
+int check(System &system, uint64_t limit) {
+  TestCache &cache = system.cache;
+  std::cout << cache.name() << ": " << cache.warm << " payloads after " << WARMUP << " accesses, " << cache.done
+            << " after " << (WARMUP + ACCESSES) << std::endl;
+  int errors = cache.errors;
+  if (cache.done == 0) {
+    std::cout << cache.name() << ": the accesses did not complete" << std::endl;
+    errors++;
+  }
+  if (cache.done != cache.warm) {
+    std::cout << cache.name() << ": the pool allocated " << (cache.done - cache.warm) << " more payloads"
+              << std::endl;
+    errors++;
+  }
+  if (cache.done > limit) {
+    std::cout << cache.name() << ": more than " << limit << " payloads" << std::endl;
+    errors++;
+  }
+  return errors;
+}
+
+}  // namespace
+
+int sc_main(int argc, char *argv[]) {
+  gs::ctr::GC_Core core;
+  gs::cnf::ConfigDatabase cnfdatabase("ConfigDatabase");
+  gs::cnf::ConfigPlugin configPlugin(&cnfdatabase);
+  SR_INCLUDE_MODULE(ArrayStorage);
+
+  System lt("lt", amba::amba_LT);
+  System at("at", amba::amba_AT);
+  sc_core::sc_start(sc_core::sc_time(10, sc_core::SC_MS));
+
+  // LT accesses share one payload, AT only needs the ones in flight
+  int errors = check(lt, 1) + check(at, WARMUP);
+  return errors ? 1 : 0;
+}
+/// @}
@@ -0,0 +1,322 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup leon3
+/// @{
+/// @file threadedcode.cpp
+/// Checks the threaded-code handlers bit for bit against the interpreted
+/// behavior() methods and reports the MIPS of the three execution modes.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <stdint.h>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <set>
+#include "core/base/systemc.h"
+#include "gaisler/leon3/intunit/processor.hpp"
+#include "gaisler/leon3/intunit/memory.hpp"
+#include "gaisler/leon3/intunit/threadedCode.hpp"
+
+using namespace leon3_funclt_trap;
+
+namespace {
+
+/// LocalMemory lacks the instruction fetch of cpu_if
+class TestMemory : public LocalMemory {
+  public:
+    explicit TestMemory(unsigned int size) : LocalMemory(size) {}
+    unsigned int read_instr(const unsigned int &address, const unsigned int asi, const unsigned int flush) throw() {
+      return read_word(address, asi, flush, 0);
+    }
+};
+
+/// Architectural state touched by the threaded instructions
+struct State {
+  unsigned int regs[32];
+  unsigned int psr;
+  unsigned int pc;
+  unsigned int npc;
+
+  bool operator==(const State &other) const {
+    for (int i = 0; i < 32; i++) {
+      if (regs[i] != other.regs[i]) {
+        return false;
+      }
+    }
+    return psr == other.psr && pc == other.pc && npc == other.npc;
+  }
+};
+
+void capture(Processor_leon3_funclt &cpu, State &state) {
+  for (int i = 0; i < 32; i++) {
+    state.regs[i] = cpu.REGS[i].readNewValue();
+  }
+  state.psr = cpu.PSR.readNewValue();
+  state.pc = cpu.PC.readNewValue();
+  state.npc = cpu.NPC.readNewValue();
+}
+
+void restore(Processor_leon3_funclt &cpu, const State &state) {
+  cpu.PSR.immediateWrite(state.psr);
+  for (int i = 1; i < 32; i++) {
+    cpu.REGS[i].immediateWrite(state.regs[i]);
+  }
+  cpu.PC.immediateWrite(state.pc);
+  cpu.NPC.immediateWrite(state.npc);
+}
+
+void print(const char *label, const State &state) {
+  std::cout << "  " << label << ": psr=0x" << std::hex << state.psr << " pc=0x" << state.pc
+            << " npc=0x" << state.npc;
+  for (int i = 0; i < 32; i++) {
+    std::cout << " r" << std::dec << i << "=0x" << std::hex << state.regs[i];
+  }
+  std::cout << std::dec << std::endl;
+}
+
+unsigned int random32() {
+  return (static_cast<unsigned int>(std::rand() & 0xffff) << 16) | (std::rand() & 0xffff);
+}
+
+const unsigned int DATA_START = 0x1000;
+const unsigned int DATA_END = 0xf000;
+
+/// Runs random Bicc, SETHI, ALU and memory words through both paths. Every
+/// word that gets a handler has to leave exactly the same registers and
+/// memory behind as behavior(), misaligned accesses have to be declined.
+int check_handlers(Processor_leon3_funclt &cpu, TestMemory &mem) {
+  const unsigned int words = 400000;
+  std::set<unsigned int> covered;
+  unsigned int checked = 0;
+  unsigned int declined = 0;
+  int errors = 0;
+  std::srand(42);
+  for (unsigned int n = 0; n < words; n++) {
+    unsigned int bitString = random32();
+    switch (n & 0x3) {
+      case 0:
+        // op = 0, op2 = 4, SETHI
+        bitString = (bitString & 0x3e3fffff) | 0x01000000;
+        break;
+      case 1:
+        // op = 0, op2 = 2, Bicc
+        bitString = (bitString & 0x3e3fffff) | 0x00800000;
+        break;
+      case 2:
+        // op = 2, arithmetic and logic
+        bitString = (bitString & 0x3fffffff) | 0x80000000;
+        if (n & 0x4) {
+          // Keep immediate shift counts in range half of the time
+          bitString &= ~0xfe0;
+        }
+        break;
+      default:
+        // op = 3, loads and stores
+        bitString = bitString | 0xc0000000;
+        break;
+    }
+    Instruction *instr = cpu.decode(bitString);
+    if (!instr) {
+      continue;
+    }
+    ThreadedOp op = ThreadedOp::translate(instr->get_id(), bitString);
+    if (!op.handler) {
+      continue;
+    }
+
+    State before, interpreted, threaded;
+    capture(cpu, before);
+    for (int i = 1; i < 32; i++) {
+      before.regs[i] = random32();
+    }
+    // Random condition codes, the window pointer stays where it is
+    before.psr = (before.psr & 0xff0fffff) | ((random32() & 0xf) << 20);
+    before.pc = random32() & ~0x3;
+    before.npc = before.pc + 4;
+
+    // Point the memory operands at the data area, the low address bits stay
+    // random so that misaligned accesses occur as well
+    unsigned int address = 0;
+    bool access = (bitString & 0xc0000000) == 0xc0000000;
+    if (access) {
+      unsigned int rs1 = (bitString >> 14) & 0x1f;
+      unsigned int rs2 = bitString & 0x1f;
+      if (rs1) {
+        before.regs[rs1] = DATA_START + (random32() & 0x3fff);
+      }
+      if (rs2) {
+        before.regs[rs2] = DATA_START + (random32() & 0x3fff);
+      }
+      address = before.regs[rs1] + ((bitString & 0x2000) ? op.imm : before.regs[rs2]);
+      if (address < DATA_START || address >= DATA_END) {
+        continue;
+      }
+      address &= ~0x3;
+    }
+    unsigned int word = access ? mem.read_word_dbg(address) : 0;
+    unsigned int interpretedWord = 0, threadedWord = 0;
+
+    restore(cpu, before);
+    cpu.threadedState.bind(cpu.PSR, cpu.PC, cpu.NPC, cpu.REGS);
+    if (op.handler(cpu.threadedState, op) == ThreadedOp::DECLINED) {
+      capture(cpu, threaded);
+      if (!(before == threaded) || (access && mem.read_word_dbg(address) != word)) {
+        if (errors++ < 10) {
+          std::cout << "Declined " << instr->get_mnemonic() << " (0x" << std::hex << bitString
+                    << std::dec << ") changed the state" << std::endl;
+        }
+      }
+      declined++;
+      continue;
+    }
+    capture(cpu, threaded);
+    if (access) {
+      threadedWord = mem.read_word_dbg(address);
+      mem.write_word_dbg(address, word);
+    }
+
+    restore(cpu, before);
+    instr->behavior();
+    capture(cpu, interpreted);
+    if (access) {
+      interpretedWord = mem.read_word_dbg(address);
+      mem.write_word_dbg(address, word);
+    }
+
+    covered.insert(instr->get_id());
+    checked++;
+    if (!(interpreted == threaded) || interpretedWord != threadedWord) {
+      if (errors++ < 10) {
+        std::cout << "Mismatch for " << instr->get_mnemonic() << " (0x" << std::hex << bitString
+                  << std::dec << ")" << std::endl;
+        print("before     ", before);
+        print("interpreted", interpreted);
+        print("threaded   ", threaded);
+        if (access) {
+          std::cout << "  memory at 0x" << std::hex << address << ": interpreted=0x" << interpretedWord
+                    << " threaded=0x" << threadedWord << std::dec << std::endl;
+        }
+      }
+    }
+  }
+  std::cout << "Compared " << checked << " instructions of " << covered.size()
+            << " threaded kinds, " << declined << " declined, " << errors << " mismatches" << std::endl;
+  // SETHI, BRANCH, 19 ALU pairs and 8 load and store pairs of immediate and
+  // register forms
+  if (covered.size() != 56 || declined == 0) {
+    std::cout << "Not every threaded instruction was covered" << std::endl;
+    errors++;
+  }
+  return errors;
+}
+
+// SPARC V8 encodings used by the benchmark loop
+unsigned int alu(unsigned int op3, unsigned int rd, unsigned int rs1, unsigned int rs2) {
+  return 0x80000000 | (rd << 25) | (op3 << 19) | (rs1 << 14) | rs2;
+}
+
+unsigned int alui(unsigned int op3, unsigned int rd, unsigned int rs1, int simm13) {
+  return 0x80000000 | (rd << 25) | (op3 << 19) | (rs1 << 14) | (1 << 13) | (simm13 & 0x1fff);
+}
+
+unsigned int sethi(unsigned int rd, unsigned int imm22) {
+  return (rd << 25) | (4 << 22) | (imm22 & 0x3fffff);
+}
+
+unsigned int branch(unsigned int cond, int disp) {
+  return (cond << 25) | (2 << 22) | (disp & 0x3fffff);
+}
+
+unsigned int ldst(unsigned int op3, unsigned int rd, unsigned int rs1, int simm13) {
+  return 0xc0000000 | (rd << 25) | (op3 << 19) | (rs1 << 14) | (1 << 13) | (simm13 & 0x1fff);
+}
+
+const unsigned int ITERATIONS = 1 << 17;
+const unsigned int END = 0x50;
+const unsigned int LOOP_DATA = 0x800;
+
+/// Integer loop over the globals and a few words of the data area, ends in a
+/// branch to itself at END
+void load_program(TestMemory &memory) {
+  const unsigned int program[] = {
+    sethi(5, ITERATIONS >> 10),   // sethi %hi(ITERATIONS), %g5
+    alui(0x02, 1, 0, 1),          // or    %g0, 1, %g1
+    alui(0x02, 2, 0, 0x123),      // or    %g0, 0x123, %g2
+    alu(0x00, 3, 1, 2),           // loop: add %g1, %g2, %g3
+    alu(0x03, 2, 3, 1),           // xor   %g3, %g1, %g2
+    alui(0x25, 4, 2, 3),          // sll   %g2, 3, %g4
+    alui(0x27, 6, 4, 2),          // sra   %g4, 2, %g6
+    alu(0x05, 7, 6, 1),           // andn  %g6, %g1, %g7
+    alu(0x06, 1, 7, 3),           // orn   %g7, %g3, %g1
+    alui(0x07, 3, 1, 0x5a),       // xnor  %g1, 0x5a, %g3
+    alu(0x10, 2, 3, 2),           // addcc %g3, %g2, %g2
+    alu(0x26, 4, 2, 5),           // srl   %g2, %g5, %g4
+    alui(0x04, 6, 4, 7),          // sub   %g4, 7, %g6
+    ldst(0x04, 2, 0, LOOP_DATA),   // st    %g2, [LOOP_DATA]
+    ldst(0x06, 4, 0, LOOP_DATA + 6), // sth %g4, [LOOP_DATA + 6]
+    ldst(0x09, 7, 0, LOOP_DATA + 1), // ldsb [LOOP_DATA + 1], %g7
+    ldst(0x00, 3, 0, LOOP_DATA + 4), // ld  [LOOP_DATA + 4], %g3
+    alui(0x14, 5, 5, 1),          // subcc %g5, 1, %g5
+    branch(9, -15),               // bne   loop
+    alu(0x03, 6, 6, 7),           // xor   %g6, %g7, %g6 (delay slot)
+    branch(8, 0),                 // end: ba end
+    sethi(0, 0),                  // nop
+  };
+  const unsigned int count = sizeof(program) / sizeof(program[0]);
+  for (unsigned int i = 0; i < count; i++) {
+    memory.write_word(i * 4, program[i], 0xb, 0, 0);
+  }
+}
+
+/// Runs the program from reset in one execution mode
+void run(Processor_leon3_funclt &cpu, const char *mode, bool blocks, bool threaded, State &result) {
+  // Park the main loop, it resets the processor when it is released
+  cpu.irqAck.stopped = true;
+  sc_core::sc_start(sc_core::sc_time(1, sc_core::SC_US));
+  cpu.blockCacheEnabled = blocks;
+  cpu.threadedCodeEnabled = threaded;
+  cpu.irqAck.stopped = false;
+
+  uint64_t start = cpu.numInstructions.getValue();
+  std::clock_t begin = std::clock();
+  do {
+    sc_core::sc_start(cpu.latency * 10000.0);
+  } while (cpu.PC.readNewValue() != END && cpu.PC.readNewValue() != END + 4);
+  double seconds = static_cast<double>(std::clock() - begin) / CLOCKS_PER_SEC;
+  uint64_t executed = cpu.numInstructions.getValue() - start;
+
+  capture(cpu, result);
+  std::cout << mode << ": " << executed << " instructions in " << seconds << " s, "
+            << (seconds > 0 ? executed / seconds / 1e6 : 0) << " MIPS" << std::endl;
+}
+
+}  // namespace
+
+int sc_main(int argc, char *argv[]) {
+  TestMemory mem(0x10000);
+  Processor_leon3_funclt cpu("cpu", &mem);
+  load_program(mem);
+  sc_core::sc_start(sc_core::sc_time(1, sc_core::SC_US));
+
+  int errors = check_handlers(cpu, mem);
+
+  State interpreted, blocks, threaded;
+  run(cpu, "interpreted", false, false, interpreted);
+  run(cpu, "block cache", true, false, blocks);
+  run(cpu, "threaded   ", true, true, threaded);
+  if (!(interpreted == blocks) || !(interpreted == threaded)) {
+    std::cout << "Final state differs between the execution modes" << std::endl;
+    print("interpreted", interpreted);
+    print("block cache", blocks);
+    print("threaded   ", threaded);
+    errors++;
+  }
+  return errors ? 1 : 0;
+}
+/// @}
@@ -218,10 +218,10 @@ class Mctrl : public AHBSlave<APBSlave>,
     uint8_t m_pmode;
 
     /// The number of total transactions handled by the mctrl
-    sr_param<uint64_t> m_total_transactions;  // NOLINT(runtime/int)
+    sr_counter m_total_transactions;
 
     /// The number of successfull ended transactions
-    sr_param<uint64_t> m_right_transactions;  // NOLINT(runtime/int)
+    sr_counter m_right_transactions;
 
     /// Total time of power down mode
     sr_param<sc_time> m_power_down_time;
@@ -275,10 +275,10 @@ class Mctrl : public AHBSlave<APBSlave>,
     sr_param<double> dyn_write_energy;
 
     /// Number of reads from memory
-    sr_param<uint64_t> dyn_reads;  // NOLINT(runtime/int)
+    sr_counter dyn_reads;
 
     /// Number of writes from memory
-    sr_param<uint64_t> dyn_writes;  // NOLINT(runtime/int)
+    sr_counter dyn_writes;
 
     // Constructor parameters (modeling VHDL generics)
     sr_param<int> g_romasel;
@@ -51,7 +51,7 @@ uint8_t ArrayStorage::read(const uint32_t &addr) const {
   return data[addr];
 }
 
-void ArrayStorage::erase(const uint32_t &start, const uint32_t &end) {
+void ArrayStorage::erase(const uint32_t &start, const uint64_t &end) {
   memset(&data[start], 0, end-start);
 }
 
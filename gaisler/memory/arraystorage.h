@@ -35,7 +35,7 @@ class ArrayStorage : public Storage {
 
     void read_block(const uint32_t &addr, uint8_t *ptr, const uint32_t &len) const;
 
-    void erase(const uint32_t &start, const uint32_t &end);
+    void erase(const uint32_t &start, const uint64_t &end);
 
     uint8_t *get_dmi_ptr();
 
@@ -19,11 +19,13 @@
 
 #include "gaisler/memory/arraystorage.h"
 #include "gaisler/memory/mapstorage.h"
+#include "gaisler/memory/pagedstorage.h"
 #include "gaisler/memory/storage.h"
+#include "core/base/elfloader.h"
 #include "core/common/scireg.h"
 #include "core/common/sr_report.h"
 
-class BaseMemory : public scireg_ns::scireg_region_if {
+class BaseMemory : public scireg_ns::scireg_region_if, public ElfLoaderTarget {
   public:
     BaseMemory();
 
@@ -51,6 +53,19 @@ class BaseMemory : public scireg_ns::scireg_region_if {
 
     void erase_dbg(const uint32_t &start, const uint32_t &end);
 
+    /// ElfLoader access, bypasses the statistics like the _dbg functions
+    uint64_t elf_target_size() const {
+      return m_storage->get_size();
+    }
+
+    void elf_target_write(const uint32_t &offset, const uint8_t *data, const uint32_t &len) {
+      write_block_dbg(offset, data, len);
+    }
+
+    void elf_target_erase(const uint32_t &start, const uint32_t &end) {
+      erase_dbg(start, end);
+    }
+
     /// Get the region_type of this region:
     virtual scireg_ns::scireg_response scireg_get_region_type(scireg_ns::scireg_region_type& t) const {
       t = scireg_ns::SCIREG_MEMORY;
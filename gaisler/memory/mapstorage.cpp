@@ -42,7 +42,7 @@ uint8_t MapStorage::read(const uint32_t &addr) const {
   return 0;
 }
 
-void MapStorage::erase(const uint32_t &start, const uint32_t &end) {
+void MapStorage::erase(const uint32_t &start, const uint64_t &end) {
   // Find or insert start address
   map_mem::iterator start_iter = data.find(start);
   if (start_iter == data.end()) {
@@ -50,11 +50,15 @@ void MapStorage::erase(const uint32_t &start, const uint32_t &end) {
     start_iter = data.find(start);
   }
 
-  // Find or insert end address
-  map_mem::iterator end_iter = data.find(end);
-  if (end_iter == data.end()) {
-    data.insert(std::make_pair(end, 0));
-    end_iter = data.find(end);
+  // Find or insert end address, an end beyond 32 bit erases up to the top
+  map_mem::iterator end_iter = data.end();
+  if (end <= 0xffffffffull) {
+    uint32_t last = static_cast<uint32_t>(end);
+    end_iter = data.find(last);
+    if (end_iter == data.end()) {
+      data.insert(std::make_pair(last, 0));
+      end_iter = data.find(last);
+    }
   }
 
   // Erase section
@@ -37,7 +37,7 @@ class MapStorage : public Storage {
 
     void read_block(const uint32_t &addr, uint8_t *ptr, const uint32_t &len) const;
 
-    void erase(const uint32_t &start, const uint32_t &end);
+    void erase(const uint32_t &start, const uint64_t &end);
   private:
     typedef vmap<uint32_t, uint8_t> map_mem;
     map_mem data;
@@ -204,10 +204,12 @@ unsigned int Memory::transport_dbg(tlm::tlm_generic_payload &gp) {
 
 bool Memory::get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
   // access to ROM adress space
+  uint32_t start = 0;
+  uint32_t end = get_bsize() * ((get_banks()<5)? get_banks() : 8) - 1;
   dmi_data.allow_read_write();
-  dmi_data.set_dmi_ptr(m_storage->get_dmi_ptr());
-  dmi_data.set_start_address(0);
-  dmi_data.set_end_address(get_bsize() * ((get_banks()<5)? get_banks() : 8));
+  dmi_data.set_dmi_ptr(m_storage->get_dmi_block(trans.get_address(), start, end));
+  dmi_data.set_start_address(start);
+  dmi_data.set_end_address(end);
   dmi_data.set_read_latency(SC_ZERO_TIME);
   dmi_data.set_write_latency(SC_ZERO_TIME);
   return m_storage->allow_dmi_rw();
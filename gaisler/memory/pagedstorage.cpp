@@ -0,0 +1,216 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup memory
+/// @{
+/// @file pagedstorage.cpp
+/// source file defining the implementation of the pagedstorage model.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <string.h>
+#include <algorithm>
+
+#include "gaisler/memory/pagedstorage.h"
+#include "core/common/sr_report.h"
+
+SR_HAS_MEMORYSTORAGE(PagedStorage);
+
+const uint8_t PagedStorage::zero_page[PagedStorage::PAGE_SIZE] = { 0 };
+
+PagedStorage::PagedStorage(sc_core::sc_module_name mn) : Storage(mn), m_pages(0) {
+  m_size = 0;
+  memset(m_dirs, 0, sizeof(m_dirs));
+}
+
+PagedStorage::~PagedStorage() {
+  srDebug()
+    ("pages", m_pages)
+    ("bytes", static_cast<uint64_t>(m_pages) * PAGE_SIZE)
+    ("Allocated pages");
+  clear();
+}
+
+void PagedStorage::clear() {
+  for (uint32_t i = 0; i < DIRS; ++i) {
+    if (m_dirs[i]) {
+      for (uint32_t j = 0; j < DIR_SIZE; ++j) {
+        if (!is_mapped(m_dirs[i][j])) {
+          delete[] m_dirs[i][j];
+        }
+      }
+      delete[] m_dirs[i];
+      m_dirs[i] = NULL;
+    }
+  }
+  m_pages = 0;
+  m_images.clear();
+}
+
+bool PagedStorage::is_mapped(const uint8_t *page) const {
+  for (std::vector<boost::shared_ptr<SnapshotPages> >::const_iterator iter = m_images.begin(); iter != m_images.end(); ++iter) {
+    if ((*iter)->contains(page)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint8_t *PagedStorage::alloc_page(const uint32_t &addr) {
+  uint8_t **&dir = m_dirs[addr >> (PAGE_BITS + DIR_BITS)];
+  if (!dir) {
+    dir = new uint8_t *[DIR_SIZE];
+    memset(dir, 0, DIR_SIZE * sizeof(uint8_t *));
+  }
+  uint8_t *&page = dir[(addr >> PAGE_BITS) & (DIR_SIZE - 1)];
+  page = new uint8_t[PAGE_SIZE];
+  memset(page, 0, PAGE_SIZE);
+  m_pages++;
+  return page;
+}
+
+void PagedStorage::set_size(const uint32_t &size) {
+  // Allocated pages are cleared but kept like in erase, a DMI pointer to
+  // them may still be in use.
+  for (uint32_t i = 0; i < DIRS; ++i) {
+    if (m_dirs[i]) {
+      for (uint32_t j = 0; j < DIR_SIZE; ++j) {
+        if (m_dirs[i][j]) {
+          memset(m_dirs[i][j], 0, PAGE_SIZE);
+        }
+      }
+    }
+  }
+  m_size = size;
+  srDebug()
+    ("size", m_size)
+    ("set_size");
+}
+
+uint64_t PagedStorage::get_size() const {
+  return m_size;
+}
+
+void PagedStorage::write(const uint32_t &addr, const uint8_t &byte) {
+  get_page(addr)[addr & PAGE_MASK] = byte;
+}
+
+uint8_t PagedStorage::read(const uint32_t &addr) const {
+  const uint8_t *page = find_page(addr);
+  return page? page[addr & PAGE_MASK] : 0;
+}
+
+void PagedStorage::write_block(const uint32_t &addr, const uint8_t *ptr, const uint32_t &len) {
+  uint32_t pos = addr;
+  uint32_t left = len;
+  while (left) {
+    uint32_t offset = pos & PAGE_MASK;
+    uint32_t chunk = std::min(left, PAGE_SIZE - offset);
+    memcpy(get_page(pos) + offset, ptr, chunk);
+    ptr += chunk;
+    pos += chunk;
+    left -= chunk;
+  }
+}
+
+void PagedStorage::read_block(const uint32_t &addr, uint8_t *ptr, const uint32_t &len) const {
+  uint32_t pos = addr;
+  uint32_t left = len;
+  while (left) {
+    uint32_t offset = pos & PAGE_MASK;
+    uint32_t chunk = std::min(left, PAGE_SIZE - offset);
+    const uint8_t *page = find_page(pos);
+    memcpy(ptr, (page? page : zero_page) + offset, chunk);
+    ptr += chunk;
+    pos += chunk;
+    left -= chunk;
+  }
+}
+
+void PagedStorage::erase(const uint32_t &start, const uint64_t &end) {
+  // Pages are cleared but kept, a DMI pointer to them may still be in use.
+  uint64_t pos = start;
+  while (pos < end) {
+    uint32_t offset = pos & PAGE_MASK;
+    uint32_t chunk = std::min(end - pos, static_cast<uint64_t>(PAGE_SIZE - offset));
+    uint8_t *page = find_page(pos);
+    if (page) {
+      memset(page + offset, 0, chunk);
+    }
+    pos += chunk;
+  }
+}
+
+uint8_t *PagedStorage::get_dmi_block(const uint32_t &addr, uint32_t &start, uint32_t &end) {
+  uint8_t *page = get_page(addr);
+  uint64_t limit = static_cast<uint64_t>(addr & ~PAGE_MASK) + PAGE_SIZE;
+  // Cut at the end of the storage, but never below the requested page
+  if (limit > m_size && m_size > (addr & ~PAGE_MASK)) {
+    limit = m_size;
+  }
+  start = addr & ~PAGE_MASK;
+  end = limit - 1;
+  return page;
+}
+
+bool PagedStorage::allow_dmi_rw() {
+  return true;
+}
+
+void PagedStorage::snapshot_save(Snapshot &snapshot) {
+  if (!snapshot.begin_pages("data", PAGE_SIZE, m_size)) {
+    return;
+  }
+  for (uint32_t i = 0; i < DIRS; ++i) {
+    if (m_dirs[i]) {
+      for (uint32_t j = 0; j < DIR_SIZE; ++j) {
+        const uint8_t *page = m_dirs[i][j];
+        if (page && memcmp(page, zero_page, PAGE_SIZE) != 0) {
+          snapshot.put_page((i << DIR_BITS) | j, page);
+        }
+      }
+    }
+  }
+  snapshot.end_pages();
+}
+
+void PagedStorage::snapshot_restore(Snapshot &snapshot) {
+  boost::shared_ptr<SnapshotPages> pages = snapshot.get_pages("data");
+  if (!pages || pages->page_size() != PAGE_SIZE) {
+    Storage::snapshot_restore(snapshot);
+    return;
+  }
+  erase(0, m_size);
+  uint32_t adopted = 0;
+  for (uint32_t i = 0; i < pages->count(); ++i) {
+    uint32_t addr = pages->index(i) << PAGE_BITS;
+    if (pages->index(i) >= (1 << (32 - PAGE_BITS)) || addr >= m_size) {
+      continue;
+    }
+    uint8_t *page = find_page(addr);
+    if (page) {
+      memcpy(page, pages->page(i), PAGE_SIZE);
+    } else {
+      uint8_t **&dir = m_dirs[addr >> (PAGE_BITS + DIR_BITS)];
+      if (!dir) {
+        dir = new uint8_t *[DIR_SIZE];
+        memset(dir, 0, DIR_SIZE * sizeof(uint8_t *));
+      }
+      dir[(addr >> PAGE_BITS) & (DIR_SIZE - 1)] = pages->page(i);
+      m_pages++;
+      adopted++;
+    }
+  }
+  if (adopted) {
+    m_images.push_back(pages);
+  }
+  srDebug()
+    ("pages", pages->count())
+    ("adopted", adopted)
+    ("Restored memory image");
+}
+/// @}
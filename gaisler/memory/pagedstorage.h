@@ -0,0 +1,99 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup memory Memory
+/// @{
+/// @file pagedstorage.h
+/// Adressable storage implementation based on lazily allocated pages.
+/// Supposed to be used by large, sparsely populated memories.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#ifndef MODELS_MEMORY_PAGEDSTORAGE_H_
+#define MODELS_MEMORY_PAGEDSTORAGE_H_
+
+#include <vector>
+
+#include "gaisler/memory/storage.h"
+
+/// Sparse storage organized as a two level table of 64 KB pages.
+/// Pages are allocated on first write (or DMI request), untouched pages read as zero.
+class PagedStorage : public Storage {
+  public:
+    explicit PagedStorage(sc_core::sc_module_name mn);
+
+    ~PagedStorage();
+
+    /// Zeroes the content, allocated pages stay valid for DMI
+    void set_size(const uint32_t &size);
+
+    uint64_t get_size() const;
+
+    void write(const uint32_t &addr, const uint8_t &byte);
+
+    uint8_t read(const uint32_t &addr) const;
+
+    void write_block(const uint32_t &addr, const uint8_t *ptr, const uint32_t &len);
+
+    void read_block(const uint32_t &addr, uint8_t *ptr, const uint32_t &len) const;
+
+    void erase(const uint32_t &start, const uint64_t &end);
+
+    uint8_t *get_dmi_block(const uint32_t &addr, uint32_t &start, uint32_t &end);
+
+    bool allow_dmi_rw();
+
+    /// Saves the allocated pages only
+    void snapshot_save(Snapshot &snapshot);
+
+    /// Adopts the pages of the mapped image instead of copying them.
+    /// Pages which already exist (and may be known by DMI) are overwritten.
+    void snapshot_restore(Snapshot &snapshot);
+
+  private:
+    static const uint32_t PAGE_BITS = 16;
+    static const uint32_t PAGE_SIZE = 1 << PAGE_BITS;
+    static const uint32_t PAGE_MASK = PAGE_SIZE - 1;
+    static const uint32_t DIR_BITS = 8;
+    static const uint32_t DIR_SIZE = 1 << DIR_BITS;
+    static const uint32_t DIRS = 1 << (32 - PAGE_BITS - DIR_BITS);
+
+    /// Returns the page holding addr or NULL if it was never allocated
+    inline uint8_t *find_page(const uint32_t &addr) const {
+      uint8_t **dir = m_dirs[addr >> (PAGE_BITS + DIR_BITS)];
+      return dir? dir[(addr >> PAGE_BITS) & (DIR_SIZE - 1)] : NULL;
+    }
+
+    /// Returns the page holding addr, allocates it (zeroed) if necessary
+    inline uint8_t *get_page(const uint32_t &addr) {
+      uint8_t *page = find_page(addr);
+      return page? page : alloc_page(addr);
+    }
+
+    uint8_t *alloc_page(const uint32_t &addr);
+
+    /// Frees all pages, only used on destruction
+    void clear();
+
+    /// Returns true if page belongs to a mapped snapshot image
+    bool is_mapped(const uint8_t *page) const;
+
+    /// Page directories, each holding DIR_SIZE page pointers
+    uint8_t **m_dirs[DIRS];
+
+    /// Number of allocated pages
+    uint32_t m_pages;
+
+    /// Snapshot images whose pages were adopted by snapshot_restore
+    std::vector<boost::shared_ptr<SnapshotPages> > m_images;
+
+    /// Shared backing of all untouched pages
+    static const uint8_t zero_page[PAGE_SIZE];
+};
+
+#endif  // MODELS_MEMORY_PAGEDSTORAGE_H_
+/// @}
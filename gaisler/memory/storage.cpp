@@ -0,0 +1,62 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup memory
+/// @{
+/// @file storage.cpp
+/// Snapshot support shared by all storage implementations.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+///
+
+#include <algorithm>
+#include <vector>
+
+#include "gaisler/memory/storage.h"
+#include "core/common/sr_report.h"
+
+void Storage::snapshot_save(Snapshot &snapshot) {
+  uint64_t size = get_size();
+  if (!snapshot.begin_pages("data", SNAPSHOT_PAGE_SIZE, size)) {
+    return;
+  }
+  std::vector<uint8_t> page(SNAPSHOT_PAGE_SIZE, 0);
+  const std::vector<uint8_t> zero(SNAPSHOT_PAGE_SIZE, 0);
+  for (uint64_t addr = 0; addr < size; addr += SNAPSHOT_PAGE_SIZE) {
+    uint32_t len = std::min(size - addr, static_cast<uint64_t>(SNAPSHOT_PAGE_SIZE));
+    read_block(addr, &page[0], len);
+    std::fill(page.begin() + len, page.end(), 0);
+    if (page != zero) {
+      snapshot.put_page(addr / SNAPSHOT_PAGE_SIZE, &page[0]);
+    }
+  }
+  snapshot.end_pages();
+}
+
+void Storage::snapshot_restore(Snapshot &snapshot) {
+  boost::shared_ptr<SnapshotPages> pages = snapshot.get_pages("data");
+  if (!pages) {
+    srWarn()
+      ("No memory image in the snapshot, the content is kept");
+    return;
+  }
+  uint64_t size = get_size();
+  if (pages->size() != size) {
+    srWarn()
+      ("size", size)
+      ("image", pages->size())
+      ("The memory image has another size, it is clipped");
+  }
+  erase(0, size);
+  for (uint32_t i = 0; i < pages->count(); ++i) {
+    uint64_t addr = static_cast<uint64_t>(pages->index(i)) * pages->page_size();
+    if (addr < size) {
+      uint32_t len = std::min(size - addr, static_cast<uint64_t>(pages->page_size()));
+      write_block(addr, pages->page(i), len);
+    }
+  }
+}
+/// @}
@@ -16,6 +16,7 @@
 #define MODELS_MEMORY_STORAGE_H_
 #include "core/base/systemc.h"
 #include "core/common/sr_registry.h"
+#include "core/base/snapshot.h"
 
 #define \
   SR_HAS_MEMORYSTORAGE_GENERATOR(type, factory, isinstance) \
@@ -34,7 +35,7 @@
 
 
 
-class Storage : public sc_core::sc_object {
+class Storage : public sc_core::sc_object, public SnapshotDevice {
   public:
     Storage(sc_core::sc_module_name mn) : sc_core::sc_object(mn) {};
     virtual ~Storage() {};
@@ -51,12 +52,26 @@ class Storage : public sc_core::sc_object {
 
     virtual void read_block(const uint32_t &addr, uint8_t *data, const uint32_t &len) const = 0;
 
-    virtual void erase(const uint32_t &start, const uint32_t &end) = 0;
+    /// Zeroes [start, end). end is 64 bit wide, so a 4 GB storage can be erased as a whole.
+    virtual void erase(const uint32_t &start, const uint64_t &end) = 0;
 
     virtual uint8_t *get_dmi_ptr() { return NULL; }
 
+    /// Returns the DMI pointer for the block containing addr.
+    /// start and end enter as the bounds of the whole storage and may be narrowed to the block.
+    virtual uint8_t *get_dmi_block(const uint32_t &addr, uint32_t &start, uint32_t &end) { return get_dmi_ptr(); }
+
     virtual bool allow_dmi_rw() { return false; }
 
+    /// Saves the content as page image "data", pages reading as zero are skipped.
+    virtual void snapshot_save(Snapshot &snapshot);
+
+    /// Replaces the content by the page image "data".
+    virtual void snapshot_restore(Snapshot &snapshot);
+
+    /// Page size of the memory images in snapshots
+    static const uint32_t SNAPSHOT_PAGE_SIZE = 1 << 16;
+
   protected:
     uint64_t m_size;
 };
@@ -9,7 +9,9 @@ def implements_scireg(component):
 @usi.on('start_of_simulation')
 def onstart(*k, **kw):
     banks = []
-    search_result = usi.find('leon3_0.dvectorcache.line_63.*')
+    search_result = [region for region, name, offset in
+                     usi.USIDelegate('leon3_0.dvectorcache').scireg_get_child_regions()
+                     if name == b'line_63']
     for component in search_result:
         if implements_scireg(component) and\
            component.scireg_get_region_type() == scireg.SCIREG_BANK:
@@ -17,7 +19,7 @@ def onstart(*k, **kw):
 
     total_bytes_banks = 0
     for bank in banks:
-        print(bank.name())
+        print(bank.scireg_get_string_attribute(scireg.SCIREG_NAME))
         #for bank in bank.scireg_get_child_regions():
         #    print(bank)
 
@@ -0,0 +1,81 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup pysc
+/// @{
+/// @file elfloader.i
+/// Python interface of the native ELF loader. Every memory gets a load_elf
+/// method, the symbol table and entry point are available as module functions.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+%module elfloader
+
+%include "usi.i"
+%include "std_string.i"
+%include "stdint.i"
+
+USI_REGISTER_MODULE(elfloader)
+
+%{
+#include "core/base/elfloader.h"
+%}
+
+%typemap(out) ElfLoader::symbol_map_t {
+  $result = PyDict_New();
+  for (ElfLoader::symbol_map_t::const_iterator iter = $1.begin(); iter != $1.end(); ++iter) {
+    PyObject *value = PyLong_FromUnsignedLong(iter->second);
+    PyDict_SetItemString($result, iter->first.c_str(), value);
+    Py_DECREF(value);
+  }
+}
+
+%inline %{
+class ElfLoaderInterface {
+  public:
+#ifndef SWIG
+    ElfLoaderInterface(ElfLoaderTarget *memory): m_memory(memory) {}
+#endif
+    /// Loads all segments of filename into the memory, base is the bus address of the memory.
+    /// Returns the number of bytes written or -1 if the file cannot be read.
+    int64_t load_elf(const std::string &filename, uint32_t base) {
+      ElfLoader loader;
+      if (!loader.open(filename)) {
+        return -1;
+      }
+      return loader.load(*m_memory, base);
+    }
+  private:
+    ElfLoaderTarget *m_memory;
+};
+
+/// Entry point of filename, 0 if the file cannot be read
+uint32_t elf_entry(const std::string &filename) {
+  ElfLoader loader;
+  return loader.open(filename)? loader.get_entry() : 0;
+}
+
+/// Defined symbols of filename as dictionary name to address
+ElfLoader::symbol_map_t elf_symbols(const std::string &filename) {
+  ElfLoader loader;
+  if (!loader.open(filename)) {
+    return ElfLoader::symbol_map_t();
+  }
+  return loader.get_symbols();
+}
+%}
+
+%{
+PyObject *find_usi_elfloader(sc_core::sc_object *obj, std::string name) {
+  ElfLoaderTarget *instance = dynamic_cast<ElfLoaderTarget *>(obj);
+  if(instance) {
+    return SWIG_NewPointerObj(SWIG_as_voidptr(new ElfLoaderInterface(instance)), SWIGTYPE_p_ElfLoaderInterface, SWIG_POINTER_OWN | 0);
+  } else {
+    return NULL;
+  }
+}
+USI_REGISTER_OBJECT_GENERATOR(find_usi_elfloader);
+%}
+/// @}
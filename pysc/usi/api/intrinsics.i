@@ -47,6 +47,9 @@ class IntrinsicInterface {
         return false;
       }
     }
+    void set_heap_pointer(issueWidth addr) {
+      m_manager->heapPointer = addr;
+    }
   private:
     IntrinsicManager<issueWidth> *m_manager;
 };
@@ -0,0 +1,69 @@
+// vim : set fileencoding=utf-8 expandtab noai ts=4 sw=4 :
+/// @addtogroup pysc
+/// @{
+/// @file snapshot.i
+/// Python interface of the platform snapshots. The module functions save and
+/// restore the whole platform, every processor offers save_at to take a
+/// snapshot when its program counter reaches an address.
+///
+/// @copyright
+///   SoCRocket is free software: you can redistribute it and/or modify
+///   it under the terms of the GNU Affero General Public License as
+///   published by the Free Software Foundation, either version 3 of the
+///   License, or (at your option) any later version. See LICENSE.AGPL.md
+///   and LICENSE.COM.md in the root of the source tree.
+%module snapshot
+
+%include "usi.i"
+%include "std_string.i"
+%include "stdint.i"
+
+USI_REGISTER_MODULE(snapshot)
+
+%{
+#include "core/base/snapshot.h"
+#include "core/sr_iss/snapshottrigger.h"
+%}
+
+%inline %{
+class SnapshotTriggerInterface {
+  public:
+#ifndef SWIG
+    SnapshotTriggerInterface(SnapshotTrigger<unsigned int> *trigger): m_trigger(trigger) {}
+#endif
+    /// Saves a snapshot into path when the processor reaches pc
+    void save_at(uint32_t pc, const std::string &path) {
+      m_trigger->save_at(pc, path);
+    }
+  private:
+    SnapshotTrigger<unsigned int> *m_trigger;
+};
+
+/// Saves the platform into the directory path
+bool save(const std::string &path) {
+  return Snapshot::save(path);
+}
+
+/// Restores the platform from the directory path
+bool restore(const std::string &path) {
+  return Snapshot::restore(path);
+}
+
+/// Saves the platform into path when the simulation reaches time (in ns)
+void save_at_time(const std::string &path, double time) {
+  Snapshot::save_at(path, sc_core::sc_time(time, sc_core::SC_NS));
+}
+%}
+
+%{
+PyObject *find_usi_snapshottrigger(sc_core::sc_object *obj, std::string name) {
+  SnapshotTrigger<unsigned int> *instance = dynamic_cast<SnapshotTrigger<unsigned int> *>(obj);
+  if(instance) {
+    return SWIG_NewPointerObj(SWIG_as_voidptr(new SnapshotTriggerInterface(instance)), SWIGTYPE_p_SnapshotTriggerInterface, SWIG_POINTER_OWN | 0);
+  } else {
+    return NULL;
+  }
+}
+USI_REGISTER_OBJECT_GENERATOR(find_usi_snapshottrigger);
+%}
+/// @}
@@ -7,7 +7,7 @@ from . import db_reporter
 
 REPORT = console_reporter.report
 
-parser.add_argument('-r', '--reporter', dest='reporter', action='store', default='console', type=str, help='Changes the backend for the reporter: console (default) or hdf5=<path>')
+parser.add_argument('-r', '--reporter', dest='reporter', action='store', default='console', type=str, help='Changes the backend for the reporter: console (default), hdf5=<path> or binary=<path> (native writer, read it with usi.log.sink_reader)')
 parser.add_argument('-v', '--verbosity', dest='verbosity', action='store', default=500, type=int, help='Changes the report verbosity')
 
 @usi.on('start_of_initialization')
@@ -20,6 +20,14 @@ def start_of_initialization(phase):
         filename = reporter[5:]
         db_reporter.logger = db_reporter.Logger(filename)
         REPORT = db_reporter.report
+    elif reporter.startswith("binary="):
+        filename = reporter[7:]
+        if not usi.report.open_sink(filename):
+            print("Unable to open report file '%s'" % filename)
+            sys.exit(1)
+        usi.on("end_of_simulation")(close_sink)
+        # Infos bypass Python, warnings, errors and commands still reach the console
+        REPORT = console_reporter.report
     elif reporter == "console":
         REPORT = console_reporter.report
     else:
@@ -30,3 +38,6 @@ def start_of_initialization(phase):
     print("Set verbosity to level %d" % verbosity)
     print("Old verbosity level was %d" % usi.set_verbosity(verbosity))
 
+
+def close_sink(phase):
+    usi.report.close_sink()
@@ -0,0 +1,129 @@
+"""
+Reader for the columnar report files written by the native report sink
+(core/sr_report/sr_report_sink.cpp, usiexec --reporter binary=<path>).
+
+Example:
+
+  from usi.log import sink_reader
+  df = sink_reader.read("log.srlog")
+  sink_reader.to_hdf("log.srlog", "log.h5")  # readable by LogQuery
+"""
+from __future__ import print_function
+from builtins import range
+from builtins import object
+import struct
+import sys
+import numpy as np
+import pandas as pd
+
+# v::pair::type
+INT32, UINT32, INT64, UINT64, STRING, BOOL, DOUBLE, TIME = list(range(8))
+
+DTYPES = {
+    INT32: 'i4',
+    UINT32: 'u4',
+    INT64: 'i8',
+    UINT64: 'u8',
+    BOOL: 'u1',
+    DOUBLE: 'f8',
+    TIME: 'f8',
+}
+
+BLOCK_MAGIC = 0x4b4c4253
+
+class SinkReader(object):
+  def __init__(self, filename):
+    with open(filename, "rb") as f:
+      self.data = f.read()
+    if self.data[:8] != b"SRREPORT":
+      raise ValueError("%s is no report sink file" % filename)
+    self.order = '<'
+    version, mark = struct.unpack_from('<II', self.data, 8)
+    if mark != 0x01020304:
+      self.order = '>'
+      version, mark = struct.unpack_from('>II', self.data, 8)
+    if version != 1:
+      raise ValueError("Unsupported report sink version %d" % version)
+    self.pos = 16
+
+  def unpack(self, fmt):
+    values = struct.unpack_from(self.order + fmt, self.data, self.pos)
+    self.pos += struct.calcsize(self.order + fmt)
+    return values
+
+  def column(self, rows, type):
+    present = np.unpackbits(
+        np.frombuffer(self.data, np.uint8, (rows + 7) // 8, self.pos),
+        bitorder='little')[:rows].astype(bool)
+    self.pos += (rows + 7) // 8
+    size, = self.unpack('I')
+    end = self.pos + size
+    if type == STRING:
+      values = []
+      while self.pos < end:
+        length, = self.unpack('H')
+        values.append(self.data[self.pos:self.pos + length].decode('utf-8', 'replace'))
+        self.pos += length
+      column = np.empty(rows, dtype=object)
+    else:
+      values = np.frombuffer(self.data, self.order + DTYPES[type], size // np.dtype(DTYPES[type]).itemsize, self.pos)
+      if type == BOOL:
+        values = values.astype(bool)
+      if present.all():
+        column = None
+      else:
+        column = np.empty(rows, dtype=object)
+    self.pos = end
+    if column is None:
+      return pd.Series(values)
+    column[present] = values
+    return pd.Series(column)
+
+  def blocks(self):
+    """Yields one DataFrame per block of the file"""
+    index = 0
+    while self.pos < len(self.data):
+      magic, rows, columns = self.unpack('III')
+      if magic != BLOCK_MAGIC:
+        raise ValueError("Broken block at offset %d" % (self.pos - 12))
+      df = pd.DataFrame(index=list(range(index, index + rows)))
+      for _ in range(columns):
+        length, = self.unpack('H')
+        name = self.data[self.pos:self.pos + length].decode('utf-8')
+        self.pos += length
+        type, = self.unpack('B')
+        series = self.column(rows, type)
+        series.index = df.index
+        if name in df:
+          # Same key reported with different types
+          df[name] = df[name].combine_first(series)
+        else:
+          df[name] = series
+      index += rows
+      yield df
+
+def read(filename):
+  """Loads a complete report sink file into one DataFrame"""
+  blocks = list(SinkReader(filename).blocks())
+  if not blocks:
+    return pd.DataFrame()
+  return pd.concat(blocks, sort=False)
+
+def to_hdf(filename, h5file):
+  """Converts a report sink file into the HDF5 layout used by the hdf5 reporter and LogQuery"""
+  store = pd.HDFStore(h5file, mode='w', complevel=9, complib='blosc')
+  for chunk, df in enumerate(SinkReader(filename).blocks()):
+    for column in df.columns:
+      if df[column].dtype == 'object':
+        df[column] = df[column].astype(str)
+    store.append("log{0}".format(chunk), df, min_itemsize=250, index=False, data_columns=True)
+  store.close()
+
+if __name__ == "__main__":
+  if len(sys.argv) == 3:
+    to_hdf(sys.argv[1], sys.argv[2])
+  elif len(sys.argv) == 2:
+    print(read(sys.argv[1]))
+  else:
+    print("usage: %s <log.srlog> [<log.h5>]" % sys.argv[0])
+    sys.exit(1)
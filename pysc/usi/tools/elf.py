@@ -1,5 +1,6 @@
 from __future__ import print_function
 import usi
+import os
 import sys
 import re
 from usi.tools.args import parser, get_args
@@ -7,6 +8,10 @@ from elftools.elf.elffile import ELFFile
 from elftools.elf import constants
 from usi.api import intrinsics
 import sr_registry as registry
+try:
+    from usi.api import elfloader
+except ImportError:
+    elfloader = None
 
 memoryre = re.compile(r"^(?P<object>[a-zA-Z0-9_.]+)=(?P<filename>[a-zA-Z0-9_\-./]+)(\((?P<baseaddr>\d+|0x\d+)\))?$", re.U)
 intrinsicre = re.compile(r"^(?P<object>[a-zA-Z0-9_.]+)=(?P<filename>[a-zA-Z0-9_\-./]+)(\((?P<intrinsics>[a-zA-Z0-9_.,=]+)\))?$", re.U)
@@ -65,12 +70,33 @@ intrinsic_groups = {
       '_usleep': 'usleepIntrinsic32',
       '_utimes': 'utimesIntrinsic32',
       '_write': 'writeIntrinsic32'
+    },
+    'string': {
+      'memcpy': 'memcpyIntrinsic32',
+      'memset': 'memsetIntrinsic32',
+      'strlen': 'strlenIntrinsic32',
+      'memcmp': 'memcmpIntrinsic32'
     }
 }
 parser.add_argument('-e', '--loadelf', dest='loadelf', action='append', default=[], type=str, help='Load Data from ELF file into memory')
 parser.add_argument('-i', '--intrinsics', dest='intrinsics', action='append', default=[], type=str, help='Load intrinsics for an elf file to a processor')
 
 def load_elf_into_scireg(filename, stores, base):
+    if isinstance(stores, usi.USIDelegate):
+        stores = [stores]
+    # Memories with a native loader map the file and copy whole segments,
+    # all other sciregs get the sections through scireg_write.
+    fallback = []
+    for store in stores:
+        if 'load_elf' in dir(store):
+            print("Loading %s into %s at address %s" % (filename, store.name(), base))
+            if store.load_elf(filename, base) < 0:
+                print("ERROR: Cannot open ELF File to load into ScIReg '{}'".format(filename))
+                sys.exit(1)
+        else:
+            fallback.append(store)
+    if not fallback:
+        return
     try:
         with open(filename, "rb") as stream:
             elf = ELFFile(stream)
@@ -79,9 +105,7 @@ def load_elf_into_scireg(filename, stores, base):
                     addr = section.header["sh_addr"] - base
                     data = section.data()
 
-                    if isinstance(stores, usi.USIDelegate):
-                        stores = [stores]
-                    for store in stores:
+                    for store in fallback:
                         if isinstance(store, str):
                             store = store.encode('utf-8')
                         print("Loading %s section %s into %s at address %s and offset %s" % (filename, section.name, store.name(), base, addr))
@@ -93,31 +117,48 @@ def load_elf_into_scireg(filename, stores, base):
         print("ERROR: Cannot open ELF File to load into ScIReg '{}'".format(filename))
         sys.exit(1)
 
+def load_elf_symbols(filename):
+    """Returns the defined symbols of an ELF file as dictionary name to address"""
+    if not os.path.isfile(filename):
+        raise IOError("No such file: '%s'" % filename)
+    if elfloader:
+        return elfloader.elf_symbols(filename)
+    symbols = {}
+    with open(filename, "rb") as stream:
+        elf = ELFFile(stream)
+        for section in elf.iter_sections():
+            if section.header['sh_type'] == 'SHT_SYMTAB':
+                for symbol in section.iter_symbols():
+                    symbols[symbol.name.decode('utf-8')] = symbol.entry['st_value']
+    return symbols
+
 def load_elf_intrinsics_to_processor(filename, cpus, intrinsics):
     try:
-        with open(filename, "rb") as stream:
-            elf = ELFFile(stream)
-            for section in elf.iter_sections():
-                if section.header['sh_type'] == 'SHT_SYMTAB':
-                    for name, klass, entry in [(name, intrinsics[name], entry) for name, entry in [(symbol.name.decode('utf-8'), symbol.entry) for symbol in section.iter_symbols()] if name in list(intrinsics.keys())]:
-                        for cpu in cpus:
-                            intrinsic_manager = None
-                            if 'register_intrinsic' in dir(cpu):
-                                intrinsic_manager = cpu
-                            else:
-                                for child in cpu.children():
-                                    if child.basename() == 'intrinsics' and 'register_intrinsic' in dir(child):
-                                        intrinsic_manager = child
-                                        break
-
-                            if not intrinsic_manager:
-                                print("intrinsic manager for cpu %s not found" % cpu.name())
-                            print("Intrinsic on symbol %s at address %x is inserted with class %s on CPU %s" % (name, entry['st_value'], klass, cpu.name()))
-                            intrinsic_instance = registry.api.create_object_by_name('PlatformIntrinsic', klass, str(name))
-                            intrinsic_manager.register_intrinsic(entry['st_value'], intrinsic_instance)
+        symbols = load_elf_symbols(filename)
     except IOError as err:
         print("ERROR: Cannot open ELF File to load intrinsic addesses '{}'".format(filename))
         sys.exit(1)
+    for cpu in cpus:
+        intrinsic_manager = None
+        if 'register_intrinsic' in dir(cpu):
+            intrinsic_manager = cpu
+        else:
+            for child in cpu.children():
+                if child.basename() == 'intrinsics' and 'register_intrinsic' in dir(child):
+                    intrinsic_manager = child
+                    break
+
+        if not intrinsic_manager:
+            print("intrinsic manager for cpu %s not found" % cpu.name())
+            continue
+        for name, klass in [(name, intrinsics[name]) for name in list(intrinsics.keys()) if name in symbols]:
+            print("Intrinsic on symbol %s at address %x is inserted with class %s on CPU %s" % (name, symbols[name], klass, cpu.name()))
+            intrinsic_instance = registry.api.create_object_by_name('PlatformIntrinsic', klass, str(name))
+            intrinsic_manager.register_intrinsic(symbols[name], intrinsic_instance)
+        # The heap of sbrk and the arguments of main start behind the program
+        end = symbols.get('end', symbols.get('_end'))
+        if end is not None:
+            intrinsic_manager.set_heap_pointer((end + 7) & ~7)
 
 @usi.on('start_of_simulation')
 def start_of_simulation(*k, **kw):
@@ -0,0 +1,65 @@
+from __future__ import print_function
+import usi
+import re
+from usi.tools.args import parser, get_args
+try:
+    from usi.api import snapshot
+except ImportError:
+    snapshot = None
+
+timere = re.compile(r"^(?P<path>[a-zA-Z0-9_\-./]+)\((?P<time>\d+(\.\d*)?)\s*(?P<unit>fs|ps|ns|us|ms|s)?\)$", re.U)
+pcre = re.compile(r"^(?P<object>[a-zA-Z0-9_.]+)=(?P<path>[a-zA-Z0-9_\-./]+)\((?P<pc>0x[0-9a-fA-F]+|\d+)\)$", re.U)
+units = {'fs': 1e-6, 'ps': 1e-3, 'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+parser.add_argument('--snapshot-restore', dest='snapshot_restore', default=None, type=str, help='Restore the platform from a snapshot directory before the simulation starts')
+parser.add_argument('--snapshot-at-time', dest='snapshot_at_time', action='append', default=[], type=str, help='Save a snapshot at a simulation time: --snapshot-at-time snap(100 us)')
+parser.add_argument('--snapshot-at-pc', dest='snapshot_at_pc', action='append', default=[], type=str, help='Save a snapshot when a cpu reaches an address: --snapshot-at-pc leon3_0=snap(0x40001000)')
+
+def find_trigger(cpu):
+    """Returns the snapshot trigger of a processor, None if it has none"""
+    if 'save_at' in dir(cpu):
+        return cpu
+    for child in cpu.children():
+        if child.basename() == 'snapshot' and 'save_at' in dir(child):
+            return child
+    return None
+
+@usi.on('start_of_simulation')
+def start_of_simulation(*k, **kw):
+    args = get_args()
+    if not snapshot:
+        if args.snapshot_restore or args.snapshot_at_time or args.snapshot_at_pc:
+            print("Snapshots are not supported by this simulation")
+        return
+
+    # The restore is deferred by the kernel until all models are reset
+    if args.snapshot_restore:
+        print("Restoring snapshot %s" % args.snapshot_restore)
+        if not snapshot.restore(args.snapshot_restore):
+            print("ERROR: Cannot restore snapshot '%s'" % args.snapshot_restore)
+
+    for param in args.snapshot_at_time:
+        result = timere.match(param)
+        if not result:
+            print("--snapshot-at-time takes a directory and a time: '--snapshot-at-time snap(100 us)'. '%s' does not match" % (param))
+            continue
+        groups = result.groupdict()
+        time = float(groups['time']) * units[groups['unit'] or 'ns']
+        snapshot.save_at_time(groups['path'], time)
+
+    for param in args.snapshot_at_pc:
+        result = pcre.match(param)
+        if not result:
+            print("--snapshot-at-pc takes a cpu, a directory and an address: '--snapshot-at-pc leon3_0=snap(0x40001000)'. '%s' does not match" % (param))
+            continue
+        groups = result.groupdict()
+        cpus = usi.find(groups['object'])
+        if len(cpus) == 0:
+            print("cpu %s not found in simulation for parameter --snapshot-at-pc %s" % (groups['object'], param))
+            continue
+        for cpu in cpus:
+            trigger = find_trigger(cpu)
+            if not trigger:
+                print("snapshot trigger for cpu %s not found" % cpu.name())
+                continue
+            trigger.save_at(int(groups['pc'], 0), groups['path'])
@@ -33,6 +33,8 @@ int sc_main(int argc, char** argv) {
     USI_HAS_MODULE(sr_registry);
     USI_HAS_MODULE(delegate);
     USI_HAS_MODULE(intrinsics);
+    USI_HAS_MODULE(elfloader);
+    USI_HAS_MODULE(snapshot);
     USI_HAS_MODULE(greensocket);
     USI_HAS_MODULE(scireg);
     USI_HAS_MODULE(amba);
@@ -58,6 +60,7 @@ int sc_main(int argc, char** argv) {
     usi_load("usi.shell");
     usi_load("usi.tools.execute");
     usi_load("usi.tools.elf");
+    usi_load("usi.tools.snapshot");
 
     usi_start_of_initialization();
     usi_end_of_initialization();